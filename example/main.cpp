@@ -19,7 +19,11 @@
 #include "imgui.h"
 #include "implot.h"
 #include "misc/freetype/imgui_freetype.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <stdio.h>
+#include <thread>
 #define GL_SILENCE_DEPRECATION
 #if defined(IMGUI_IMPL_OPENGL_ES2)
 #include <GLES2/gl2.h>
@@ -164,6 +168,19 @@ int main(int, char **) {
 
   static dynamic_editor::api::DynamicEditor s_editor;
 
+  // feed an example data source from a producer thread
+  std::atomic<bool> producer_running{true};
+  std::thread sine_producer(
+      [&producer_running,
+       channel = dynamic_editor::api::RegisterDataSource("Sine")] {
+        float t = 0.0f;
+        while (producer_running) {
+          channel->Push(std::sin(t) * 50.0f + 50.0f);
+          t += 0.01f;
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+      });
+
   // Main loop
 #ifdef __EMSCRIPTEN__
   // For an Emscripten build we are disabling file-system access, so let's not
@@ -264,6 +281,9 @@ int main(int, char **) {
 #endif
 
   // Cleanup
+  producer_running = false;
+  sine_producer.join();
+
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
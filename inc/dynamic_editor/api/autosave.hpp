@@ -0,0 +1,92 @@
+#pragma once
+
+#include <dynamic_editor/views/editor.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "imgui.h"
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::api {
+
+// Incremental autosave. Every interval only the nodes and links that changed
+// are dumped on the UI thread, a background thread appends them to a
+// checksummed journal and periodically compacts the journal into a full
+// snapshot. Journal entries are idempotent upserts/erases by id, so replaying
+// a journal on top of a newer snapshot is harmless. The files a previous
+// session left in the directory are moved into PreviousSessionDirectory when
+// the autosave starts, so they can still be recovered.
+class Autosave {
+public:
+  static constexpr char const *PreviousSessionDirectory = "previous";
+
+  Autosave(std::filesystem::path directory, std::chrono::milliseconds interval,
+           size_t compact_after_entries = 512);
+  ~Autosave();
+
+  Autosave(Autosave const &) = delete;
+  Autosave &operator=(Autosave const &) = delete;
+
+  // called once per frame from the UI thread
+  void Update(views::Editor &editor);
+
+  // rebuilds the last saved document from the snapshot and the journal,
+  // ignoring a torn or corrupted tail
+  static std::optional<nlohmann::json>
+  Recover(std::filesystem::path const &directory);
+
+private:
+  using EntryMap = std::map<int, nlohmann::json>;
+
+  struct Document {
+    EntryMap Nodes;
+    EntryMap Links;
+    std::map<std::string, nlohmann::json> Subgraphs;
+  };
+
+  void WriterLoop();
+  void MovePreviousSession();
+  bool WriteEntry(nlohmann::json const &entry);
+  void Compact();
+
+  static void ApplyEntry(nlohmann::json const &entry, Document &document);
+  static nlohmann::json BuildDocument(Document const &document);
+
+  std::filesystem::path m_Directory;
+  std::chrono::milliseconds m_Interval;
+  size_t m_CompactAfterEntries;
+  // a reset waits this many intervals after the last one
+  static constexpr int ResetIntervals = 6;
+
+  // UI thread state
+  std::chrono::steady_clock::time_point m_LastSave;
+  std::chrono::steady_clock::time_point m_LastReset;
+  std::unordered_map<int, ImVec2> m_SavedPositions;
+  bool m_NeedsReset = true;
+
+  // handed over to the writer thread
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  std::vector<nlohmann::json> m_Pending;
+  bool m_Stop = false;
+
+  // writer thread state
+  Document m_Mirror;
+  std::ofstream m_Journal;
+  size_t m_JournalEntries = 0;
+
+  std::thread m_Writer;
+};
+
+} // namespace dynamic_editor::api
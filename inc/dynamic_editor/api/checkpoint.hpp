@@ -0,0 +1,106 @@
+#pragma once
+
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dynamic_editor::api {
+
+// State one node saved through Node::SaveState. Nodes are found again by
+// their path in the plan, see ExecutionPlan::NodePaths, and their type name.
+struct CheckpointEntry {
+  std::vector<int> Path;
+  std::string Name;
+  std::vector<uint8_t> State;
+};
+
+struct Checkpoint {
+  // passes the graph had run when the checkpoint was taken
+  uint64_t Pass = 0;
+  std::vector<CheckpointEntry> Entries;
+};
+
+// Appends a checkpoint of every node of plan that saves any state to out.
+// The format is binary, in native byte order and ends in a CRC-32 of the
+// rest. Processing thread only, between passes.
+void WriteCheckpoint(runtime::ExecutionPlan const &plan, uint64_t pass,
+                     std::vector<uint8_t> &out);
+// std::nullopt if there is no checkpoint at path or it is corrupted
+auto ReadCheckpoint(std::filesystem::path const &path)
+    -> std::optional<Checkpoint>;
+// hands every entry to the node of plan with the same path and type name,
+// returns how many of them took their state. Processing thread only,
+// between passes
+auto RestoreCheckpoint(Checkpoint const &checkpoint,
+                       runtime::ExecutionPlan const &plan) -> size_t;
+
+// Checkpoints the runtime state of a graph every interval, so stateful nodes
+// such as integrators and filters do not have to warm up again after a
+// restart. Saving happens at a pass boundary on the processing thread into
+// a buffer, a background thread writes it out and atomically replaces the
+// previous checkpoint, so passes never wait on the disk.
+//
+// Serializing is not free though. The pass that reaches the interval visits
+// every node of the plan and copies all of their state before the next pass
+// can start, so it runs longer by time proportional to the node count plus
+// the bytes saved. For graphs with large state, such as long filter
+// histories, pick an interval that keeps this well below the pass rate.
+class Checkpointer : public runtime::PassObserver {
+public:
+  // with restore, the checkpoint already at path is restored into the first
+  // pass over a non-empty graph, meant for startup
+  Checkpointer(std::filesystem::path path, std::chrono::milliseconds interval,
+               bool restore = false);
+  ~Checkpointer() override;
+
+  Checkpointer(Checkpointer const &) = delete;
+  Checkpointer &operator=(Checkpointer const &) = delete;
+
+  // checkpoints written to disk so far, may be called from any thread
+  [[nodiscard]] auto GetWrittenCheckpoints() const -> uint64_t {
+    return m_Written.load(std::memory_order_relaxed);
+  }
+
+  void BeforePass(runtime::ExecutionPlan const &plan) override;
+  void PassFinished(runtime::ExecutionPlan const &plan) override;
+
+private:
+  void WriterLoop();
+  void Write(std::vector<uint8_t> const &data);
+
+  std::filesystem::path m_Path;
+  std::chrono::milliseconds m_Interval;
+
+  // processing thread state
+  std::optional<Checkpoint> m_Restore;
+  uint64_t m_Pass = 0;
+  std::chrono::steady_clock::time_point m_LastCheckpoint;
+  std::vector<uint8_t> m_Buffer;
+
+  // handed over to the writer thread. The three buffers trade places, so
+  // their capacity is reused
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  std::vector<uint8_t> m_Pending;
+  bool m_HasPending = false;
+  bool m_Stop = false;
+
+  // writer thread state
+  std::vector<uint8_t> m_Writing;
+
+  std::atomic<uint64_t> m_Written{0};
+  std::thread m_Writer;
+};
+
+} // namespace dynamic_editor::api
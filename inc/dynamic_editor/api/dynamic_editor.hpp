@@ -1,16 +1,26 @@
 #pragma once
 
+#include <dynamic_editor/api/autosave.hpp>
+#include <dynamic_editor/api/checkpoint.hpp>
+#include <dynamic_editor/api/metrics.hpp>
+#include <dynamic_editor/api/recording.hpp>
+#include <dynamic_editor/runtime/instancing.hpp>
 #include <dynamic_editor/views/editor.hpp>
 #include <dynamic_editor/views/inspector.hpp>
 #include <dynamic_editor/views/viewer.hpp>
 
+#include <dynamic_editor/nodes/data_source.hpp>
 #include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/nodes/subgraph.hpp>
 
 #include "imgui.h"
 #include "imgui_internal.h"
 
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <set>
 
 extern void OnDumpNodes(std::string const &content);
@@ -27,17 +37,41 @@ void RunInitializers();
 
 const std::vector<nodes::NodeFactory> &GetNodeFactories();
 
+// Data sources are registered by the application before producers start
+// pushing. Any thread may register them or read the list, GetDataSources
+// returns the list as registered at the time and never changes it.
+using DataSourceList = std::shared_ptr<
+    std::vector<std::shared_ptr<nodes::DataSourceChannel>> const>;
+std::shared_ptr<nodes::DataSourceChannel>
+RegisterDataSource(std::string const &name, size_t capacity = 4096);
+auto GetDataSources() -> DataSourceList;
+std::shared_ptr<nodes::DataSourceChannel> FindDataSource(int id);
+std::shared_ptr<nodes::DataSourceChannel>
+FindDataSource(std::string const &name);
+
+// Subgraph definitions are looked up by name, registering a name again
+// replaces the definition used for nodes created from then on. Every
+// definition is also offered as a node type in the "Subgraphs" category.
+void RegisterSubgraph(std::shared_ptr<const nodes::SubgraphDefinition> def);
+std::shared_ptr<const nodes::SubgraphDefinition>
+FindSubgraph(std::string const &name);
+
 template <std::derived_from<nodes::Node> T, typename... Args>
 void RegisterNodeType(std::string const &cat, std::string const &name,
                       std::string const &description, Args &&...args) {
+  nodes::NodeTypeDescriptor const *type = nullptr;
+  if constexpr (requires { T::GetNodeType(); })
+    type = &T::GetNodeType();
+
   impl::RegisterNodeType(nodes::NodeFactory{
       cat, name, description,
       [=, ... args = std::forward<Args>(args)]() mutable {
-        auto node = std::make_shared<T>(name, std::forward<Args>(args)...);
+        auto node = utils::MakeShared<T>(name, std::forward<Args>(args)...);
         node->SetName(name);
         node->SetTitle(name);
         return node;
-      }});
+      },
+      type});
 }
 
 class DynamicEditor {
@@ -49,9 +83,66 @@ public:
   void Render();
   void RenderWindowed();
 
-  void LoadState(const nlohmann::json &state) { m_editor.LoadNodes(state); }
+  // heap allocations made by the last Render on the calling thread, 0 for
+  // a stable graph except in frames that autosave. Only counted with
+  // IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS, see utils::GetThreadAllocationCount
+  uint64_t GetFrameAllocations() const { return m_frame_allocations; }
+
+  void LoadState(const nlohmann::json &state) {
+    m_editor.ReconcileNodes(state);
+  }
   nlohmann::json DumpState() const { return m_editor.DumpNodes(); }
 
+  // journals changes into directory every interval, see api::Autosave
+  void EnableAutosave(std::filesystem::path const &directory,
+                      std::chrono::milliseconds interval =
+                          std::chrono::seconds(5));
+  void DisableAutosave() { m_autosave.reset(); }
+  // loads the state saved by a previous autosave, or by the session before
+  // it when an autosave was already enabled on directory. Returns false if
+  // there was none
+  bool RecoverAutosave(std::filesystem::path const &directory);
+
+  // checkpoints the runtime state of the nodes into path every interval,
+  // see api::Checkpointer. With restore, the checkpoint already at path is
+  // restored first, meant for right after loading the graph at startup
+  void EnableCheckpoints(std::filesystem::path const &path,
+                         std::chrono::milliseconds interval =
+                             std::chrono::seconds(10),
+                         bool restore = false);
+  void DisableCheckpoints();
+
+  // serves the runtime metrics in the Prometheus text format on a unix
+  // socket or on 127.0.0.1:port, see api::MetricsServer. Returns false if
+  // the socket could not be opened
+  bool EnableMetrics(std::filesystem::path const &socket_path);
+  bool EnableMetrics(uint16_t port);
+  void DisableMetrics() { m_metrics.reset(); }
+
+  // records the inputs of every pass from now on, see api::Recorder. A
+  // recording in progress is dropped
+  void StartRecording();
+  // ends the recording and writes it to path, returns false if nothing was
+  // recorded or the file could not be written. Replay it with
+  // api::ReplayRecording
+  bool StopRecording(std::filesystem::path const &path);
+  bool IsRecording() const { return m_recorder != nullptr; }
+
+  // traces frames, passes and the nodes they process from now on, see
+  // utils::SetTracing. Has to be called on the UI thread
+  void StartTracing();
+  // writes what was traced as a Chrome trace event file, returns false if it
+  // could not be written
+  bool StopTracing(std::filesystem::path const &path);
+
+  // count copies of the current graph that only differ in their unlinked
+  // input values, see runtime::InstancedGraph
+  std::unique_ptr<runtime::InstancedGraph>
+  CreateInstances(size_t count, size_t workers = 0) const {
+    return std::make_unique<runtime::InstancedGraph>(m_editor.CompilePlan(),
+                                                     count, workers);
+  }
+
 private:
   void ConfigureDockspace();
 
@@ -63,10 +154,16 @@ private:
   views::Editor m_editor;
   views::Viewer m_viewer;
   views::Inspector m_inspector;
+  std::unique_ptr<Autosave> m_autosave;
+  std::shared_ptr<Recorder> m_recorder;
+  std::shared_ptr<Checkpointer> m_checkpointer;
+  // reads the executor of m_editor, so it is declared after it
+  std::unique_ptr<MetricsServer> m_metrics;
 
   bool m_show_editor{true};
   bool m_show_viewer{true};
   bool m_show_inspector{true};
+  uint64_t m_frame_allocations{0};
 };
 
 } // namespace dynamic_editor::api
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <dynamic_editor/api/checkpoint.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/runtime/snapshot.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::api {
+
+// Creates the nodes and links of document, as written by
+// views::Editor::DumpNodes, in graph and submits them to executor as one
+// batch. Viewer entries are left to the views, so no ImGui context is
+// needed. Returns false if a node type is not registered or the document is
+// malformed, some nodes may have been submitted already then.
+auto LoadGraph(nlohmann::json const &document, nodes::NodeHolder &graph,
+               runtime::Executor &executor) -> bool;
+
+// Runs a graph without any views, for processes that only do processing.
+// The outputs of every pass are published to shared memory, where viewer
+// processes pick them up through views::RemoteViewer. Rendering never
+// competes with the passes for time, and a viewer that stalls or crashes
+// has no effect on them.
+class HeadlessEngine {
+public:
+  HeadlessEngine() = default;
+  ~HeadlessEngine();
+
+  HeadlessEngine(HeadlessEngine const &) = delete;
+  HeadlessEngine &operator=(HeadlessEngine const &) = delete;
+
+  // replaces the graph, see LoadGraph. Returns false without loading
+  // anything while a run is still going
+  auto Load(nlohmann::json const &document) -> bool;
+
+  // publishes into the shared memory segment name from the next pass on,
+  // replacing the previous segment. Returns false if it could not be
+  // created
+  auto Publish(std::string const &name,
+               runtime::SnapshotCapacity capacity = {}) -> bool;
+  [[nodiscard]] auto GetPublisher() const
+      -> std::shared_ptr<runtime::SnapshotPublisher> const & {
+    return m_Publisher;
+  }
+
+  // checkpoints the runtime state of the nodes into path every interval,
+  // see Checkpointer. With restore, the checkpoint already at path is
+  // restored into the first pass
+  void EnableCheckpoints(std::filesystem::path const &path,
+                         std::chrono::milliseconds interval,
+                         bool restore = false);
+
+  // runs passes until stopped, on a thread of the executor
+  void Start() { m_Executor.Start(true); }
+  // cancels the run and waits for it to end
+  void Stop();
+  // joins a run that ended on its own, e.g. on an error, returns whether it
+  // is still going
+  auto Poll() -> bool { return m_Executor.Poll(); }
+  auto TakeError() -> std::optional<nodes::Node::NodeError> {
+    return m_Executor.TakeError();
+  }
+
+  [[nodiscard]] auto GetExecutor() -> runtime::Executor & {
+    return m_Executor;
+  }
+
+private:
+  // the executor stops its run before the nodes it runs on go away
+  nodes::NodeHolder m_Graph;
+  runtime::Executor m_Executor;
+  std::shared_ptr<runtime::SnapshotPublisher> m_Publisher;
+  std::shared_ptr<Checkpointer> m_Checkpointer;
+};
+
+} // namespace dynamic_editor::api
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <dynamic_editor/runtime/executor.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace dynamic_editor::api {
+
+// Appends the metrics of executor, the nodes of its current plan and every
+// registered data source to out in the Prometheus text format. Only reads
+// atomics and the published plan, so it may run on any thread. Pass
+// latency percentiles are left to Prometheus, see histogram_quantile.
+void WritePrometheusMetrics(std::string &out,
+                            runtime::Executor const &executor);
+
+// Answers every connection with an HTTP response carrying the text source
+// writes, so Prometheus can scrape it over loopback TCP and curl can read it
+// over the unix socket. Requests are served one at a time on a thread of
+// the server, only supported on POSIX systems.
+class MetricsServer {
+public:
+  using Source = std::function<void(std::string &)>;
+
+  // listens on a unix socket at path, replacing a stale socket file
+  MetricsServer(std::filesystem::path path, Source source);
+  // listens on 127.0.0.1:port
+  MetricsServer(uint16_t port, Source source);
+  ~MetricsServer();
+
+  MetricsServer(MetricsServer const &) = delete;
+  MetricsServer &operator=(MetricsServer const &) = delete;
+
+  [[nodiscard]] auto IsListening() const -> bool { return m_Socket >= 0; }
+
+private:
+  void Listen();
+  void Serve(int connection);
+
+  std::filesystem::path m_Path;
+  Source m_Source;
+  int m_Socket = -1;
+  std::atomic<bool> m_Stop{false};
+  std::string m_Response;
+  std::thread m_Thread;
+};
+
+} // namespace dynamic_editor::api
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+#include <dynamic_editor/views/editor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::api {
+
+// checksum over the values of every output of plan, floats are hashed by
+// their bits so two passes only match if they are bit identical
+auto ChecksumOutputs(runtime::ExecutionPlan const &plan) -> uint64_t;
+
+// Records everything entering a graph so the run can be replayed, see
+// ReplayRecording. Each pass becomes a tick holding the samples drained by
+// the data sources, the unlinked input defaults that changed and the
+// checksum of the outputs it produced. Property edits are reported from the
+// UI thread by Update and land in the tick that first saw them.
+//
+// The log is binary and in native byte order: a header with the graph
+// document the recording starts from, then the ticks. Nodes of the plan
+// are referenced by their index, so the recording ends at the first pass on
+// a different plan, structural edits can not be replayed.
+class Recorder : public runtime::PassObserver {
+public:
+  // the recording starts from the graph of editor as it is now, has to be
+  // created on the UI thread
+  explicit Recorder(views::Editor &editor);
+  // the recording starts from document, as written by
+  // views::Editor::DumpNodes, e.g. for a graph loaded with LoadGraph. Only
+  // Update records property edits
+  explicit Recorder(nlohmann::json document);
+
+  // called once per frame from the UI thread, picks up property edits
+  void Update(views::Editor &editor);
+
+  // ticks recorded so far, may be called from any thread
+  [[nodiscard]] auto GetTicks() const -> uint64_t {
+    return m_Ticks.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto IsStopped() const -> bool {
+    return m_Stopped.load(std::memory_order_relaxed);
+  }
+
+  // ends the recording, passes still running are ignored from now on
+  void Stop();
+  // writes the ticks recorded so far, returns false if the file could not
+  // be written
+  auto Save(std::filesystem::path const &path) const -> bool;
+
+  void PassStarted(runtime::ExecutionPlan const &plan) override;
+  void PassFinished(runtime::ExecutionPlan const &plan) override;
+
+private:
+  struct PropertyChange {
+    int NodeId;
+    uint64_t Version;
+    // tick running when the change was reported
+    uint64_t Tick;
+    std::vector<uint8_t> Properties;
+  };
+
+  void BeginRecording(runtime::ExecutionPlan const &plan);
+  void DiscardTick();
+
+  nlohmann::json m_Document;
+
+  // UI thread state
+  std::unordered_map<int, uint64_t> m_SeenVersions;
+  std::unordered_map<int, views::NodeSnapshot> m_SeenSnapshots;
+
+  mutable std::mutex m_Mutex;
+  std::vector<PropertyChange> m_PropertyChanges;
+  // property version -> tick that first ran with it, per node
+  std::map<std::pair<int, uint64_t>, uint64_t> m_VersionTicks;
+
+  // processing thread state, guarded by m_Mutex while a tick is written
+  std::vector<uint8_t> m_Log;
+  // end of every complete tick in m_Log
+  std::vector<size_t> m_TickEnds;
+  size_t m_TickBegin = 0;
+  bool m_InTick = false;
+  uint64_t m_PlanVersion = 0;
+  runtime::PlanOptions m_Options;
+  std::vector<uint64_t> m_NodeVersions;
+  // plan indices of the data source nodes
+  std::vector<uint32_t> m_Sources;
+  // unlinked inputs of the plan and their last recorded default
+  std::vector<std::pair<uint32_t, uint32_t>> m_Inputs;
+  std::vector<nodes::Attribute::ValueType> m_InputValues;
+  std::chrono::steady_clock::time_point m_Start;
+
+  std::atomic<uint64_t> m_Ticks{0};
+  std::atomic<bool> m_Stopped{false};
+};
+
+struct ReplayResult {
+  uint64_t Ticks = 0;
+  // ticks whose outputs did not match the recording, and the first of them
+  uint64_t Mismatches = 0;
+  std::optional<uint64_t> FirstMismatch;
+  // time covered by the recording and time the replay took
+  double RecordedSeconds = 0.0;
+  double ReplaySeconds = 0.0;
+  // output checksum of every tick replayed, ChecksumOutputs
+  std::vector<uint64_t> Checksums;
+  // error that ended the replay early, if any. Its node is not set, the
+  // replay graph is gone by the time the result is returned
+  std::optional<nodes::Node::NodeError> Error;
+};
+
+// Replays a recording into a graph of its own, tick after tick on the
+// calling thread without waiting in between, see LoadGraph. Returns
+// std::nullopt if the file is not a recording or its graph can not be
+// rebuilt.
+auto ReplayRecording(std::filesystem::path const &path)
+    -> std::optional<ReplayResult>;
+
+} // namespace dynamic_editor::api
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "imgui.h"
 
@@ -11,19 +17,44 @@ class Node;
 
 class Attribute {
 public:
-  using ValueType = std::variant<std::monostate, float, bool, int>;
+  // contiguous samples, written by the node owning them and shared with
+  // every reader without copying
+  using Buffer = std::shared_ptr<const std::vector<float>>;
+  using ValueType = std::variant<std::monostate, float, bool, int, Buffer>;
   enum class Type { Float, Boolean, Int, Buffer };
 
   enum class IO { In, Out };
-  Attribute(IO io_type, Type type, std::string name);
+
+  // Immutable metadata of a port, shared by every attribute created from it
+  // through the NodeTypeDescriptor of the node type. A Default left empty is
+  // the zero value of Type.
+  struct Descriptor {
+    IO Io;
+    Attribute::Type Type;
+    std::string Name;
+    ValueType Default;
+
+    bool operator==(Descriptor const &rhs) const = default;
+  };
+
+  // connections are allocated from the memory resource of the node
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  explicit Attribute(Descriptor const &descriptor, allocator_type alloc = {});
+  Attribute(Attribute const &other, allocator_type alloc);
   ~Attribute();
 
   [[nodiscard]] auto GetId() const -> int { return m_Id; }
   void SetId(int id) { m_Id = id; }
 
-  [[nodiscard]] auto GetIo() const -> IO { return m_Io; }
-  [[nodiscard]] auto GetType() const -> Type { return m_Type; }
-  [[nodiscard]] auto GetName() const -> std::string { return m_Name; }
+  [[nodiscard]] auto GetDescriptor() const -> Descriptor const & {
+    return *m_Descriptor;
+  }
+  [[nodiscard]] auto GetIo() const -> IO { return m_Descriptor->Io; }
+  [[nodiscard]] auto GetType() const -> Type { return m_Descriptor->Type; }
+  [[nodiscard]] auto GetName() const -> std::string const & {
+    return m_Descriptor->Name;
+  }
 
   void AddConnectedAttribute(int link_id, Attribute *to) {
     m_ConnectedAttributes.insert({link_id, to});
@@ -31,30 +62,57 @@ public:
   void RemoveConnectedAttribute(int link_id) {
     m_ConnectedAttributes.erase(link_id);
   }
-  [[nodiscard]] auto GetConnectedAttributes() -> std::map<int, Attribute *> & {
+  [[nodiscard]] auto GetConnectedAttributes()
+      -> std::pmr::map<int, Attribute *> & {
     return m_ConnectedAttributes;
   }
 
   [[nodiscard]] auto GetParentNode() const -> Node * { return m_ParentNode; }
 
-  static void SetIdCounter(int id);
-
   auto GetOutputValue() -> ValueType & {
-    if (GetConnectedAttributes().empty())
-      return m_DefaultValue;
-    return m_OutputValue;
+    return GetValue(!GetConnectedAttributes().empty());
+  }
+  // same as GetOutputValue with connectivity supplied by the caller, used
+  // while processing where the connection maps belong to the UI thread
+  auto GetValue(bool connected) -> ValueType & {
+    return connected ? m_OutputValue : m_DefaultValue;
   }
 
   void ResetOutputValue() { m_OutputValue = std::monostate{}; }
 
+  [[nodiscard]] auto GetDefaultValue() const -> ValueType const & {
+    return m_DefaultValue;
+  }
+  void SetDefaultValue(ValueType value) { m_DefaultValue = std::move(value); }
+
+  // hands the value of this output to the UI thread, called by the
+  // processing thread once a pass is finished
+  void PublishValue(bool connected) { Publish(GetValue(connected)); }
+  // publishes the value of another attribute as the value of this one, for
+  // subgraph ports standing for an inner output
+  void PublishValue(Attribute &source, bool connected) {
+    Publish(source.GetValue(connected));
+  }
+  // the value published last, or the default before the first pass
+  [[nodiscard]] auto GetPublishedValue() const -> ValueType;
+  // what this input reads outside of a pass, the default when unlinked and
+  // a copy of what its source published last otherwise. Nothing is
+  // processed for it, so the UI thread never runs a node
+  auto ReadInput() -> ValueType &;
+
+  // the processing thread owns outputs and the values of links, the UI
+  // thread only edits the defaults of unlinked inputs and shows a copy of
+  // what was published for everything else
   void Render() {
-    ValueType &value = GetOutputValue();
-    bool disabled = false;
-    if (GetConnectedAttributes().empty()) {
-      value = m_DefaultValue;
-    } else {
+    auto &connected = GetConnectedAttributes();
+    bool const editable = GetIo() == IO::In && connected.empty();
+    ValueType shown;
+    if (!editable) {
+      if (GetIo() == IO::Out)
+        shown = GetPublishedValue();
+      else
+        shown = connected.begin()->second->GetPublishedValue();
       ImGui::BeginDisabled();
-      disabled = true;
     }
     std::visit(
         [this](auto &value) {
@@ -67,31 +125,96 @@ public:
             ImGui::InputScalar(GetName().c_str(), ImGuiDataType_S64, &value);
           } else if constexpr (std::is_same_v<T, bool>) {
             ImGui::Checkbox(GetName().c_str(), &value);
+          } else if constexpr (std::is_same_v<T, Buffer>) {
+            ImGui::Text("%s [%zu]", GetName().c_str(),
+                        value != nullptr ? value->size() : 0);
           } else {
             ImGui::Text("%s", GetName().c_str());
           }
         },
-        value);
+        editable ? m_DefaultValue : shown);
 
-    if (disabled)
+    if (!editable)
       ImGui::EndDisabled();
   }
 
 private:
-  int m_Id;
-  IO m_Io;
-  Type m_Type;
-  std::string m_Name;
-  std::map<int, Attribute *> m_ConnectedAttributes;
+  int m_Id = -1;
+  Descriptor const *m_Descriptor;
+  std::pmr::map<int, Attribute *> m_ConnectedAttributes;
 
   Node *m_ParentNode = nullptr;
 
   ValueType m_DefaultValue;
   ValueType m_OutputValue;
+  // written by PublishValue, scalars of every type fit a double exactly
+  std::atomic<double> m_PublishedScalar = 0.0;
+  // only accessed through the atomic shared_ptr functions
+  Buffer m_PublishedBuffer;
+  // the copy ReadInput returns, only touched by the thread reading it
+  ValueType m_ReadValue;
+
+  void Publish(ValueType const &value);
 
   friend class Node;
   void SetParentNode(Node *node) { m_ParentNode = node; }
+};
 
-  static int s_id;
+using PortDescriptor = Attribute::Descriptor;
+
+// Results of a node on a Buffer port, reused from pass to pass. Readers such
+// as downstream nodes, snapshots, recordings and the UI thread through
+// Attribute::GetPublishedValue may still hold the result of the last pass
+// while the next one is written, so results alternate between two buffers.
+//
+// Only the processing thread calls Process(), and every other thread gets
+// its copy from a published attribute, which never holds the buffer being
+// written next. A buffer nobody else holds can therefore not be picked up
+// by another thread while it is written in place, any other one is
+// replaced.
+class BufferOutput {
+public:
+  auto Resize(size_t size) -> float * {
+    m_Current ^= 1;
+    auto &data = m_Data[m_Current];
+    if (data == nullptr || data.use_count() != 1)
+      data = std::make_shared<std::vector<float>>();
+    else
+      // pairs with the release of the last reader dropping its reference
+      std::atomic_thread_fence(std::memory_order_acquire);
+    data->resize(size);
+    return data->data();
+  }
+  [[nodiscard]] auto Get() const -> Attribute::Buffer {
+    return m_Data[m_Current];
+  }
+
+private:
+  std::shared_ptr<std::vector<float>> m_Data[2];
+  size_t m_Current = 0;
 };
+
+// The ports of a node type. Descriptors are interned, node types with the
+// same ports share one, so node instances only hold a pointer to it and
+// their attributes only ids, connections and values.
+class NodeTypeDescriptor {
+public:
+  // returns the descriptor of these ports, creating it on first use. It
+  // lives until the process exits
+  static auto Intern(std::vector<PortDescriptor> ports)
+      -> NodeTypeDescriptor const &;
+
+  [[nodiscard]] auto GetPorts() const -> std::vector<PortDescriptor> const & {
+    return m_Ports;
+  }
+
+  bool operator<(NodeTypeDescriptor const &rhs) const;
+
+private:
+  explicit NodeTypeDescriptor(std::vector<PortDescriptor> ports)
+      : m_Ports(std::move(ports)) {}
+
+  std::vector<PortDescriptor> m_Ports;
+};
+
 } // namespace dynamic_editor::nodes
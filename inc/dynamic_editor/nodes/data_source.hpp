@@ -0,0 +1,101 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/utils/mpsc_queue.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dynamic_editor::nodes {
+
+// drag and drop payload carrying the id of a DataSourceChannel
+inline constexpr char const *DataSourcePayload = "INPUT DATA SOURCE";
+
+struct DataSourceSample {
+  double Timestamp;
+  float Value;
+};
+
+// A named stream of samples fed from outside the graph. Producers may push
+// from any thread, the processing thread drains the channel once per pass.
+class DataSourceChannel {
+public:
+  DataSourceChannel(int id, std::string name, size_t capacity);
+
+  [[nodiscard]] auto GetId() const -> int { return m_Id; }
+  [[nodiscard]] auto GetName() const -> std::string const & { return m_Name; }
+
+  // returns false and counts a dropped sample if the channel is full
+  auto Push(double timestamp, float value) -> bool;
+  // timestamps the sample with the seconds since the channel was created
+  auto Push(float value) -> bool;
+
+  template <typename Func> auto Drain(Func &&func) -> size_t {
+    size_t count = 0;
+    DataSourceSample sample{};
+    while (m_Queue.TryPop(sample)) {
+      func(sample);
+      count++;
+    }
+    return count;
+  }
+
+  [[nodiscard]] auto GetPendingSamples() const -> size_t {
+    return m_Queue.GetSizeApprox();
+  }
+  [[nodiscard]] auto GetCapacity() const -> size_t {
+    return m_Queue.GetCapacity();
+  }
+  [[nodiscard]] auto GetDroppedSamples() const -> uint64_t {
+    return m_Dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  int m_Id;
+  std::string m_Name;
+  double m_Epoch;
+  utils::MpscRingBuffer<DataSourceSample> m_Queue;
+  std::atomic<uint64_t> m_Dropped{0};
+};
+
+class DataSourceNode : public Node {
+public:
+  explicit DataSourceNode(std::string name);
+  static auto GetNodeType() -> NodeTypeDescriptor const &;
+
+  void SetChannel(std::shared_ptr<DataSourceChannel> channel);
+  [[nodiscard]] auto GetChannel() const
+      -> std::shared_ptr<DataSourceChannel> const & {
+    return m_Channel;
+  }
+
+  // samples drained at the start of the current pass, oldest first
+  [[nodiscard]] auto GetPassSamples() const
+      -> std::vector<DataSourceSample> const & {
+    return m_PassSamples;
+  }
+
+  void BeginPass() override;
+  void Process() override;
+
+  void CheckForErrors() override;
+  void DrawPropertiesContent() override;
+  void DrawViewerNodeContent() override;
+
+  void Dump(nlohmann::json &data) const override;
+  void Load(nlohmann::json const &data) override;
+
+private:
+  std::shared_ptr<DataSourceChannel> m_Channel;
+  std::vector<DataSourceSample> m_PassSamples;
+  // values of the pass samples, published on the Samples output
+  BufferOutput m_Samples;
+  DataSourceSample m_LastSample{0.0, 0.0F};
+  bool m_HasSample = false;
+};
+
+} // namespace dynamic_editor::nodes
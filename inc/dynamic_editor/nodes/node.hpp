@@ -2,17 +2,25 @@
 #pragma once
 
 #include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/utils/arena.hpp>
+#include <dynamic_editor/utils/binary_stream.hpp>
+#include <dynamic_editor/utils/id_allocator.hpp>
 #include <dynamic_editor/utils/imgui_extras.hpp>
 
 #include "codicons_internal.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <optional>
@@ -21,17 +29,75 @@
 #include "imgui.h"
 #include <nlohmann/json.hpp>
 
+namespace dynamic_editor::runtime {
+struct ExecutionPlan;
+class ExpressionBuilder;
+class InstanceBlock;
+}
+
 namespace dynamic_editor::nodes {
 
 class Node;
+struct NodeFactory;
 using NodeFactoryFunc = std::function<std::shared_ptr<Node>()>;
 
 struct NodeHolder {
   std::vector<std::shared_ptr<Node>> Nodes;
-  std::set<std::shared_ptr<Node>> SelectedNodes;
-
+  // rebuilt every frame, a vector keeps its capacity across frames
+  std::vector<std::shared_ptr<Node>> SelectedNodes;
+
+  // ids of nodes whose properties were edited by any view this frame, the
+  // editor turns them into undo steps
+  std::vector<int> EditedNodes;
+
+  // ids are only unique within one graph, so several graphs can live in the
+  // same process
+  utils::IdAllocator NodeIds;
+  utils::IdAllocator AttributeIds;
+  utils::IdAllocator LinkIds;
+
+  // memory of the nodes of this graph, see utils::Arena
+  std::shared_ptr<utils::Arena> Arena = std::make_shared<utils::Arena>();
+
+  // Makes a graph the one nodes are created for on the calling thread for
+  // its lifetime, see GetCreating.
+  class CreationScope {
+  public:
+    explicit CreationScope(NodeHolder &graph);
+    ~CreationScope();
+
+    CreationScope(CreationScope const &) = delete;
+    CreationScope &operator=(CreationScope const &) = delete;
+
+  private:
+    NodeHolder *m_Previous;
+  };
+  // graph the calling thread creates nodes for, nullptr outside of
+  // CreateNode and MakeNode. Nodes made of other nodes, such as subgraphs,
+  // take the ids of their parts from it
+  static auto GetCreating() -> NodeHolder *;
+
+  // creates a node of the factory in the arena of this graph
+  auto CreateNode(NodeFactory const &factory) -> std::shared_ptr<Node>;
+  template <typename T, typename... Args>
+  auto MakeNode(Args &&...args) -> std::shared_ptr<T> {
+    utils::ArenaScope scope(Arena);
+    CreationScope creating(*this);
+    return utils::MakeShared<T>(std::forward<Args>(args)...);
+  }
+  // starts a new arena once the graph was cleared, the old one is released
+  // in bulk when the last node still referencing it is gone
+  void ResetArena() { Arena = std::make_shared<utils::Arena>(); }
+
+  // gives a freshly created node and its attributes ids of this graph
+  void AssignIds(Node &node);
+  // reserves every node, attribute and link id a document uses, done before
+  // loading any of it so the ids handed to what it does not cover can not
+  // collide with ids loaded after them
+  void ReserveIds(nlohmann::json const &document);
   void SelectNode(const int id);
   void ResetSelectedNodes() { SelectedNodes.clear(); }
+  void MarkNodeEdited(const int id) { EditedNodes.push_back(id); }
 };
 
 struct NodeFactory {
@@ -39,6 +105,9 @@ struct NodeFactory {
   std::string Name;
   std::string Description;
   NodeFactoryFunc Func;
+  // ports of the nodes Func creates, nullptr if the type does not declare
+  // them up front
+  NodeTypeDescriptor const *Type = nullptr;
 
   bool operator==(NodeFactory const &rhs) const {
     return Cat == rhs.Cat && Name == rhs.Name;
@@ -59,7 +128,11 @@ enum NodeState_ {
 
 class Node {
 public:
-  Node(std::string title, std::vector<Attribute> input_attributes);
+  Node(std::string title, NodeTypeDescriptor const &type);
+  // interns ports on every construction, node types created often should
+  // pass a descriptor interned once instead
+  Node(std::string title, std::vector<PortDescriptor> ports)
+      : Node(std::move(title), NodeTypeDescriptor::Intern(std::move(ports))) {}
   virtual ~Node() = default;
 
   [[nodiscard]] auto GetId() const -> int { return m_Id; }
@@ -77,8 +150,11 @@ public:
   }
 
   void DrawProperties() {
-    ImGuiExtras::BeginSubWindow(
-        (GetTitle() + "###" + std::to_string(GetId())).c_str());
+    // the id keeps the window apart from nodes with the same title
+    char label[256];
+    ImFormatString(label, sizeof(label), "%s###%d", GetTitle().c_str(),
+                   GetId());
+    ImGuiExtras::BeginSubWindow(label);
     DrawCommonProperties();
     ImGui::SeparatorText("Properties");
     DrawPropertiesContent();
@@ -130,28 +206,29 @@ public:
         {"h", grid_position.h},
     };
   }
+  // restores what Dump wrote except for the "grid" entry, which the views
+  // place themselves, so graphs load without any ImGui context
   virtual void Load(nlohmann::json const &data) {
     m_ShouldRenderViewer = data.at("shouldRenderViewer").get<bool>();
     m_ShowTitleBar = data.at("showTitleBar").get<bool>();
-    ImGridPosition grid_position = {
-        data.at("grid").at("x").get<float>(),
-        data.at("grid").at("y").get<float>(),
-        data.at("grid").at("w").get<float>(),
-        data.at("grid").at("h").get<float>(),
-    };
-
-    ImGrid::SetEntryPosition(GetId(), grid_position);
   }
 
-  [[nodiscard]] auto GetTitle() const -> std::string { return m_Title; }
+  [[nodiscard]] auto GetTitle() const -> std::string const & {
+    return m_Title;
+  }
   void SetTitle(std::string const &title) { m_Title = title; }
-  [[nodiscard]] auto GetName() const -> std::string { return m_Name; }
+  [[nodiscard]] auto GetName() const -> std::string const & { return m_Name; }
   void SetName(std::string const &name) { m_Name = name; }
 
-  [[nodiscard]] auto GetAttributes() -> std::vector<Attribute> & {
+  [[nodiscard]] auto GetNodeType() const -> NodeTypeDescriptor const & {
+    return *m_Type;
+  }
+
+  [[nodiscard]] auto GetAttributes() -> std::pmr::vector<Attribute> & {
     return m_Attributes;
   }
-  [[nodiscard]] auto GetAttributes() const -> std::vector<Attribute> const & {
+  [[nodiscard]] auto GetAttributes() const
+      -> std::pmr::vector<Attribute> const & {
     return m_Attributes;
   }
 
@@ -184,6 +261,7 @@ public:
 
   void SetFloatOnOutput(size_t index, float value);
   void SetBoolOnOutput(size_t index, bool value);
+  void SetBufferOnOutput(size_t index, Attribute::Buffer value);
   void SetMonostateOnOutput(size_t index);
 
   void ResetOutputValue() {
@@ -192,10 +270,61 @@ public:
     }
   }
 
-  void ResetProcessedInputs() { m_ProcessedInputs.clear(); }
+  void ResetProcessedInputs() {
+    std::fill(m_ProcessedInputs.begin(), m_ProcessedInputs.end(), false);
+  }
   virtual void Reset() {}
+  // called once at the start of every processing pass, before any Process()
+  virtual void BeginPass() {}
+  // called on the processing thread for every plan the executor compiles,
+  // before its first pass, to cache what the node looks up while processing
+  virtual void BindPlan(runtime::ExecutionPlan const & /*plan*/) {}
+
+  // Instanced evaluation, see runtime::InstancedGraph. Processes a block of
+  // instances at once and returns true, or false to have each instance run
+  // through Process() on a clone, which nodes saving runtime state through
+  // SaveState can not do. Blocks run concurrently, so this must not modify
+  // the node itself, per instance state goes into block.State().
+  virtual auto ProcessInstances(runtime::InstanceBlock & /*block*/) -> bool {
+    return false;
+  }
+  // bytes of per instance state ProcessInstances needs
+  [[nodiscard]] virtual auto GetInstanceStateSize() const -> size_t {
+    return 0;
+  }
+
+  // Operator fusion, see runtime::FuseExpressions. Describes the output at
+  // index as an expression of the inputs of the node and returns its root,
+  // or std::nullopt if it can not be expressed. Nodes describing every output
+  // may be fused with their neighbours and are then not processed on their
+  // own, so this is only meant for pure nodes.
+  [[nodiscard]] virtual auto
+  DescribeExpression(size_t /*output*/,
+                     runtime::ExpressionBuilder & /*builder*/) const
+      -> std::optional<int> {
+    return std::nullopt;
+  }
+  // pure nodes compute their outputs from their inputs and properties only,
+  // so the plan may fold them into constants when none of their inputs vary.
+  // Nodes describing an expression are always treated as pure
+  [[nodiscard]] virtual auto IsPure() const -> bool { return false; }
+
+  // nodes call MarkPropertiesChanged when a property their outputs depend on
+  // changes, plans and constants built from the old one are then redone
+  void MarkPropertiesChanged() {
+    m_PropertyVersion.fetch_add(1, std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto GetPropertyVersion() const -> uint64_t {
+    return m_PropertyVersion.load(std::memory_order_relaxed);
+  }
 
-  static void SetIdCounter(int id);
+  // the views commit an undo step for edits ImGui reports by deactivating
+  // an item. Edits without such an item, e.g. a button adding an entry to a
+  // list, are committed by calling this while drawing
+  void MarkEditCommitted() { m_EditCommitted = true; }
+  auto TakeEditCommitted() -> bool {
+    return std::exchange(m_EditCommitted, false);
+  }
 
   [[nodiscard]] auto GetState() const -> NodeState { return m_State; }
   void SetState(NodeState state, std::string message) {
@@ -206,48 +335,93 @@ public:
     m_State &= ~state;
     m_CurrentError.clear();
   }
-  [[nodiscard]] auto GetCurrentError() const -> std::string {
+  [[nodiscard]] auto GetCurrentError() const -> std::string const & {
     return m_CurrentError;
   }
 
+  // Runtime state the node builds up while processing, e.g. the sum of an
+  // integrator, for checkpoints, see api::Checkpointer. Both are called on
+  // the processing thread between passes. RestoreState gets what SaveState
+  // wrote, possibly by an older build, and returns false if it can not use
+  // it. Nodes without such state write nothing and are left out.
+  virtual void SaveState(utils::BinaryWriter & /*out*/) const {}
+  virtual auto RestoreState(utils::BinaryReader & /*in*/) -> bool {
+    return false;
+  }
+
   [[nodiscard]] auto GetStateful() const -> bool { return m_Stateful; }
   void ResetStatefulState() { m_ShouldUpdate = false; }
   void SetStatefulState() { m_ShouldUpdate = true; }
   [[nodiscard]] auto GetShouldUpdate() const -> bool { return m_ShouldUpdate; }
 
+  // errors and warnings are set again every frame by CheckForErrors, they
+  // are assigned into the capacity of the previous message
   bool GetHasError() const { return !m_Error.empty(); }
-  std::string GetError() const { return m_Error; }
-  void SetError(std::string const &error) { m_Error = error; }
+  std::string const &GetError() const { return m_Error; }
+  void SetError(std::string_view error) { m_Error.assign(error); }
   void ClearError() { m_Error.clear(); }
 
   bool GetHasWarning() const { return !m_Warning.empty(); }
-  std::string GetWarning() const { return m_Warning; }
-  void SetWarning(std::string const &warning) { m_Warning = warning; }
-  void ClearWarning() { m_Warning.clear(); }
+  std::string const &GetWarning() const { return m_Warning; }
+  void SetWarning(std::string_view warning) {
+    // a warning set again every frame counts once, until a frame without it
+    if (!m_WarningShown && !m_WarningSet)
+      m_WarningCount.fetch_add(1, std::memory_order_relaxed);
+    m_WarningSet = true;
+    m_Warning.assign(warning);
+  }
+  void ClearWarning() {
+    m_WarningShown = m_WarningSet;
+    m_WarningSet = false;
+    m_Warning.clear();
+  }
+
+  // called by the executor for every pass failing on this node
+  void CountError() { m_ErrorCount.fetch_add(1, std::memory_order_relaxed); }
 
+  // passes that failed on the node and warnings it started showing. May be
+  // read from any thread
+  [[nodiscard]] auto GetErrorCount() const -> uint64_t {
+    return m_ErrorCount.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto GetWarningCount() const -> uint64_t {
+    return m_WarningCount.load(std::memory_order_relaxed);
+  }
+
+  // Message is a literal, or a copy the executor or instanced graph that
+  // caught the exception keeps until its next run, so errors are copied and
+  // thrown without allocating
   struct NodeError {
     Node *NodePtr;
-    std::string Message;
+    std::string_view Message;
   };
 
-  static void Interrupt();
-
 protected:
   int m_Id;
   std::string m_Title;
   std::string m_Name;
   ImVec2 m_Position;
-  std::vector<Attribute> m_Attributes;
+  // arena the node was created in, outlives the attributes allocated from it
+  std::shared_ptr<utils::Arena> m_Arena;
+  NodeTypeDescriptor const *m_Type;
+  std::pmr::vector<Attribute> m_Attributes;
   bool m_Stateful;
   std::string m_CurrentError;
   bool m_ShouldUpdate{true};
-  std::set<size_t> m_ProcessedInputs;
+  // one flag per attribute, sized with the attributes so passes never
+  // allocate
+  std::pmr::vector<bool> m_ProcessedInputs;
   std::string m_Error;
   std::string m_Warning;
+  // whether a warning was set since the last ClearWarning, and before it
+  bool m_WarningSet = false;
+  bool m_WarningShown = false;
   bool m_ShouldRenderViewer{true};
   bool m_ShowTitleBar{true};
-
-  static int s_Id;
+  bool m_EditCommitted = false;
+  std::atomic<uint64_t> m_PropertyVersion{0};
+  std::atomic<uint64_t> m_ErrorCount{0};
+  std::atomic<uint64_t> m_WarningCount{0};
 
 protected:
   auto GetAttribute(size_t index) -> Attribute & {
@@ -269,22 +443,32 @@ protected:
     return connected_attribute.begin()->second;
   }
 
+  // the value slot an output writes to, connectivity comes from the active
+  // execution plan when processing
+  auto GetOutputSlot(Attribute &attribute) -> Attribute::ValueType &;
+
   void MarkInputProcessed(size_t index);
-  void UnmarkInputProcessed(size_t index) { m_ProcessedInputs.erase(index); }
+  void UnmarkInputProcessed(size_t index) { m_ProcessedInputs[index] = false; }
 
   NodeState m_State{NodeState_OK};
 
-  [[noreturn]] void ThrowNodeError(std::string const &message) {
-    throw NodeError{this, message};
+  // only takes literals, which outlive any error holding them
+  template <size_t N>
+  [[noreturn]] void ThrowNodeError(char const (&message)[N]) {
+    throw NodeError{this, std::string_view(message, N - 1)};
   }
 
-  void SetAttributes(std::vector<Attribute> attributes) {
-    m_Attributes = std::move(attributes);
-
-    for (auto &attr : m_Attributes) {
-      attr.SetParentNode(this);
+  // long running nodes should poll this and return early, the executor only
+  // checks for cancellation between nodes
+  [[nodiscard]] static auto IsCancellationRequested() -> bool;
+  void ThrowIfCancelled() {
+    if (IsCancellationRequested()) {
+      ThrowNodeError("Execution cancelled!");
     }
   }
+
+  // replaces the attributes with fresh ones for the ports of type
+  void SetNodeType(NodeTypeDescriptor const &type);
 };
 
 } // namespace dynamic_editor::nodes
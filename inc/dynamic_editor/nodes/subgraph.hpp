@@ -0,0 +1,95 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+#include <dynamic_editor/utils/arena.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::nodes {
+
+// An inner attribute exposed on the subgraph node.
+struct SubgraphPort {
+  std::string Name;
+  // id of the inner node in SubgraphDefinition::Graph
+  int NodeId;
+  size_t AttributeIndex;
+};
+
+// A reusable group of nodes, saved once and referenced by every
+// SubgraphNode built from it.
+struct SubgraphDefinition {
+  std::string Name;
+  // {"nodes": [...], "links": [...]} in the format of Editor::DumpNodes
+  nlohmann::json Graph;
+  std::vector<SubgraphPort> Ports;
+
+  [[nodiscard]] auto Dump() const -> nlohmann::json;
+  static auto Load(std::string name, nlohmann::json const &data)
+      -> std::shared_ptr<SubgraphDefinition>;
+};
+
+// Stands for its own private copy of the nodes of a definition. The
+// execution plan inlines the inner nodes, so a subgraph costs nothing extra
+// while processing and is never processed itself. Its outputs publish the
+// values of the inner outputs behind them.
+//
+// Inner nodes, their attributes and links get ids from the graph the node
+// is created for, see NodeHolder::GetCreating, so they collide neither with
+// the other ids of the graph nor with other instances of the definition.
+// They are never placed in the viewer grid.
+class SubgraphNode : public Node {
+public:
+  struct PortTarget {
+    std::shared_ptr<nodes::Node> Node;
+    size_t Index;
+  };
+
+  SubgraphNode(std::string name,
+               std::shared_ptr<const SubgraphDefinition> definition);
+
+  [[nodiscard]] auto GetDefinition() const
+      -> std::shared_ptr<const SubgraphDefinition> const & {
+    return m_Definition;
+  }
+  [[nodiscard]] auto GetInnerNodes() const
+      -> std::vector<std::shared_ptr<Node>> const & {
+    return m_InnerNodes;
+  }
+  // ids the inner nodes have in the definition, same order as
+  // GetInnerNodes. The same for every instance and run, unlike their own
+  [[nodiscard]] auto GetInnerNodeIds() const -> std::vector<int> const & {
+    return m_InnerNodeIds;
+  }
+  [[nodiscard]] auto GetInnerLinks() const
+      -> std::vector<runtime::PlanLink> const & {
+    return m_InnerLinks;
+  }
+  // inner attribute behind the attribute at index, nullptr if unresolved
+  [[nodiscard]] auto GetPortTarget(size_t index) const -> PortTarget const *;
+  // false once a different definition was registered under the name, the
+  // node then has to be replaced by a fresh one
+  [[nodiscard]] auto IsCurrent() const -> bool;
+
+  void Process() override;
+  void DrawPropertiesContent() override;
+  void Dump(nlohmann::json &data) const override;
+
+private:
+  void Instantiate();
+
+  std::shared_ptr<const SubgraphDefinition> m_Definition;
+  // arena of the graph the node was created in, inner nodes go there too
+  std::shared_ptr<utils::Arena> m_Arena;
+  std::vector<std::shared_ptr<Node>> m_InnerNodes;
+  std::vector<int> m_InnerNodeIds;
+  std::vector<runtime::PlanLink> m_InnerLinks;
+  std::vector<PortTarget> m_Ports;
+};
+
+} // namespace dynamic_editor::nodes
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+namespace dynamic_editor::nodes {
+
+// String literal usable as a template argument.
+template <size_t N> struct FixedString {
+  constexpr FixedString(char const (&value)[N]) {
+    std::copy_n(value, N, Value);
+  }
+
+  char Value[N]{};
+};
+
+template <typename T> struct PortType;
+template <> struct PortType<float> {
+  static constexpr Attribute::Type Value = Attribute::Type::Float;
+};
+template <> struct PortType<bool> {
+  static constexpr Attribute::Type Value = Attribute::Type::Boolean;
+};
+template <> struct PortType<int> {
+  static constexpr Attribute::Type Value = Attribute::Type::Int;
+};
+template <> struct PortType<Attribute::Buffer> {
+  static constexpr Attribute::Type Value = Attribute::Type::Buffer;
+};
+
+template <typename T, FixedString Name> struct In {
+  using ValueType = T;
+  static constexpr Attribute::IO Io = Attribute::IO::In;
+  static constexpr auto Label = Name;
+};
+
+template <typename T, FixedString Name> struct Out {
+  using ValueType = T;
+  static constexpr Attribute::IO Io = Attribute::IO::Out;
+  static constexpr auto Label = Name;
+};
+
+// Node whose attributes are given by its template arguments, e.g.
+// TypedNode<In<float, "Min">, In<float, "Max">, Out<float, "Value">>.
+// Ports are addressed by index at compile time. During a pass every port is
+// bound to the value slot it reads or writes once per plan, so accessing it
+// skips the connection lookups and the type dispatch of GetValueOnInput and
+// SetFloatOnOutput. Outside a pass, e.g. in CheckForErrors, inputs read the
+// published value of their source, see Attribute::ReadInput.
+template <typename... Ports> class TypedNode : public Node {
+public:
+  explicit TypedNode(std::string name)
+      : Node(std::move(name), GetNodeType()) {}
+
+  static auto GetNodeType() -> NodeTypeDescriptor const & {
+    static auto const &s_type = NodeTypeDescriptor::Intern(
+        {{Ports::Io, PortType<typename Ports::ValueType>::Value,
+          Ports::Label.Value}...});
+    return s_type;
+  }
+
+  void BindPlan(runtime::ExecutionPlan const &plan) override {
+    m_BoundPlan = &plan;
+    m_BoundVersion = plan.Version;
+    BindSlots(plan, std::index_sequence_for<Ports...>{});
+  }
+
+protected:
+  template <size_t I>
+  using Port = std::tuple_element_t<I, std::tuple<Ports...>>;
+  template <size_t I> using ValueAt = typename Port<I>::ValueType;
+
+  template <size_t I> auto Input() -> ValueAt<I> {
+    static_assert(Port<I>::Io == Attribute::IO::In, "not an input port");
+    if (auto *slot = GetBoundSlot(I)) {
+      if (auto const *value = std::get_if<ValueAt<I>>(slot))
+        return *value;
+      ThrowNodeError("Attribute not connected!");
+    }
+    // the UI thread reads a copy, the source is never processed for it
+    if (runtime::ExecutionPlan::GetActive() == nullptr) {
+      auto const *value =
+          std::get_if<ValueAt<I>>(&GetAttributes()[I].ReadInput());
+      return value != nullptr ? *value : ValueAt<I>{};
+    }
+    return GetTOnInput<ValueAt<I>>(I).value_or(ValueAt<I>{});
+  }
+
+  template <size_t I> void Output(ValueAt<I> value) {
+    static_assert(Port<I>::Io == Attribute::IO::Out, "not an output port");
+    if (auto *slot = GetBoundSlot(I)) {
+      slot->template emplace<ValueAt<I>>(std::move(value));
+      return;
+    }
+    GetOutputSlot(GetAttributes()[I]) = std::move(value);
+  }
+
+  // the value property editors change in place, the default of an input or
+  // what an output holds while it is not linked
+  template <size_t I> auto Default() -> ValueAt<I> * {
+    return std::get_if<ValueAt<I>>(&GetAttributes()[I].GetValue(false));
+  }
+
+private:
+  // nullptr outside of a pass of the bound plan
+  auto GetBoundSlot(size_t index) -> Attribute::ValueType * {
+    auto const *plan = runtime::ExecutionPlan::GetActive();
+    if (plan == nullptr || plan != m_BoundPlan ||
+        plan->Version != m_BoundVersion)
+      return nullptr;
+    return m_Slots[index];
+  }
+
+  template <size_t... I>
+  void BindSlots(runtime::ExecutionPlan const &plan,
+                 std::index_sequence<I...> /*indices*/) {
+    (BindSlot<I>(plan), ...);
+  }
+
+  template <size_t I> void BindSlot(runtime::ExecutionPlan const &plan) {
+    auto &attribute = GetAttributes()[I];
+    if constexpr (Port<I>::Io == Attribute::IO::Out) {
+      m_Slots[I] = &attribute.GetValue(plan.IsConnected(&attribute));
+    } else if (auto *source = plan.FindSource(&attribute)) {
+      // links between different types keep converting through GetTOnInput
+      m_Slots[I] = source->GetType() == attribute.GetType()
+                       ? &source->GetValue(true)
+                       : nullptr;
+    } else {
+      m_Slots[I] = &plan.FindDefault(&attribute)->GetValue(false);
+    }
+  }
+
+  runtime::ExecutionPlan const *m_BoundPlan = nullptr;
+  uint64_t m_BoundVersion = 0;
+  std::array<Attribute::ValueType *, sizeof...(Ports)> m_Slots{};
+};
+
+} // namespace dynamic_editor::nodes
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/cancellation.hpp>
+#include <dynamic_editor/runtime/expression.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+struct ExecutionPlan;
+
+enum class Opcode : uint8_t {
+  // r[Dst] = Loads[A]
+  Load,
+  // Stores[Dst] = r[A]
+  Store,
+  // Calls[A]->Process()
+  Call,
+  // r[Dst] = op r[A]
+  Negate,
+  Abs,
+  // r[Dst] = r[A] op r[B]
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Min,
+  Max,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+  Equal,
+};
+
+// A whole plan lowered to register code. Every value computed by a node
+// with an expression lives in a float register, such nodes become native
+// instructions. Other nodes become calls to Process() and read their inputs
+// from attributes as usual, so every native output is stored back right
+// after it is computed, which also keeps its published value current.
+// Native nodes read it from its register.
+struct BytecodeProgram {
+  struct Instruction {
+    Opcode Op;
+    uint32_t Dst;
+    uint32_t A;
+    uint32_t B;
+  };
+
+  std::vector<Instruction> Code;
+  std::vector<ScalarSlot> Loads;
+  std::vector<ScalarSlot> Stores;
+  std::vector<nodes::Node *> Calls;
+  // register file at the start of a pass, holds the constants
+  std::vector<float> Registers;
+
+  // runs the program once, the register file has to start out as a copy of
+  // Registers. Stops before the next call once token is cancelled and
+  // publishes the node being called through current
+  void Run(std::span<float> registers, CancellationToken const &token,
+           std::atomic<nodes::Node *> &current) const;
+};
+
+// lowers plan.Order into plan.Program
+void CompileBytecode(ExecutionPlan &plan);
+
+} // namespace dynamic_editor::runtime
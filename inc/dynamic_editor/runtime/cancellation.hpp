@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+
+namespace dynamic_editor::runtime {
+
+// Cancellation flag of a single run. The executor checks it between nodes,
+// long running nodes should poll it through Node::IsCancellationRequested.
+class CancellationToken {
+public:
+  void Cancel() { m_Cancelled.store(true, std::memory_order_release); }
+  [[nodiscard]] auto IsCancelled() const -> bool {
+    return m_Cancelled.load(std::memory_order_acquire);
+  }
+
+  // token of the run on the calling thread, nullptr everywhere else
+  static auto GetCurrent() -> CancellationToken const *;
+
+private:
+  std::atomic<bool> m_Cancelled{false};
+};
+
+// Makes a token the current one on the calling thread for its lifetime.
+class CancellationScope {
+public:
+  explicit CancellationScope(CancellationToken const &token);
+  ~CancellationScope();
+
+  CancellationScope(CancellationScope const &) = delete;
+  CancellationScope &operator=(CancellationScope const &) = delete;
+
+private:
+  CancellationToken const *m_Previous;
+};
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/cancellation.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+#include <dynamic_editor/utils/histogram.hpp>
+#include <dynamic_editor/utils/mpsc_queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+// Sees every pass of an executor, called on the thread running the pass.
+class PassObserver {
+public:
+  virtual ~PassObserver() = default;
+
+  // before any node began the pass, inputs may still be changed here
+  virtual void BeforePass(ExecutionPlan const & /*plan*/) {}
+  // every node began the pass, what the pass runs on is final
+  virtual void PassStarted(ExecutionPlan const & /*plan*/) {}
+  // the pass ran to completion, not called for failed or cancelled passes
+  virtual void PassFinished(ExecutionPlan const & /*plan*/) {}
+};
+
+namespace command {
+
+struct AddNode {
+  std::shared_ptr<nodes::Node> Node;
+};
+struct EraseNode {
+  int Id;
+};
+// attributes are referenced by their owning node and index, the node handles
+// keep them valid no matter what the UI does with the link afterwards
+struct AddLink {
+  int Id;
+  std::shared_ptr<nodes::Node> FromNode;
+  size_t FromIndex;
+  std::shared_ptr<nodes::Node> ToNode;
+  size_t ToIndex;
+};
+struct EraseLink {
+  int Id;
+};
+struct Clear {};
+// observers are called in the order they were added, neither command
+// recompiles the plan
+struct AddObserver {
+  std::shared_ptr<PassObserver> Observer;
+};
+struct RemoveObserver {
+  PassObserver const *Observer;
+};
+
+} // namespace command
+
+using GraphCommand =
+    std::variant<command::AddNode, command::EraseNode, command::AddLink,
+                 command::EraseLink, command::Clear, command::AddObserver,
+                 command::RemoveObserver>;
+
+// Counters of an executor. Only relaxed atomics, so they are updated on
+// every pass and may be read from any thread.
+struct ExecutorMetrics {
+  std::atomic<uint64_t> Passes{0};
+  std::atomic<uint64_t> FailedPasses{0};
+  // command batches pushed and taken off the queue, the difference is the
+  // queue depth
+  std::atomic<uint64_t> SubmittedBatches{0};
+  std::atomic<uint64_t> AppliedBatches{0};
+  utils::LatencyHistogram PassDuration;
+};
+
+// Owns the graph and the thread that processes it. Structural edits are
+// submitted as commands on a lock-free queue and applied between passes,
+// after which the plan is recompiled and published. Nothing the UI does to
+// its own node list or the attribute connection maps is observed mid-pass.
+class Executor {
+public:
+  Executor() = default;
+  ~Executor();
+
+  Executor(Executor const &) = delete;
+  Executor &operator=(Executor const &) = delete;
+
+  // may be called from any thread
+  void Submit(GraphCommand command);
+
+  // commands the calling thread submits between BeginBatch and EndBatch are
+  // applied in the same pass boundary, batches may be nested. Commands other
+  // threads submit meanwhile are queued on their own. Only one thread at a
+  // time may batch, usually the UI thread
+  void BeginBatch();
+  void EndBatch();
+
+  // Start, Stop and Poll belong to the thread controlling the executor.
+  // A run is a single pass, or passes until stopped when continuous
+  void Start(bool continuous);
+  // cancels the current run without waiting for it, the run ends at the next
+  // node boundary or when the running node polls its token
+  void Stop();
+  // joins a finished run, returns whether a run is still in progress
+  auto Poll() -> bool;
+  [[nodiscard]] auto IsRunning() const -> bool {
+    return m_Thread.joinable();
+  }
+  // runs a single pass on the calling thread and returns its error, for
+  // headless drivers such as api::ReplayRecording. Not to be mixed with runs
+  // started by Start
+  auto RunOnce() -> std::optional<nodes::Node::NodeError>;
+
+  // takes effect at the end of the current pass
+  void SetContinuous(bool continuous) {
+    m_Continuous.store(continuous, std::memory_order_relaxed);
+  }
+
+  // opt-in operator fusion, see FuseExpressions. The plan is recompiled at
+  // the next pass boundary. Fused nodes are not processed on their own, so
+  // outputs only read inside their group keep their last value
+  void SetFusion(bool fuse) { m_Fuse.store(fuse, std::memory_order_relaxed); }
+  // runs passes through the bytecode interpreter instead of node by node,
+  // see CompileBytecode. Also recompiles at the next pass boundary
+  void SetBytecode(bool bytecode) {
+    m_Bytecode.store(bytecode, std::memory_order_relaxed);
+  }
+
+  // error that ended the last run, if any
+  auto TakeError() -> std::optional<nodes::Node::NodeError>;
+
+  // heap allocations made by the last pass of a run or RunOnce, including
+  // the commands and compilation it applied first. A pass over an unchanged
+  // graph makes none. Only counted with IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS,
+  // which does not see the exception object of a failing pass, the C++
+  // runtime allocates it with malloc
+  [[nodiscard]] auto GetPassAllocations() const -> uint64_t {
+    return m_PassAllocations.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto GetMetrics() const -> ExecutorMetrics const & {
+    return m_Metrics;
+  }
+
+  // a node still running this long after Stop is reported as overrunning
+  void SetCancelLatencyBound(std::chrono::milliseconds bound) {
+    m_CancelLatencyBound = bound;
+  }
+  [[nodiscard]] auto GetCancelLatencyBound() const
+      -> std::chrono::milliseconds {
+    return m_CancelLatencyBound;
+  }
+  // node that ignored Stop for longer than the latency bound, it stays
+  // alive until the run is joined
+  [[nodiscard]] auto GetOverrunNode() const -> nodes::Node *;
+
+  // the most recently published plan, may be called from any thread
+  [[nodiscard]] auto GetPlan() const -> std::shared_ptr<const ExecutionPlan>;
+
+private:
+  void RunLoop(CancellationToken const &token);
+  auto RunPass(CancellationToken const &token)
+      -> std::optional<nodes::Node::NodeError>;
+  void RunSteps(ExecutionPlan const &plan, CancellationToken const &token);
+  // RunPass counted in the metrics
+  auto RunMeasuredPass(CancellationToken const &token)
+      -> std::optional<nodes::Node::NodeError>;
+
+  // the constants of plan were not processed yet, or something they read
+  // changed since
+  [[nodiscard]] auto ConstantsChanged(ExecutionPlan const &plan) const
+      -> bool;
+  void FoldConstants(ExecutionPlan const &plan);
+
+  // both return whether the graph changed
+  auto ApplyCommands() -> bool;
+  auto Apply(GraphCommand &command) -> bool;
+  void Compile(PlanOptions options);
+
+  utils::MpscQueue<std::vector<GraphCommand>> m_Commands;
+  // owned by the thread in m_BatchThread while a batch is open
+  std::vector<GraphCommand> m_Batch;
+  int m_BatchDepth = 0;
+  std::atomic<std::thread::id> m_BatchThread;
+
+  // only touched by the thread running passes
+  std::map<int, std::shared_ptr<nodes::Node>> m_GraphNodes;
+  std::map<int, PlanLink> m_GraphLinks;
+  uint64_t m_Version = 0;
+  PlanOptions m_Options;
+  std::vector<float> m_Registers;
+  // what the constants were last processed from
+  uint64_t m_FoldedVersion = 0;
+  std::vector<nodes::Attribute::ValueType> m_FoldedInputs;
+  std::vector<uint64_t> m_FoldedProperties;
+
+  std::shared_ptr<const ExecutionPlan> m_Plan;
+  std::vector<std::shared_ptr<PassObserver>> m_Observers;
+
+  // run control, owned by the controlling thread
+  std::thread m_Thread;
+  std::shared_ptr<CancellationToken> m_Token;
+  std::optional<std::chrono::steady_clock::time_point> m_StopRequested;
+  std::chrono::milliseconds m_CancelLatencyBound{250};
+
+  // shared with the run
+  std::atomic<bool> m_Continuous{false};
+  std::atomic<bool> m_Fuse{false};
+  std::atomic<bool> m_Bytecode{false};
+  std::atomic<bool> m_Finished{true};
+  std::atomic<nodes::Node *> m_CurrentNode{nullptr};
+  std::atomic<uint64_t> m_PassAllocations{0};
+  ExecutorMetrics m_Metrics;
+  std::mutex m_ErrorMutex;
+  std::optional<nodes::Node::NodeError> m_Error;
+  // message of an exception a node threw, m_Error views it
+  std::array<char, 256> m_ExceptionMessage{};
+};
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+struct ExecutionPlan;
+
+enum class ExprOp : uint8_t {
+  Input,
+  Constant,
+  // unary
+  Negate,
+  Abs,
+  // binary
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Min,
+  Max,
+  // binary, 1 when true and 0 otherwise
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+  Equal,
+};
+
+// A small scalar expression over the inputs of a single node, see
+// Node::DescribeExpression. Every value is a float, booleans are 1 and 0.
+class ExpressionBuilder {
+public:
+  using Ref = int;
+
+  struct Term {
+    ExprOp Op;
+    Ref Lhs;
+    Ref Rhs;
+    // Constant only
+    float Value;
+    // Input only, index of the attribute on the node
+    size_t Input;
+  };
+
+  auto Input(size_t index) -> Ref;
+  auto Constant(float value) -> Ref;
+  auto Unary(ExprOp op, Ref operand) -> Ref;
+  auto Binary(ExprOp op, Ref lhs, Ref rhs) -> Ref;
+
+  auto Add(Ref lhs, Ref rhs) -> Ref { return Binary(ExprOp::Add, lhs, rhs); }
+  auto Multiply(Ref lhs, Ref rhs) -> Ref {
+    return Binary(ExprOp::Multiply, lhs, rhs);
+  }
+  auto Clamp(Ref value, Ref min, Ref max) -> Ref {
+    return Binary(ExprOp::Min, Binary(ExprOp::Max, value, min), max);
+  }
+
+  [[nodiscard]] auto GetTerms() const -> std::vector<Term> const & {
+    return m_Terms;
+  }
+  void Clear() { m_Terms.clear(); }
+
+private:
+  std::vector<Term> m_Terms;
+};
+
+// every attribute of the node is a float or a bool and every output is
+// described by a valid expression of its inputs
+auto IsExpressible(nodes::Node const &node) -> bool;
+
+// An attribute value seen as a float by compiled expressions.
+struct ScalarSlot {
+  nodes::Attribute *Attribute;
+  bool Connected;
+  // node reported when the value is missing
+  nodes::Node *Reader;
+};
+
+inline auto ReadScalar(ScalarSlot const &slot) -> float {
+  auto const &value = slot.Attribute->GetValue(slot.Connected);
+  if (auto const *f = std::get_if<float>(&value))
+    return *f;
+  if (auto const *b = std::get_if<bool>(&value))
+    return *b ? 1.0F : 0.0F;
+  if (auto const *i = std::get_if<int>(&value))
+    return static_cast<float>(*i);
+  throw nodes::Node::NodeError{slot.Reader, "Attribute not connected!"};
+}
+
+inline void WriteScalar(ScalarSlot const &slot, float value) {
+  auto &target = slot.Attribute->GetValue(slot.Connected);
+  if (slot.Attribute->GetType() == nodes::Attribute::Type::Boolean)
+    target = value != 0.0F;
+  else
+    target = value;
+}
+
+// The outputs of a group of fused nodes compiled into one postfix program.
+// Each output is computed once and stored into its attribute, the nodes it
+// is inlined into load it back from there. Intermediate values of a single
+// output never leave the evaluation stack.
+struct FusedKernel {
+  struct Instruction {
+    ExprOp Op;
+    // index into Loads for Input, into Constants for Constant
+    uint32_t Operand;
+  };
+  struct Store {
+    ScalarSlot Slot;
+    // Code[previous End, End) computes the value
+    size_t End;
+  };
+
+  // deeper expressions are not fused
+  static constexpr size_t MaxStack = 32;
+
+  std::vector<Instruction> Code;
+  std::vector<float> Constants;
+  std::vector<ScalarSlot> Loads;
+  std::vector<Store> Stores;
+  // every node folded into the kernel, dependencies first
+  std::vector<nodes::Node *> Nodes;
+
+  // throws Node::NodeError for loads without a value
+  void Run() const;
+};
+
+// Replaces the steps of groups of fusible nodes in plan.Steps by fused
+// kernels. A fusible node joins the group of its consumer when its only link
+// goes to another fusible node, so linear chains and trees become a single
+// kernel while shared values are computed once.
+void FuseExpressions(ExecutionPlan &plan);
+
+} // namespace dynamic_editor::runtime
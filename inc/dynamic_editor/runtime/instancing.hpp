@@ -0,0 +1,176 @@
+#pragma once
+
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/cancellation.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+// One value per instance, stored as a plain array of the attribute type.
+// Booleans are stored as uint8_t so the column stays addressable.
+struct InstanceColumn {
+  nodes::Attribute::Type Type;
+  std::vector<float> Floats;
+  std::vector<int> Ints;
+  std::vector<uint8_t> Bools;
+  std::vector<nodes::Attribute::Buffer> Buffers;
+
+  template <typename T> auto Values() -> std::span<T> {
+    if constexpr (std::is_same_v<T, float>)
+      return Floats;
+    else if constexpr (std::is_same_v<T, int>)
+      return Ints;
+    else if constexpr (std::is_same_v<T, nodes::Attribute::Buffer>)
+      return Buffers;
+    else {
+      static_assert(std::is_same_v<T, uint8_t>, "unsupported column type");
+      return Bools;
+    }
+  }
+
+  auto Get(size_t instance) const -> nodes::Attribute::ValueType;
+  void Set(size_t instance, nodes::Attribute::ValueType const &value);
+};
+
+// The instances [begin, begin + count) of a single node, handed to
+// Node::ProcessInstances.
+class InstanceBlock {
+public:
+  InstanceBlock(std::vector<InstanceColumn *> const &columns,
+                std::vector<std::byte> &state, size_t begin, size_t count)
+      : m_Columns(columns), m_State(state), m_Begin(begin), m_Count(count) {}
+
+  [[nodiscard]] auto GetBegin() const -> size_t { return m_Begin; }
+  [[nodiscard]] auto GetCount() const -> size_t { return m_Count; }
+
+  // values of the attribute at index for the instances of this block, inputs
+  // that are linked see the output of their source
+  template <typename T> auto Input(size_t index) const -> std::span<const T> {
+    return Column<T>(index);
+  }
+  template <typename T> auto Output(size_t index) -> std::span<T> {
+    return Column<T>(index);
+  }
+
+  // Calls op for every instance with the values of the inputs 0 to N - 1,
+  // of the types Inputs, and stores what it returns in the output at N.
+  // Returns false if a port has no column of that type, which
+  // ProcessInstances passes on to run the instances through Process()
+  template <typename Result, typename... Inputs, typename Op>
+  auto Map(Op op) -> bool {
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+      std::tuple<std::span<const Inputs>...> const inputs{
+          Input<Inputs>(I)...};
+      auto const result = Output<Result>(sizeof...(Inputs));
+      if (result.size() != m_Count ||
+          ((std::get<I>(inputs).size() != m_Count) || ...))
+        return false;
+
+      for (size_t i = 0; i < m_Count; i++)
+        result[i] = op(std::get<I>(inputs)[i]...);
+      return true;
+    }(std::index_sequence_for<Inputs...>{});
+  }
+
+  // per instance state of the node, zero initialized. T has to fit the size
+  // returned by Node::GetInstanceStateSize
+  template <typename T> auto State() -> std::span<T> {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+    if (m_State.size() < (m_Begin + m_Count) * sizeof(T))
+      return {};
+    return {reinterpret_cast<T *>(m_State.data()) + m_Begin, m_Count};
+  }
+
+private:
+  template <typename T> auto Column(size_t index) const -> std::span<T> {
+    if (index >= m_Columns.size() || m_Columns[index] == nullptr)
+      return {};
+    return m_Columns[index]->Values<T>().subspan(m_Begin, m_Count);
+  }
+
+  std::vector<InstanceColumn *> const &m_Columns;
+  std::vector<std::byte> &m_State;
+  size_t m_Begin;
+  size_t m_Count;
+};
+
+// Evaluates one compiled topology over many instances that only differ in the
+// values of their unlinked inputs. Values live in one column per attribute,
+// nodes opting into Node::ProcessInstances process a whole block of
+// instances per call. Other nodes are processed one instance at a time on a
+// clone owned by the worker. A clone is shared by the instances of its
+// worker, so nodes with runtime state, see Node::SaveState, have to opt in,
+// Run fails on them otherwise.
+class InstancedGraph {
+public:
+  // has to be created on the UI thread, the fallback clones are made by
+  // dumping and loading the nodes of the plan
+  InstancedGraph(std::shared_ptr<const ExecutionPlan> plan, size_t instances,
+                 size_t workers = 0);
+
+  [[nodiscard]] auto GetInstanceCount() const -> size_t {
+    return m_Instances;
+  }
+  [[nodiscard]] auto GetWorkerCount() const -> size_t {
+    return m_Workers.size();
+  }
+
+  // per instance value of an unlinked input, or an output after Run
+  void SetValue(size_t instance, int attribute_id,
+                nodes::Attribute::ValueType const &value);
+  [[nodiscard]] auto GetValue(size_t instance, int attribute_id) const
+      -> nodes::Attribute::ValueType;
+  auto GetColumn(int attribute_id) -> InstanceColumn *;
+
+  // evaluates every instance once, blocks until all workers are done
+  auto Run(CancellationToken const *token = nullptr)
+      -> std::optional<nodes::Node::NodeError>;
+
+private:
+  struct Step {
+    nodes::Node *Node;
+    // interned once, what the trace spans of the node are called
+    std::string_view Name;
+    // one per attribute of the node, nullptr for untyped attributes
+    std::vector<InstanceColumn *> Columns;
+    std::vector<std::byte> State;
+    // saves runtime state, so it can not fall back to clones
+    bool Stateful;
+  };
+
+  struct Worker {
+    size_t Begin;
+    size_t Count;
+    // same order as m_Steps, empty when every node has a kernel
+    std::vector<std::shared_ptr<nodes::Node>> Clones;
+    std::optional<nodes::Node::NodeError> Error;
+    // message of an exception a node threw, Error views it
+    std::array<char, 256> Message{};
+  };
+
+  void RunWorker(Worker &worker, CancellationToken const *token);
+
+  std::shared_ptr<const ExecutionPlan> m_Plan;
+  size_t m_Instances;
+  std::vector<std::unique_ptr<InstanceColumn>> m_Columns;
+  std::unordered_map<int, InstanceColumn *> m_ColumnsById;
+  std::vector<Step> m_Steps;
+  std::vector<Worker> m_Workers;
+};
+
+} // namespace dynamic_editor::runtime
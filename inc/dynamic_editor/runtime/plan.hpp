@@ -0,0 +1,143 @@
+#pragma once
+
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/bytecode.hpp>
+#include <dynamic_editor/runtime/expression.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+// A node processed on its own, or a group of fused nodes ending in Node.
+struct PlanStep {
+  nodes::Node *Node;
+  FusedKernel const *Kernel;
+  // name of Node interned at compile time, what its trace spans are called
+  std::string_view Name;
+};
+
+// Backends a plan can be compiled for.
+struct PlanOptions {
+  // run FuseExpressions over the steps
+  bool Fuse = false;
+  // lower the plan with CompileBytecode, takes precedence over Fuse
+  bool Bytecode = false;
+
+  auto operator==(PlanOptions const &) const -> bool = default;
+};
+
+// Immutable snapshot of the graph compiled by the executor. While a pass runs
+// nodes resolve their connections through the plan instead of the attribute
+// connection maps, which belong to the UI thread.
+struct ExecutionPlan {
+  // every node of the graph, the plan keeps them alive for as long as a pass
+  // might still use it
+  std::vector<std::shared_ptr<nodes::Node>> Nodes;
+  // ids leading to each of Nodes from the top level graph, enclosing
+  // subgraph nodes first. Inner nodes appear with their id in the
+  // definition, so a path identifies a node across runs of the same document
+  std::vector<std::vector<int>> NodePaths;
+  // nodes feeding an end node, dependencies first
+  std::vector<nodes::Node *> Order;
+  // pure nodes whose inputs are all unlinked or fed by other such nodes,
+  // dependencies first. They are left out of Steps and Program, the
+  // executor processes them again only when ConstantInputs or their
+  // properties change
+  std::vector<nodes::Node *> Constants;
+  std::unordered_set<nodes::Node const *> ConstantNodes;
+  // attributes holding the defaults read by Constants
+  std::vector<nodes::Attribute *> ConstantInputs;
+  // what a pass runs, Order without Constants and with fused groups
+  // collapsed into their kernel
+  std::vector<PlanStep> Steps;
+  std::vector<std::unique_ptr<FusedKernel>> Kernels;
+  // replaces Steps when the plan was lowered to bytecode
+  std::unique_ptr<BytecodeProgram> Program;
+  // nodes whose expression was compiled into a kernel or the program, with
+  // their property version at that time
+  std::vector<std::pair<nodes::Node *, uint64_t>> ExpressionVersions;
+  // input attribute -> output attribute it is linked to
+  std::unordered_map<nodes::Attribute const *, nodes::Attribute *> Sources;
+  std::unordered_set<nodes::Attribute const *> ConnectedOutputs;
+  // outputs of Order and whether they are linked, their values are
+  // published to the UI thread after every pass
+  std::vector<std::pair<nodes::Attribute *, bool>> Outputs;
+  // subgraph output ports and the inner output behind each, published along
+  // with Outputs
+  std::vector<std::pair<nodes::Attribute *, nodes::Attribute *>> PortOutputs;
+  // unlinked inner input -> subgraph port whose default it uses
+  std::unordered_map<nodes::Attribute const *, nodes::Attribute *> Defaults;
+  // set when the graph can not be executed, e.g. it contains a cycle
+  std::optional<nodes::Node::NodeError> Error;
+  // backends the plan was compiled for
+  PlanOptions Options;
+  uint64_t Version = 0;
+
+  [[nodiscard]] auto FindSource(nodes::Attribute const *input) const
+      -> nodes::Attribute * {
+    auto it = Sources.find(input);
+    return it != Sources.end() ? it->second : nullptr;
+  }
+  // attribute holding the default value of an unlinked input
+  [[nodiscard]] auto FindDefault(nodes::Attribute *input) const
+      -> nodes::Attribute * {
+    auto it = Defaults.find(input);
+    return it != Defaults.end() ? it->second : input;
+  }
+  [[nodiscard]] auto IsConnected(nodes::Attribute const *output) const
+      -> bool {
+    return ConnectedOutputs.contains(output);
+  }
+  [[nodiscard]] auto IsConstant(nodes::Node const *node) const -> bool {
+    return ConstantNodes.contains(node);
+  }
+  [[nodiscard]] auto HasStaleExpressions() const -> bool {
+    for (auto const &[node, version] : ExpressionVersions) {
+      if (node->GetPropertyVersion() != version)
+        return true;
+    }
+    return false;
+  }
+
+  // plan of the pass running on the calling thread, nullptr everywhere else
+  static auto GetActive() -> ExecutionPlan const *;
+};
+
+// Link between two attributes given by their owning node and index.
+struct PlanLink {
+  std::shared_ptr<nodes::Node> FromNode;
+  size_t FromIndex;
+  std::shared_ptr<nodes::Node> ToNode;
+  size_t ToIndex;
+};
+
+// Builds a plan from a consistent view of a graph. Subgraph nodes are
+// replaced by their inner nodes, links to nodes that are not part of nodes
+// are ignored.
+auto CompilePlan(std::vector<std::shared_ptr<nodes::Node>> nodes,
+                 std::vector<PlanLink> const &links, PlanOptions options = {})
+    -> std::shared_ptr<ExecutionPlan>;
+
+// Makes a plan the active one on the calling thread for its lifetime.
+class ActivePlanScope {
+public:
+  explicit ActivePlanScope(ExecutionPlan const &plan);
+  ~ActivePlanScope();
+
+  ActivePlanScope(ActivePlanScope const &) = delete;
+  ActivePlanScope &operator=(ActivePlanScope const &) = delete;
+
+private:
+  ExecutionPlan const *m_Previous;
+};
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+#include <dynamic_editor/utils/shared_memory.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dynamic_editor::runtime {
+
+// Layout of a snapshot segment, shared by processes built from the same
+// layout version. A header followed by the node, value and sample arrays,
+// each sized by a capacity stored in the header. Everything but the header
+// atomics is only meaningful between two matching reads of Sequence.
+constexpr std::array<char, 4> SnapshotMagic = {'D', 'E', 'S', 'N'};
+constexpr uint32_t SnapshotLayoutVersion = 1;
+constexpr size_t SnapshotNameLength = 48;
+
+struct SnapshotInfo {
+  // passes published so far, and the plan the last one ran on
+  uint64_t Pass;
+  uint64_t PlanVersion;
+  // system clock time of the last publish in nanoseconds since the epoch,
+  // comparable across processes
+  int64_t PublishedAt;
+  uint32_t NodeCount;
+  uint32_t ValueCount;
+  uint32_t SampleCount;
+  // the last pass did not fit the capacities and was cut short
+  uint32_t Truncated;
+};
+
+struct SnapshotHeader {
+  std::array<char, 4> Magic;
+  uint32_t LayoutVersion;
+  uint32_t NodeCapacity;
+  uint32_t ValueCapacity;
+  uint32_t SampleCapacity;
+  // set once the publisher is gone, a new one creates a new segment
+  std::atomic<uint32_t> Closed;
+  // odd while the publisher writes
+  std::atomic<uint64_t> Sequence;
+  SnapshotInfo Info;
+};
+
+struct SnapshotNode {
+  int32_t Id;
+  // outputs of the node, Values[FirstValue, FirstValue + ValueCount)
+  uint32_t FirstValue;
+  uint32_t ValueCount;
+  uint64_t ErrorCount;
+  uint64_t WarningCount;
+  char Title[SnapshotNameLength];
+};
+
+struct SnapshotValue {
+  int32_t AttributeId;
+  // nodes::Attribute::Type, only meaningful if HasValue is set
+  uint8_t Type;
+  uint8_t HasValue;
+  // floats, booleans and ints
+  double Scalar;
+  // buffers, Samples[FirstSample, FirstSample + SampleCount). SampleCount is
+  // less than BufferSize if the buffer was truncated
+  uint32_t FirstSample;
+  uint32_t SampleCount;
+  uint64_t BufferSize;
+  char Name[SnapshotNameLength];
+};
+
+// Capacities of a segment, fixed when it is created.
+struct SnapshotCapacity {
+  uint32_t Nodes = 1024;
+  uint32_t Values = 8192;
+  uint32_t Samples = 1 << 18;
+};
+
+// A consistent copy of a segment in the memory of the reader.
+struct Snapshot {
+  SnapshotInfo Info{};
+  std::vector<SnapshotNode> Nodes;
+  std::vector<SnapshotValue> Values;
+  std::vector<float> Samples;
+};
+
+// Publishes the outputs of every finished pass into a shared memory segment
+// for viewers in other processes, see SnapshotReader. Writes are guarded by
+// a seqlock, so the processing thread never waits on a reader and a stalled
+// or crashed reader can not hold it up. Publishing writes straight into the
+// segment and does not allocate.
+class SnapshotPublisher : public PassObserver {
+public:
+  // nullptr if the segment could not be created
+  static auto Create(std::string const &name, SnapshotCapacity capacity = {})
+      -> std::shared_ptr<SnapshotPublisher>;
+  ~SnapshotPublisher() override;
+
+  SnapshotPublisher(SnapshotPublisher const &) = delete;
+  SnapshotPublisher &operator=(SnapshotPublisher const &) = delete;
+
+  // passes finishing sooner than interval after the last published one are
+  // skipped, every pass is published by default
+  void SetInterval(std::chrono::nanoseconds interval) {
+    m_Interval.store(interval.count(), std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto GetName() const -> std::string const & {
+    return m_Memory->GetName();
+  }
+
+  void PassFinished(ExecutionPlan const &plan) override;
+
+private:
+  explicit SnapshotPublisher(std::unique_ptr<utils::SharedMemory> memory);
+
+  std::unique_ptr<utils::SharedMemory> m_Memory;
+  SnapshotHeader *m_Header;
+  SnapshotNode *m_Nodes;
+  SnapshotValue *m_Values;
+  float *m_Samples;
+
+  std::atomic<int64_t> m_Interval{0};
+  std::chrono::steady_clock::time_point m_LastPublish;
+};
+
+// Read-only view of a segment created by a SnapshotPublisher.
+class SnapshotReader {
+public:
+  // nullptr if there is no segment of that name or it has another layout
+  static auto Open(std::string const &name) -> std::unique_ptr<SnapshotReader>;
+
+  // copies the last published pass into out, reusing its storage. Returns
+  // false if nothing was published yet or the publisher kept overwriting
+  // the segment while it was copied, out is left unspecified then
+  auto Read(Snapshot &out) const -> bool;
+
+  // the publisher of the segment is gone
+  [[nodiscard]] auto IsClosed() const -> bool {
+    return m_Header->Closed.load(std::memory_order_acquire) != 0;
+  }
+
+private:
+  explicit SnapshotReader(std::unique_ptr<utils::SharedMemory> memory);
+
+  std::unique_ptr<utils::SharedMemory> m_Memory;
+  SnapshotHeader const *m_Header;
+};
+
+} // namespace dynamic_editor::runtime
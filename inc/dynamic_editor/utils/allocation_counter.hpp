@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dynamic_editor::utils {
+
+// Heap allocations made by the calling thread so far. Only counted when the
+// library is built with IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS, which replaces
+// the global operator new, otherwise always 0.
+auto GetThreadAllocationCount() -> uint64_t;
+[[nodiscard]] auto IsCountingAllocations() -> bool;
+
+// Allocations the calling thread made since construction.
+class AllocationScope {
+public:
+  AllocationScope() : m_Start(GetThreadAllocationCount()) {}
+
+  [[nodiscard]] auto GetCount() const -> uint64_t {
+    return GetThreadAllocationCount() - m_Start;
+  }
+
+private:
+  uint64_t m_Start;
+};
+
+} // namespace dynamic_editor::utils
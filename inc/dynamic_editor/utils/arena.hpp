@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace dynamic_editor::utils {
+
+// Memory of a single graph. Nodes created through MakeShared while an
+// ArenaScope is active, their attributes and connection maps come from
+// pools of the arena, so nodes of one type sit next to each other and
+// creating them rarely reaches the global heap. Everything allocated from
+// an arena keeps it alive, once the graph drops it and the last of its
+// nodes is gone all of its memory is released at once.
+//
+// Nodes may be released on the processing thread, so the pools are
+// synchronized.
+class Arena : public std::pmr::synchronized_pool_resource {
+public:
+  // arena of the calling thread, nullptr outside of any ArenaScope
+  static auto GetCurrent() -> std::shared_ptr<Arena> const &;
+};
+
+// resource of the current arena, the default resource without one
+auto GetCurrentResource() -> std::pmr::memory_resource *;
+
+// Makes an arena the current one on the calling thread for its lifetime.
+class ArenaScope {
+public:
+  explicit ArenaScope(std::shared_ptr<Arena> arena);
+  ~ArenaScope();
+
+  ArenaScope(ArenaScope const &) = delete;
+  ArenaScope &operator=(ArenaScope const &) = delete;
+
+private:
+  std::shared_ptr<Arena> m_Previous;
+};
+
+// Allocator keeping the arena it allocates from alive, or using the
+// default resource if it has none.
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(std::shared_ptr<Arena> arena)
+      : m_Arena(std::move(arena)) {}
+  template <typename U>
+  ArenaAllocator(ArenaAllocator<U> const &other) : m_Arena(other.GetArena()) {}
+
+  auto allocate(size_t count) -> T * {
+    return static_cast<T *>(
+        GetResource()->allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *pointer, size_t count) {
+    GetResource()->deallocate(pointer, count * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] auto GetArena() const -> std::shared_ptr<Arena> const & {
+    return m_Arena;
+  }
+
+  template <typename U> bool operator==(ArenaAllocator<U> const &rhs) const {
+    return m_Arena == rhs.GetArena();
+  }
+
+private:
+  auto GetResource() const -> std::pmr::memory_resource * {
+    if (m_Arena != nullptr)
+      return m_Arena.get();
+    return std::pmr::get_default_resource();
+  }
+
+  std::shared_ptr<Arena> m_Arena;
+};
+
+// std::make_shared from the current arena
+template <typename T, typename... Args>
+auto MakeShared(Args &&...args) -> std::shared_ptr<T> {
+  return std::allocate_shared<T>(ArenaAllocator<T>(Arena::GetCurrent()),
+                                 std::forward<Args>(args)...);
+}
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace dynamic_editor::utils {
+
+// Appends trivially copyable values to a byte buffer in native byte order.
+// Sequences are prefixed by their element count.
+class BinaryWriter {
+public:
+  explicit BinaryWriter(std::vector<uint8_t> &out) : m_Out(&out) {}
+
+  template <typename T> void Write(T const &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto const *bytes = reinterpret_cast<uint8_t const *>(&value);
+    m_Out->insert(m_Out->end(), bytes, bytes + sizeof(T));
+  }
+  template <typename T> void WriteSpan(std::span<const T> values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Write(static_cast<uint32_t>(values.size()));
+    auto const *bytes = reinterpret_cast<uint8_t const *>(values.data());
+    m_Out->insert(m_Out->end(), bytes, bytes + values.size_bytes());
+  }
+  void WriteString(std::string_view value) {
+    WriteSpan(std::span<const char>(value.data(), value.size()));
+  }
+
+  [[nodiscard]] auto GetSize() const -> size_t { return m_Out->size(); }
+
+private:
+  std::vector<uint8_t> *m_Out;
+};
+
+// Bounds checked cursor over what a BinaryWriter wrote, every read fails
+// once the data ran out and leaves its target alone.
+class BinaryReader {
+public:
+  explicit BinaryReader(std::span<const uint8_t> data) : m_Data(data) {}
+
+  template <typename T> auto Read(T &value) -> bool {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (m_Data.size() - m_Offset < sizeof(T))
+      return false;
+    std::memcpy(&value, m_Data.data() + m_Offset, sizeof(T));
+    m_Offset += sizeof(T);
+    return true;
+  }
+  // reuses the capacity of values
+  template <typename T> auto ReadVector(std::vector<T> &values) -> bool {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::span<const uint8_t> bytes;
+    if (!ReadSequence(sizeof(T), bytes))
+      return false;
+    values.resize(bytes.size() / sizeof(T));
+    std::memcpy(values.data(), bytes.data(), bytes.size());
+    return true;
+  }
+  auto ReadString(std::string &value) -> bool {
+    std::span<const uint8_t> bytes;
+    if (!ReadSequence(1, bytes))
+      return false;
+    value.assign(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+    return true;
+  }
+  // a byte sequence viewed in place, valid as long as the data
+  auto ReadBytes(std::span<const uint8_t> &bytes) -> bool {
+    return ReadSequence(1, bytes);
+  }
+  auto Skip(size_t size) -> bool {
+    if (m_Data.size() - m_Offset < size)
+      return false;
+    m_Offset += size;
+    return true;
+  }
+
+  [[nodiscard]] auto GetOffset() const -> size_t { return m_Offset; }
+  [[nodiscard]] auto AtEnd() const -> bool {
+    return m_Offset == m_Data.size();
+  }
+
+private:
+  auto ReadSequence(size_t element_size, std::span<const uint8_t> &bytes)
+      -> bool {
+    size_t const offset = m_Offset;
+    uint32_t count = 0;
+    if (!Read(count) || (m_Data.size() - m_Offset) / element_size < count) {
+      m_Offset = offset;
+      return false;
+    }
+    bytes = m_Data.subspan(m_Offset, count * element_size);
+    m_Offset += bytes.size();
+    return true;
+  }
+
+  std::span<const uint8_t> m_Data;
+  size_t m_Offset = 0;
+};
+
+} // namespace dynamic_editor::utils
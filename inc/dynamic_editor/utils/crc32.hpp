@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace dynamic_editor::utils {
+
+// CRC-32 as used by zlib, so files can be checked with common tools.
+inline auto Crc32(void const *data, size_t size) -> uint32_t {
+  static constexpr auto table = [] {
+    std::array<uint32_t, 256> result{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+      result[i] = crc;
+    }
+    return result;
+  }();
+
+  auto const *bytes = static_cast<uint8_t const *>(data);
+  uint32_t crc = 0xFFFFFFFFU;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+inline auto Crc32(std::string_view data) -> uint32_t {
+  return Crc32(data.data(), data.size());
+}
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+namespace dynamic_editor::utils {
+
+// Replaces the file at path with data so that a crash or power loss leaves
+// either the old or the new file. data goes to path + ".tmp", which reaches
+// the disk before it is renamed over path, and the rename reaches the disk
+// before this returns. Returns false if any step failed, path is then left
+// as it was unless only the last flush of the directory failed.
+auto ReplaceFile(std::filesystem::path const &path, std::string_view data)
+    -> bool;
+
+// flushes the entries of directory, e.g. a rename into it, to the disk
+auto SyncDirectory(std::filesystem::path const &directory) -> bool;
+
+} // namespace dynamic_editor::utils
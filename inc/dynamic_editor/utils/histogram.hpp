@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace dynamic_editor::utils {
+
+// Duration histogram with fixed buckets doubling from 1us up to ~8s, plus
+// one for anything longer. Recording is a few relaxed atomic increments, so
+// it can stay on at any rate and be read from any thread.
+class LatencyHistogram {
+public:
+  static constexpr size_t BucketCount = 24;
+
+  void Record(std::chrono::nanoseconds duration) {
+    auto const ns =
+        static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    uint64_t const us = (ns + 999) / 1000;
+    size_t const bucket =
+        us <= 1 ? 0 : std::min<size_t>(std::bit_width(us - 1), BucketCount);
+
+    m_Buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_Count.fetch_add(1, std::memory_order_relaxed);
+    m_SumNs.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  // upper bound of a bucket in seconds, the last bucket has none
+  static constexpr auto GetUpperBound(size_t bucket) -> double {
+    return static_cast<double>(uint64_t{1} << bucket) * 1e-6;
+  }
+  [[nodiscard]] auto GetBucket(size_t bucket) const -> uint64_t {
+    return m_Buckets[bucket].load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto GetCount() const -> uint64_t {
+    return m_Count.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto GetSumSeconds() const -> double {
+    return static_cast<double>(m_SumNs.load(std::memory_order_relaxed)) *
+           1e-9;
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BucketCount + 1> m_Buckets{};
+  std::atomic<uint64_t> m_Count{0};
+  std::atomic<uint64_t> m_SumNs{0};
+};
+
+} // namespace dynamic_editor::utils
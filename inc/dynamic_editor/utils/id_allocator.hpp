@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+
+namespace dynamic_editor::utils {
+
+// Hands out unique ids for a single graph. Safe to use from any thread, so
+// nodes can be created while another thread loads into the same graph.
+class IdAllocator {
+public:
+  explicit IdAllocator(int first = 1) : m_Next(first) {}
+
+  auto Allocate() -> int {
+    return m_Next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // makes sure an id that came from elsewhere (e.g. a loaded file) is never
+  // handed out again
+  void Reserve(int id) {
+    int next = m_Next.load(std::memory_order_relaxed);
+    while (next <= id &&
+           !m_Next.compare_exchange_weak(next, id + 1,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+
+  [[nodiscard]] auto PeekNext() const -> int {
+    return m_Next.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int> m_Next;
+};
+
+} // namespace dynamic_editor::utils
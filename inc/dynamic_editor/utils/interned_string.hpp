@@ -0,0 +1,25 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace dynamic_editor::utils {
+
+// Returns a view of a copy of text that lives until the process exits. The
+// same text always yields the same view, so only the first call for it
+// allocates. Safe to call from any thread.
+auto InternString(std::string_view text) -> std::string_view;
+
+// Copies text into buffer, cut to fit, and returns a view of the copy. For
+// text that is not worth keeping forever, e.g. the message of an exception.
+template <size_t N>
+auto CopyString(std::array<char, N> &buffer, std::string_view text)
+    -> std::string_view {
+  auto const size = std::min(text.size(), N);
+  std::copy_n(text.data(), size, buffer.data());
+  return {buffer.data(), size};
+}
+
+} // namespace dynamic_editor::utils
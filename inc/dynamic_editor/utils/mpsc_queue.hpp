@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace dynamic_editor::utils {
+
+// Bounded lock-free multi-producer single-consumer ring buffer.
+// Every slot carries a sequence number so producers can claim a slot with a
+// single CAS on the tail and publish it without blocking the consumer.
+template <typename T> class MpscRingBuffer {
+public:
+  explicit MpscRingBuffer(size_t capacity)
+      : m_Capacity(RoundUpToPowerOfTwo(capacity)), m_Mask(m_Capacity - 1),
+        m_Slots(std::make_unique<Slot[]>(m_Capacity)) {
+    for (size_t i = 0; i < m_Capacity; i++) {
+      m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(MpscRingBuffer const &) = delete;
+  auto operator=(MpscRingBuffer const &) -> MpscRingBuffer & = delete;
+
+  // safe to call from any number of threads, returns false if the buffer is
+  // full
+  auto TryPush(T value) -> bool {
+    size_t pos = m_Tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = m_Slots[pos & m_Mask];
+      size_t const seq = slot.Sequence.load(std::memory_order_acquire);
+      auto const diff =
+          static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_Tail.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          slot.Value = std::move(value);
+          slot.Sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_Tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // must only be called from the single consumer thread
+  auto TryPop(T &value) -> bool {
+    size_t const head = m_Head.load(std::memory_order_relaxed);
+    Slot &slot = m_Slots[head & m_Mask];
+    size_t const seq = slot.Sequence.load(std::memory_order_acquire);
+    if (seq != head + 1) {
+      return false;
+    }
+
+    value = std::move(slot.Value);
+    slot.Sequence.store(head + m_Capacity, std::memory_order_release);
+    m_Head.store(head + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // approximate, only meant for diagnostics
+  [[nodiscard]] auto GetSizeApprox() const -> size_t {
+    size_t const tail = m_Tail.load(std::memory_order_relaxed);
+    size_t const head = m_Head.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  [[nodiscard]] auto GetCapacity() const -> size_t { return m_Capacity; }
+
+private:
+  struct Slot {
+    std::atomic<size_t> Sequence{0};
+    T Value{};
+  };
+
+  static auto RoundUpToPowerOfTwo(size_t value) -> size_t {
+    size_t result = 2;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  size_t const m_Capacity;
+  size_t const m_Mask;
+  std::unique_ptr<Slot[]> m_Slots;
+
+  alignas(64) std::atomic<size_t> m_Tail{0};
+  alignas(64) std::atomic<size_t> m_Head{0};
+};
+
+// Unbounded lock-free multi-producer single-consumer queue (Vyukov style).
+// Producers only ever do a single atomic exchange, the consumer never blocks
+// them. Every push allocates one queue node.
+template <typename T> class MpscQueue {
+public:
+  MpscQueue() : m_Head(new QueueNode()), m_Tail(m_Head.load()) {}
+  ~MpscQueue() {
+    T value;
+    while (TryPop(value)) {
+    }
+    delete m_Tail;
+  }
+
+  MpscQueue(MpscQueue const &) = delete;
+  auto operator=(MpscQueue const &) -> MpscQueue & = delete;
+
+  // safe to call from any number of threads
+  void Push(T value) {
+    auto *node = new QueueNode();
+    node->Value = std::move(value);
+    m_Size.fetch_add(1, std::memory_order_relaxed);
+    QueueNode *previous = m_Head.exchange(node, std::memory_order_acq_rel);
+    previous->Next.store(node, std::memory_order_release);
+  }
+
+  // must only be called from the single consumer thread
+  auto TryPop(T &value) -> bool {
+    QueueNode *tail = m_Tail;
+    QueueNode *next = tail->Next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+
+    value = std::move(next->Value);
+    m_Tail = next;
+    delete tail;
+    m_Size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // approximate, only meant for diagnostics
+  [[nodiscard]] auto GetSizeApprox() const -> size_t {
+    return m_Size.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct QueueNode {
+    std::atomic<QueueNode *> Next{nullptr};
+    T Value{};
+  };
+
+  alignas(64) std::atomic<QueueNode *> m_Head;
+  alignas(64) QueueNode *m_Tail;
+  std::atomic<size_t> m_Size{0};
+};
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dynamic_editor::utils {
+
+// Named POSIX shared memory segment mapped into the calling process. The
+// process that created a segment owns its name and removes it again when
+// the segment is destroyed, unless a newer segment took the name over.
+// Processes that opened it keep their mapping until they close it. Only
+// supported on POSIX systems.
+class SharedMemory {
+public:
+  // creates a segment of size zeroed bytes mapped for writing, replacing a
+  // stale segment of the same name. name has to start with a slash. Returns
+  // nullptr if the segment could not be created
+  static auto Create(std::string const &name, size_t size)
+      -> std::unique_ptr<SharedMemory>;
+  // maps an existing segment read-only, nullptr if there is none
+  static auto Open(std::string const &name) -> std::unique_ptr<SharedMemory>;
+
+  ~SharedMemory();
+
+  SharedMemory(SharedMemory const &) = delete;
+  SharedMemory &operator=(SharedMemory const &) = delete;
+
+  [[nodiscard]] auto GetData() const -> void * { return m_Data; }
+  [[nodiscard]] auto GetSize() const -> size_t { return m_Size; }
+  [[nodiscard]] auto GetName() const -> std::string const & { return m_Name; }
+  [[nodiscard]] auto IsOwner() const -> bool { return m_Owner; }
+
+private:
+  SharedMemory(std::string name, void *data, size_t size, bool owner)
+      : m_Name(std::move(name)), m_Data(data), m_Size(size), m_Owner(owner) {}
+
+  std::string m_Name;
+  void *m_Data;
+  size_t m_Size;
+  bool m_Owner;
+  // identify the segment of an owner behind its name
+  uint64_t m_Device = 0;
+  uint64_t m_Inode = 0;
+};
+
+} // namespace dynamic_editor::utils
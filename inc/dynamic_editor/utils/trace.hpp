@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace dynamic_editor::utils {
+
+// A finished span. Names are literals or interned, see InternString, so
+// recording an event never allocates.
+struct TraceEvent {
+  std::string_view Name;
+  char const *Category;
+  // nanoseconds since the process started tracing
+  uint64_t Begin;
+  uint64_t Duration;
+  // node the span belongs to, -1 for none
+  int Id;
+  uint32_t Thread;
+};
+
+// Tracing is off by default. Every thread records into a lock-free buffer
+// of its own, events are dropped when it is full until the next flush.
+void SetTracing(bool enabled);
+[[nodiscard]] auto IsTracing() -> bool;
+
+// name of the calling thread in traces
+void SetTraceThreadName(std::string_view name);
+
+// drains the events recorded so far into a Chrome trace event file, which
+// Perfetto and chrome://tracing both open. Returns false if the file could
+// not be written
+auto WriteChromeTrace(std::filesystem::path const &path) -> bool;
+// events lost to full buffers since tracing started
+[[nodiscard]] auto GetDroppedTraceEvents() -> uint64_t;
+
+// Records the time between construction and destruction as a span of the
+// calling thread, if tracing was on when the scope opened. name is kept in
+// the event, so it has to be a literal or interned. Plans intern the names
+// of their nodes when they are compiled.
+class TraceScope {
+public:
+  explicit TraceScope(std::string_view name, char const *category = "runtime",
+                      int id = -1);
+  ~TraceScope();
+
+  TraceScope(TraceScope const &) = delete;
+  TraceScope &operator=(TraceScope const &) = delete;
+
+private:
+  std::string_view m_Name;
+  char const *m_Category;
+  int m_Id;
+  bool m_Enabled;
+  uint64_t m_Begin = 0;
+};
+
+} // namespace dynamic_editor::utils
@@ -5,11 +5,14 @@
 #include <map>
 #include <memory>
 #include <optional>
-#include <thread>
+#include <set>
+#include <string>
 #include <vector>
 
 #include <dynamic_editor/nodes/link.hpp>
 #include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/views/history.hpp>
 
 #include "imnodes.h"
 #include "imnodes_internal.h"
@@ -18,6 +21,40 @@
 
 namespace dynamic_editor::views {
 
+// Ids of everything that changed since the last Editor::TakeChanges call.
+// Reset means the whole graph was replaced.
+struct GraphChanges {
+  std::set<int> Nodes;
+  std::set<int> ErasedNodes;
+  std::set<int> Links;
+  std::set<int> ErasedLinks;
+  // names of subgraph definitions created since
+  std::set<std::string> Subgraphs;
+  bool Reset = false;
+
+  void MarkNode(int id) {
+    Nodes.insert(id);
+    ErasedNodes.erase(id);
+  }
+  void EraseNode(int id) {
+    Nodes.erase(id);
+    ErasedNodes.insert(id);
+  }
+  void MarkLink(int id) {
+    Links.insert(id);
+    ErasedLinks.erase(id);
+  }
+  void EraseLink(int id) {
+    Links.erase(id);
+    ErasedLinks.insert(id);
+  }
+  void MarkSubgraph(std::string const &name) { Subgraphs.insert(name); }
+  [[nodiscard]] bool Empty() const {
+    return !Reset && Nodes.empty() && ErasedNodes.empty() && Links.empty() &&
+           ErasedLinks.empty() && Subgraphs.empty();
+  }
+};
+
 class Editor {
 public:
   Editor(std::shared_ptr<nodes::NodeHolder> &nodes) : m_Nodes(nodes) {}
@@ -27,16 +64,52 @@ public:
 
   std::shared_ptr<nodes::Node> LoadNode(const nlohmann::json &data);
   void LoadNodes(const nlohmann::json &data);
+  // applies data to the live graph by node id, only adding, removing or
+  // patching what changed so untouched nodes keep their runtime state
+  void ReconcileNodes(const nlohmann::json &data);
   nlohmann::json DumpNode(nodes::Node *node) const;
   nlohmann::json DumpNodes() const;
+  nlohmann::json DumpNodeEntry(nodes::Node *node) const;
+  nlohmann::json DumpLinkEntry(nodes::Link const &link) const;
+
+  std::vector<std::shared_ptr<nodes::Node>> const &GetNodes() const {
+    return m_Nodes->Nodes;
+  }
+  nodes::Node *FindNode(int id) const;
+  nodes::Link const *FindLink(int id) const;
+  GraphChanges TakeChanges();
+  // plan of the graph as it is right now, compiled on the calling thread
+  std::shared_ptr<runtime::ExecutionPlan> CompilePlan() const;
+  [[nodiscard]] runtime::Executor const &GetExecutor() const {
+    return m_Executor;
+  }
+  // sees the passes run from the next pass boundary on
+  void AddPassObserver(std::shared_ptr<runtime::PassObserver> observer) {
+    m_Executor.Submit(runtime::command::AddObserver{std::move(observer)});
+  }
+  void RemovePassObserver(runtime::PassObserver const *observer) {
+    m_Executor.Submit(runtime::command::RemoveObserver{observer});
+  }
+
+  void Undo();
+  void Redo();
+  History &GetHistory() { return m_History; }
 
 private:
   void DrawContextMenus();
   void DrawNode(nodes::Node &node);
+  void AddNode(std::shared_ptr<nodes::Node> node);
   void EraseNodes(const std::vector<int> &ids);
+  // replaces the nodes by a subgraph node of a new definition, links
+  // crossing the selection become its ports
+  void GroupIntoSubgraph(const std::vector<int> &ids);
+  bool CreateLink(int from, int to, int id = -1);
   void EraseLink(int id);
+  void CommitNodeEdit(int id);
+  void ApplyNodeSnapshot(int id, NodeSnapshot const &snapshot);
 
   void ProcessNodes();
+  void UpdateProcessing();
 
   std::unique_ptr<ImNodesContext, void (*)(ImNodesContext *)> m_Context = {
       [] {
@@ -50,18 +123,31 @@ private:
       ImNodes::DestroyContext};
 
   std::shared_ptr<nodes::NodeHolder> m_Nodes;
-  std::list<nodes::Node *> m_EndNodes;
   std::list<nodes::Link> m_Links;
   int m_RightClickedId = -1;
   bool m_UpdateNodePositions = false;
+  std::set<int> m_PendingNodePositions;
   ImVec2 m_RightClickedCoords;
   int m_NewDroppedNodeId = -1;
   ImVec2 m_NewDroppedNodeMousePos;
+  // reused every frame to read the selection back from imnodes
+  std::vector<int> m_SelectedNodeIds;
 
   std::optional<nodes::Node::NodeError> m_CurrNodeError;
 
-  std::thread m_thread;
+  History m_History;
+  bool m_ApplyingHistory = false;
+  GraphChanges m_Changes;
+
+  // every structural edit is mirrored to the executor, the processing thread
+  // never looks at m_Nodes or m_Links
+  runtime::Executor m_Executor;
   bool m_continuousProcessing = false;
+  bool m_fuseExpressions = false;
+  bool m_bytecodeBackend = false;
+  // id of the node ignoring Stop, -1 if none. It is drawn as overrunning
+  // without touching the node, which the processing thread still runs
+  int m_OverrunNodeId = -1;
 };
 
 } // namespace dynamic_editor::views
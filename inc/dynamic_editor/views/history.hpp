@@ -0,0 +1,91 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::views {
+
+// Immutable node state, shared between consecutive undo steps so only the
+// node that changed is ever copied.
+using NodeSnapshot = std::shared_ptr<const nlohmann::json>;
+
+namespace history {
+
+// Erased nodes are kept alive by the command instead of being serialized,
+// undoing the erase re-inserts the very same instance.
+struct AddNode {
+  std::shared_ptr<nodes::Node> Node;
+};
+struct EraseNode {
+  std::shared_ptr<nodes::Node> Node;
+};
+struct AddLink {
+  int Id, From, To;
+};
+struct EraseLink {
+  int Id, From, To;
+};
+struct ChangeProperties {
+  int NodeId;
+  NodeSnapshot Before;
+  NodeSnapshot After;
+};
+
+} // namespace history
+
+using HistoryCommand =
+    std::variant<history::AddNode, history::EraseNode, history::AddLink,
+                 history::EraseLink, history::ChangeProperties>;
+
+struct HistoryStep {
+  std::vector<HistoryCommand> Commands;
+};
+
+class History {
+public:
+  // commands recorded between BeginStep and EndStep are undone together,
+  // steps may be nested
+  void BeginStep();
+  void EndStep();
+  void Record(HistoryCommand command);
+
+  [[nodiscard]] auto CanUndo() const -> bool { return !m_UndoSteps.empty(); }
+  [[nodiscard]] auto CanRedo() const -> bool { return !m_RedoSteps.empty(); }
+
+  // the caller applies the returned step, the step moves to the other stack
+  auto PopUndo() -> HistoryStep;
+  auto PopRedo() -> HistoryStep;
+
+  void Clear();
+  void SetMaxSteps(size_t max_steps);
+  [[nodiscard]] auto GetMaxSteps() const -> size_t { return m_MaxSteps; }
+
+  // last committed state of every tracked node
+  [[nodiscard]] auto GetSnapshot(int node_id) const -> NodeSnapshot;
+  void SetSnapshot(int node_id, NodeSnapshot snapshot);
+  void EraseSnapshot(int node_id);
+
+  static auto CaptureNode(nodes::Node const &node) -> NodeSnapshot;
+  static void RestoreNode(nodes::Node &node, nlohmann::json const &state);
+
+private:
+  void PushUndo(HistoryStep step);
+
+  std::deque<HistoryStep> m_UndoSteps;
+  std::deque<HistoryStep> m_RedoSteps;
+  HistoryStep m_CurrentStep;
+  int m_StepDepth = 0;
+  size_t m_MaxSteps = 4096;
+
+  std::unordered_map<int, NodeSnapshot> m_Snapshots;
+};
+
+} // namespace dynamic_editor::views
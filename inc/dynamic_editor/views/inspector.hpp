@@ -11,6 +11,8 @@ public:
 
   void RenderWindowed(bool &show);
   void Render();
+  // lists the registered data sources as drag sources for the editor
+  void RenderDataSources();
 
   bool &GetWindowOpen() { return m_WindowOpen; }
 
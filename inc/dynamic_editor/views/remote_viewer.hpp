@@ -0,0 +1,43 @@
+#pragma once
+
+#include <dynamic_editor/runtime/snapshot.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dynamic_editor::views {
+
+// Read-only dashboard of a graph running in another process, drawn from
+// the snapshots an api::HeadlessEngine publishes to shared memory. Needs
+// none of the node types of the graph. Keeps showing the last snapshot
+// while the engine is gone and reconnects once it publishes again.
+class RemoteViewer {
+public:
+  explicit RemoteViewer(std::string name) : m_Name(std::move(name)) {}
+
+  void RenderWindowed(bool &show);
+  void Render();
+
+  [[nodiscard]] auto IsConnected() const -> bool {
+    return m_Reader != nullptr && !m_Reader->IsClosed();
+  }
+
+private:
+  // reads the latest snapshot, reopening the segment if it went away
+  void Update();
+  void RenderValue(runtime::SnapshotValue const &value);
+
+  std::string m_Name;
+  std::unique_ptr<runtime::SnapshotReader> m_Reader;
+  // swapped on every successful read, so both keep their capacity
+  runtime::Snapshot m_Snapshot;
+  runtime::Snapshot m_Scratch;
+  bool m_HasSnapshot = false;
+  std::chrono::steady_clock::time_point m_LastConnect;
+  std::chrono::steady_clock::time_point m_LastChange;
+};
+
+} // namespace dynamic_editor::views
@@ -0,0 +1,296 @@
+#include <dynamic_editor/api/autosave.hpp>
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/utils/crc32.hpp>
+#include <dynamic_editor/utils/durable_file.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace dynamic_editor::api {
+
+static constexpr char const *SnapshotFileName = "snapshot.json";
+static constexpr char const *JournalFileName = "journal.log";
+
+Autosave::Autosave(std::filesystem::path directory,
+                   std::chrono::milliseconds interval,
+                   size_t compact_after_entries)
+    : m_Directory(std::move(directory)), m_Interval(interval),
+      m_CompactAfterEntries(compact_after_entries) {
+  std::filesystem::create_directories(m_Directory);
+  MovePreviousSession();
+  m_Journal.open(m_Directory / JournalFileName,
+                 std::ios::out | std::ios::app | std::ios::binary);
+  m_Writer = std::thread([this] { WriterLoop(); });
+}
+
+Autosave::~Autosave() {
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Condition.notify_one();
+  if (m_Writer.joinable())
+    m_Writer.join();
+}
+
+void Autosave::MovePreviousSession() {
+  auto const snapshot_path = m_Directory / SnapshotFileName;
+  auto const journal_path = m_Directory / JournalFileName;
+  std::error_code error;
+  if (!std::filesystem::exists(snapshot_path, error) &&
+      !std::filesystem::exists(journal_path, error))
+    return;
+
+  // the first save compacts over both files, so they are kept until the
+  // next session starts
+  auto const previous = m_Directory / PreviousSessionDirectory;
+  std::filesystem::remove_all(previous, error);
+  std::filesystem::create_directories(previous, error);
+  for (auto const *name : {SnapshotFileName, JournalFileName}) {
+    if (std::filesystem::exists(m_Directory / name, error))
+      std::filesystem::rename(m_Directory / name, previous / name, error);
+    if (error) {
+      printf("Autosave: failed to move %s aside: %s\n", name,
+             error.message().c_str());
+      return;
+    }
+  }
+  utils::SyncDirectory(m_Directory);
+}
+
+void Autosave::Update(views::Editor &editor) {
+  auto const now = std::chrono::steady_clock::now();
+  if (now - m_LastSave < m_Interval)
+    return;
+  m_LastSave = now;
+
+  auto changes = editor.TakeChanges();
+  std::vector<nlohmann::json> entries;
+  m_NeedsReset |= changes.Reset;
+
+  if (m_NeedsReset) {
+    // a reset dumps the whole graph on the UI thread, so a graph that is
+    // loaded over and over is only dumped every few intervals. The dump
+    // covers whatever changed in between
+    if (now - m_LastReset < m_Interval * ResetIntervals)
+      return;
+    m_LastReset = now;
+    m_NeedsReset = false;
+    m_SavedPositions.clear();
+    for (auto const &node : editor.GetNodes())
+      m_SavedPositions[node->GetId()] = node->GetPosition();
+
+    entries.push_back({{"op", "reset"}, {"doc", editor.DumpNodes()}});
+  } else {
+    // node positions are not edits, so they are picked up by comparing
+    for (auto const &node : editor.GetNodes()) {
+      auto const pos = node->GetPosition();
+      auto [it, inserted] = m_SavedPositions.try_emplace(node->GetId(), pos);
+      if (inserted || it->second.x != pos.x || it->second.y != pos.y) {
+        it->second = pos;
+        changes.MarkNode(node->GetId());
+      }
+    }
+
+    for (int id : changes.ErasedNodes) {
+      m_SavedPositions.erase(id);
+      entries.push_back({{"op", "erase_node"}, {"id", id}});
+    }
+    for (int id : changes.ErasedLinks)
+      entries.push_back({{"op", "erase_link"}, {"id", id}});
+
+    for (int id : changes.Nodes) {
+      if (auto *node = editor.FindNode(id))
+        entries.push_back(
+            {{"op", "node"}, {"data", editor.DumpNodeEntry(node)}});
+    }
+    for (int id : changes.Links) {
+      if (auto const *link = editor.FindLink(id))
+        entries.push_back(
+            {{"op", "link"}, {"data", editor.DumpLinkEntry(*link)}});
+    }
+  }
+
+  // definitions go last, recovery registers them before loading any node
+  for (auto const &name : changes.Subgraphs) {
+    if (auto definition = FindSubgraph(name))
+      entries.push_back(
+          {{"op", "subgraph"}, {"name", name}, {"data", definition->Dump()}});
+  }
+
+  if (entries.empty())
+    return;
+
+  {
+    std::lock_guard lock(m_Mutex);
+    for (auto &entry : entries)
+      m_Pending.push_back(std::move(entry));
+  }
+  m_Condition.notify_one();
+}
+
+void Autosave::WriterLoop() {
+  utils::SetTraceThreadName("Autosave");
+  std::vector<nlohmann::json> batch;
+  for (;;) {
+    {
+      std::unique_lock lock(m_Mutex);
+      m_Condition.wait(lock, [this] { return m_Stop || !m_Pending.empty(); });
+      batch.swap(m_Pending);
+      if (batch.empty() && m_Stop)
+        return;
+    }
+
+    // a failed write leaves the journal unusable, the mirror still holds
+    // every entry so a snapshot of it replaces the journal
+    bool failed = false;
+    for (auto const &entry : batch) {
+      ApplyEntry(entry, m_Mirror);
+      if (entry.at("op") == "reset")
+        Compact();
+      else if (!failed)
+        failed = !WriteEntry(entry);
+    }
+    batch.clear();
+    m_Journal.flush();
+    if (!failed && !m_Journal) {
+      printf("Autosave: failed to flush the journal\n");
+      failed = true;
+    }
+
+    if (failed || m_JournalEntries >= m_CompactAfterEntries)
+      Compact();
+  }
+}
+
+bool Autosave::WriteEntry(nlohmann::json const &entry) {
+  utils::TraceScope trace("Write journal entry", "io");
+  auto const line = entry.dump();
+  char crc[16];
+  std::snprintf(crc, sizeof(crc), "%08" PRIx32 " ", utils::Crc32(line));
+
+  m_Journal << crc << line << '\n';
+  if (!m_Journal) {
+    printf("Autosave: failed to write the journal\n");
+    return false;
+  }
+  m_JournalEntries++;
+  return true;
+}
+
+void Autosave::Compact() {
+  utils::TraceScope trace("Compact journal", "io");
+  // the snapshot reaches the disk before the journal is truncated, if we
+  // crash in between its entries are simply applied a second time
+  auto const snapshot_path = m_Directory / SnapshotFileName;
+  if (!utils::ReplaceFile(snapshot_path, BuildDocument(m_Mirror).dump())) {
+    printf("Autosave: failed to replace %s\n", snapshot_path.string().c_str());
+    return;
+  }
+
+  m_Journal.close();
+  m_Journal.open(m_Directory / JournalFileName,
+                 std::ios::out | std::ios::trunc | std::ios::binary);
+  m_JournalEntries = 0;
+}
+
+void Autosave::ApplyEntry(nlohmann::json const &entry, Document &document) {
+  auto const &op = entry.at("op").get_ref<std::string const &>();
+
+  if (op == "reset") {
+    document = {};
+    auto const &doc = entry.at("doc");
+    if (doc.contains("nodes")) {
+      for (auto const &node : doc["nodes"])
+        document.Nodes[node.at("id").get<int>()] = node;
+    }
+    if (doc.contains("links")) {
+      for (auto const &link : doc["links"])
+        document.Links[link.at("id").get<int>()] = link;
+    }
+    if (doc.contains("subgraphs")) {
+      for (auto const &[name, definition] : doc["subgraphs"].items())
+        document.Subgraphs[name] = definition;
+    }
+  } else if (op == "node") {
+    auto const &data = entry.at("data");
+    document.Nodes[data.at("id").get<int>()] = data;
+  } else if (op == "erase_node") {
+    document.Nodes.erase(entry.at("id").get<int>());
+  } else if (op == "link") {
+    auto const &data = entry.at("data");
+    document.Links[data.at("id").get<int>()] = data;
+  } else if (op == "erase_link") {
+    document.Links.erase(entry.at("id").get<int>());
+  } else if (op == "subgraph") {
+    document.Subgraphs[entry.at("name").get<std::string>()] =
+        entry.at("data");
+  }
+}
+
+nlohmann::json Autosave::BuildDocument(Document const &document) {
+  nlohmann::json output;
+
+  output["nodes"] = nlohmann::json::array();
+  for (auto const &[id, node] : document.Nodes)
+    output["nodes"].push_back(node);
+
+  output["links"] = nlohmann::json::array();
+  for (auto const &[id, link] : document.Links)
+    output["links"].push_back(link);
+
+  for (auto const &[name, definition] : document.Subgraphs)
+    output["subgraphs"][name] = definition;
+
+  return output;
+}
+
+std::optional<nlohmann::json>
+Autosave::Recover(std::filesystem::path const &directory) {
+  Document document;
+  bool found = false;
+
+  try {
+    std::ifstream snapshot(directory / SnapshotFileName);
+    if (snapshot) {
+      ApplyEntry({{"op", "reset"}, {"doc", nlohmann::json::parse(snapshot)}},
+                 document);
+      found = true;
+    }
+  } catch (nlohmann::json::exception const &e) {
+    printf("Autosave: ignoring unreadable snapshot: %s\n", e.what());
+  }
+
+  std::ifstream journal(directory / JournalFileName, std::ios::binary);
+  std::string line;
+  while (std::getline(journal, line)) {
+    // "<crc32 as 8 hex digits> <json>", anything else is a torn write
+    if (line.size() < 10 || line[8] != ' ')
+      break;
+
+    auto const payload = std::string_view(line).substr(9);
+    auto const expected = std::strtoul(line.substr(0, 8).c_str(), nullptr, 16);
+    if (utils::Crc32(payload) != expected)
+      break;
+
+    try {
+      ApplyEntry(nlohmann::json::parse(payload), document);
+      found = true;
+    } catch (nlohmann::json::exception const &e) {
+      printf("Autosave: stopping replay at bad entry: %s\n", e.what());
+      break;
+    }
+  }
+
+  if (!found)
+    return std::nullopt;
+
+  return BuildDocument(document);
+}
+
+} // namespace dynamic_editor::api
@@ -0,0 +1,205 @@
+#include <dynamic_editor/api/checkpoint.hpp>
+#include <dynamic_editor/utils/binary_stream.hpp>
+#include <dynamic_editor/utils/crc32.hpp>
+#include <dynamic_editor/utils/durable_file.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace dynamic_editor::api {
+
+namespace {
+
+constexpr std::array<char, 4> CheckpointMagic{'D', 'E', 'C', 'P'};
+constexpr uint32_t CheckpointVersion = 1;
+
+} // namespace
+
+void WriteCheckpoint(runtime::ExecutionPlan const &plan, uint64_t pass,
+                     std::vector<uint8_t> &out) {
+  size_t const begin = out.size();
+  utils::BinaryWriter writer(out);
+  writer.Write(CheckpointMagic);
+  writer.Write(CheckpointVersion);
+  writer.Write(pass);
+  size_t const count_offset = out.size();
+  writer.Write(uint32_t{0});
+
+  uint32_t count = 0;
+  for (size_t i = 0; i < plan.Nodes.size(); i++) {
+    auto const &node = *plan.Nodes[i];
+    size_t const entry = out.size();
+    writer.WriteSpan(std::span<const int>(plan.NodePaths[i]));
+    writer.WriteString(node.GetName());
+    size_t const size_offset = out.size();
+    writer.Write(uint32_t{0});
+    node.SaveState(writer);
+
+    // stateless nodes are dropped again, shrinking keeps the capacity
+    auto const size =
+        static_cast<uint32_t>(out.size() - size_offset - sizeof(uint32_t));
+    if (size == 0) {
+      out.resize(entry);
+      continue;
+    }
+    std::memcpy(out.data() + size_offset, &size, sizeof(size));
+    count++;
+  }
+  std::memcpy(out.data() + count_offset, &count, sizeof(count));
+
+  writer.Write(utils::Crc32(out.data() + begin, out.size() - begin));
+}
+
+auto ReadCheckpoint(std::filesystem::path const &path)
+    -> std::optional<Checkpoint> {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file)
+    return std::nullopt;
+  std::vector<uint8_t> const data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+
+  uint32_t expected = 0;
+  size_t const body = data.size() - std::min(data.size(), sizeof(expected));
+  if (data.size() >= sizeof(expected))
+    std::memcpy(&expected, data.data() + body, sizeof(expected));
+  if (data.size() < sizeof(expected) ||
+      utils::Crc32(data.data(), body) != expected) {
+    printf("Checkpoint %s is corrupted\n", path.string().c_str());
+    return std::nullopt;
+  }
+
+  utils::BinaryReader reader(std::span<const uint8_t>(data).first(body));
+  std::array<char, 4> magic{};
+  uint32_t version = 0;
+  Checkpoint checkpoint;
+  uint32_t count = 0;
+  if (!reader.Read(magic) || magic != CheckpointMagic ||
+      !reader.Read(version) || version != CheckpointVersion ||
+      !reader.Read(checkpoint.Pass) || !reader.Read(count)) {
+    printf("%s is not a checkpoint\n", path.string().c_str());
+    return std::nullopt;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    auto &entry = checkpoint.Entries.emplace_back();
+    if (!reader.ReadVector(entry.Path) || !reader.ReadString(entry.Name) ||
+        !reader.ReadVector(entry.State)) {
+      printf("Checkpoint %s is corrupted\n", path.string().c_str());
+      return std::nullopt;
+    }
+  }
+  return checkpoint;
+}
+
+auto RestoreCheckpoint(Checkpoint const &checkpoint,
+                       runtime::ExecutionPlan const &plan) -> size_t {
+  std::map<std::vector<int>, nodes::Node *> nodes_by_path;
+  for (size_t i = 0; i < plan.Nodes.size(); i++)
+    nodes_by_path[plan.NodePaths[i]] = plan.Nodes[i].get();
+
+  size_t restored = 0;
+  for (auto const &entry : checkpoint.Entries) {
+    auto it = nodes_by_path.find(entry.Path);
+    // the graph changed since, the state belongs to a different node
+    if (it == nodes_by_path.end() || it->second->GetName() != entry.Name)
+      continue;
+
+    utils::BinaryReader reader(entry.State);
+    if (it->second->RestoreState(reader))
+      restored++;
+    else
+      printf("Checkpoint: node %d rejected its state\n", it->second->GetId());
+  }
+  return restored;
+}
+
+Checkpointer::Checkpointer(std::filesystem::path path,
+                           std::chrono::milliseconds interval, bool restore)
+    : m_Path(std::move(path)), m_Interval(interval),
+      m_LastCheckpoint(std::chrono::steady_clock::now()) {
+  if (restore)
+    m_Restore = ReadCheckpoint(m_Path);
+  m_Writer = std::thread([this] { WriterLoop(); });
+}
+
+Checkpointer::~Checkpointer() {
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Condition.notify_one();
+  if (m_Writer.joinable())
+    m_Writer.join();
+}
+
+void Checkpointer::BeforePass(runtime::ExecutionPlan const &plan) {
+  // the graph may still be on its way to the executor
+  if (!m_Restore.has_value() || plan.Nodes.empty())
+    return;
+
+  utils::TraceScope trace("Restore checkpoint");
+  RestoreCheckpoint(*m_Restore, plan);
+  m_Pass = m_Restore->Pass;
+  m_Restore.reset();
+}
+
+void Checkpointer::PassFinished(runtime::ExecutionPlan const &plan) {
+  m_Pass++;
+  auto const now = std::chrono::steady_clock::now();
+  if (now - m_LastCheckpoint < m_Interval)
+    return;
+  m_LastCheckpoint = now;
+
+  {
+    utils::TraceScope trace("Save checkpoint");
+    m_Buffer.clear();
+    WriteCheckpoint(plan, m_Pass, m_Buffer);
+  }
+
+  // a checkpoint the writer did not get to yet is replaced by this one
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Pending.swap(m_Buffer);
+    m_HasPending = true;
+  }
+  m_Condition.notify_one();
+}
+
+void Checkpointer::WriterLoop() {
+  utils::SetTraceThreadName("Checkpoint");
+  for (;;) {
+    {
+      std::unique_lock lock(m_Mutex);
+      m_Condition.wait(lock, [this] { return m_Stop || m_HasPending; });
+      if (!m_HasPending)
+        return;
+      m_Writing.swap(m_Pending);
+      m_HasPending = false;
+    }
+    Write(m_Writing);
+  }
+}
+
+void Checkpointer::Write(std::vector<uint8_t> const &data) {
+  utils::TraceScope trace("Write checkpoint", "io");
+  // the data and the rename reach the disk before the write counts, a crash
+  // leaves either the previous checkpoint or this one in place
+  auto const bytes = std::string_view(
+      reinterpret_cast<char const *>(data.data()), data.size());
+  if (!utils::ReplaceFile(m_Path, bytes)) {
+    printf("Checkpoint: failed to replace %s\n", m_Path.string().c_str());
+    return;
+  }
+  m_Written.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace dynamic_editor::api
@@ -1,9 +1,13 @@
 #include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/utils/allocation_counter.hpp>
+#include <dynamic_editor/utils/trace.hpp>
 #include <dynamic_editor/views/viewer.hpp>
 
 #include "imgui.h"
 #include "imgui_internal.h"
 
+#include <map>
+#include <mutex>
 #include <set>
 
 namespace dynamic_editor::api {
@@ -20,6 +24,94 @@ const std::vector<nodes::NodeFactory> &GetNodeFactories() {
   return impl::s_factories;
 }
 
+// replaced as a whole on registration, so the metrics server thread can
+// keep reading the list it loaded
+static DataSourceList s_data_sources =
+    std::make_shared<DataSourceList::element_type>();
+static std::mutex s_data_sources_mutex;
+
+std::shared_ptr<nodes::DataSourceChannel>
+RegisterDataSource(std::string const &name, size_t capacity) {
+  std::lock_guard lock(s_data_sources_mutex);
+  if (auto existing = FindDataSource(name))
+    return existing;
+
+  auto const current = GetDataSources();
+  // source nodes only make sense once there is something to feed them
+  if (current->empty()) {
+    RegisterNodeType<nodes::DataSourceNode>(
+        "Inputs", "Data Source",
+        "Outputs the latest sample of an external data source channel");
+  }
+
+  auto channel = std::make_shared<nodes::DataSourceChannel>(
+      static_cast<int>(current->size()) + 1, name, capacity);
+  auto next = std::make_shared<
+      std::vector<std::shared_ptr<nodes::DataSourceChannel>>>(*current);
+  next->push_back(channel);
+  std::atomic_store_explicit(&s_data_sources, DataSourceList(std::move(next)),
+                             std::memory_order_release);
+  return channel;
+}
+
+auto GetDataSources() -> DataSourceList {
+  return std::atomic_load_explicit(&s_data_sources, std::memory_order_acquire);
+}
+
+std::shared_ptr<nodes::DataSourceChannel> FindDataSource(int id) {
+  for (auto const &channel : *GetDataSources()) {
+    if (channel->GetId() == id)
+      return channel;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<nodes::DataSourceChannel>
+FindDataSource(std::string const &name) {
+  for (auto const &channel : *GetDataSources()) {
+    if (channel->GetName() == name)
+      return channel;
+  }
+  return nullptr;
+}
+
+static std::map<std::string, std::shared_ptr<const nodes::SubgraphDefinition>>
+    s_subgraphs{};
+// FindSubgraph is called from whatever thread creates or checks nodes
+static std::mutex s_subgraphs_mutex;
+
+void RegisterSubgraph(std::shared_ptr<const nodes::SubgraphDefinition> def) {
+  auto const name = def->Name;
+  {
+    std::lock_guard lock(s_subgraphs_mutex);
+    // an unchanged definition stays registered, so the nodes made from it
+    // are still current, see SubgraphNode::IsCurrent
+    if (auto it = s_subgraphs.find(name);
+        it != s_subgraphs.end() && it->second->Dump() == def->Dump())
+      return;
+
+    auto [it, inserted] = s_subgraphs.insert_or_assign(name, std::move(def));
+    if (!inserted)
+      return;
+  }
+
+  impl::RegisterNodeType(nodes::NodeFactory{
+      "Subgraphs", name, "Reusable group of nodes", [name]() {
+        auto node =
+            utils::MakeShared<nodes::SubgraphNode>(name, FindSubgraph(name));
+        node->SetName(name);
+        node->SetTitle(name);
+        return node;
+      }});
+}
+
+std::shared_ptr<const nodes::SubgraphDefinition>
+FindSubgraph(std::string const &name) {
+  std::lock_guard lock(s_subgraphs_mutex);
+  auto it = s_subgraphs.find(name);
+  return it != s_subgraphs.end() ? it->second : nullptr;
+}
+
 void DynamicEditor::RenderWindowed() {
   ImGui::SetNextWindowSize(ImVec2(1280, 720), ImGuiCond_FirstUseEver);
 
@@ -30,6 +122,9 @@ void DynamicEditor::RenderWindowed() {
 }
 
 void DynamicEditor::Render() {
+  utils::AllocationScope allocations;
+  utils::TraceScope trace("Frame", "ui");
+
   if (ImGui::BeginMenuBar()) {
     if (ImGui::BeginMenu("View")) {
       if (ImGui::MenuItem("Editor Open", "", m_show_editor)) {
@@ -43,6 +138,16 @@ void DynamicEditor::Render() {
       }
       ImGui::EndMenu();
     }
+    if (m_recorder != nullptr)
+      ImGui::TextDisabled(
+          m_recorder->IsStopped() ? "Recording ended, %llu ticks"
+                                  : "Recording, %llu ticks",
+          static_cast<unsigned long long>(m_recorder->GetTicks()));
+    if (utils::IsTracing())
+      ImGui::TextDisabled("Tracing");
+    if (utils::IsCountingAllocations())
+      ImGui::TextDisabled("%llu allocations",
+                          static_cast<unsigned long long>(m_frame_allocations));
     ImGui::EndMenuBar();
   }
   m_nodes->ResetSelectedNodes();
@@ -52,6 +157,97 @@ void DynamicEditor::Render() {
   m_viewer.RenderWindowed(m_show_viewer);
   m_editor.RenderWindowed(m_show_editor);
   m_inspector.RenderWindowed(m_show_inspector);
+
+  if (m_autosave)
+    m_autosave->Update(m_editor);
+  if (m_recorder)
+    m_recorder->Update(m_editor);
+
+  m_frame_allocations = allocations.GetCount();
+}
+
+void DynamicEditor::EnableAutosave(std::filesystem::path const &directory,
+                                   std::chrono::milliseconds interval) {
+  m_autosave.reset();
+  m_autosave = std::make_unique<Autosave>(directory, interval);
+}
+
+void DynamicEditor::EnableCheckpoints(std::filesystem::path const &path,
+                                      std::chrono::milliseconds interval,
+                                      bool restore) {
+  DisableCheckpoints();
+  m_checkpointer = std::make_shared<Checkpointer>(path, interval, restore);
+  m_editor.AddPassObserver(m_checkpointer);
+}
+
+void DynamicEditor::DisableCheckpoints() {
+  if (m_checkpointer == nullptr)
+    return;
+
+  // the executor lets go of it at its next pass boundary
+  m_editor.RemovePassObserver(m_checkpointer.get());
+  m_checkpointer.reset();
+}
+
+bool DynamicEditor::EnableMetrics(std::filesystem::path const &socket_path) {
+  m_metrics.reset();
+  m_metrics = std::make_unique<MetricsServer>(
+      socket_path, [this](std::string &out) {
+        WritePrometheusMetrics(out, m_editor.GetExecutor());
+      });
+  return m_metrics->IsListening();
+}
+
+bool DynamicEditor::EnableMetrics(uint16_t port) {
+  m_metrics.reset();
+  m_metrics = std::make_unique<MetricsServer>(port, [this](std::string &out) {
+    WritePrometheusMetrics(out, m_editor.GetExecutor());
+  });
+  return m_metrics->IsListening();
+}
+
+void DynamicEditor::StartRecording() {
+  if (m_recorder != nullptr) {
+    m_recorder->Stop();
+    m_editor.RemovePassObserver(m_recorder.get());
+  }
+
+  m_recorder = std::make_shared<Recorder>(m_editor);
+  m_editor.AddPassObserver(m_recorder);
+}
+
+bool DynamicEditor::StopRecording(std::filesystem::path const &path) {
+  if (m_recorder == nullptr)
+    return false;
+
+  // the executor lets go of the recorder at its next pass boundary, a pass
+  // still running until then is not recorded
+  auto recorder = std::move(m_recorder);
+  recorder->Stop();
+  m_editor.RemovePassObserver(recorder.get());
+  return recorder->GetTicks() > 0 && recorder->Save(path);
+}
+
+void DynamicEditor::StartTracing() {
+  utils::SetTraceThreadName("UI");
+  utils::SetTracing(true);
+}
+
+bool DynamicEditor::StopTracing(std::filesystem::path const &path) {
+  utils::SetTracing(false);
+  return utils::WriteChromeTrace(path);
+}
+
+bool DynamicEditor::RecoverAutosave(std::filesystem::path const &directory) {
+  // an autosave enabled on directory moved what it found there aside
+  auto state = Autosave::Recover(directory);
+  if (!state.has_value())
+    state = Autosave::Recover(directory / Autosave::PreviousSessionDirectory);
+  if (!state.has_value())
+    return false;
+
+  LoadState(*state);
+  return true;
 }
 
 void DynamicEditor::ConfigureDockspace() {
@@ -0,0 +1,126 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/api/headless.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace dynamic_editor::api {
+
+auto LoadGraph(nlohmann::json const &document, nodes::NodeHolder &graph,
+               runtime::Executor &executor) -> bool {
+  executor.BeginBatch();
+  try {
+    if (document.contains("subgraphs")) {
+      for (auto const &[name, definition] : document["subgraphs"].items())
+        RegisterSubgraph(nodes::SubgraphDefinition::Load(name, definition));
+    }
+
+    graph.ReserveIds(document);
+    std::map<int, std::pair<std::shared_ptr<nodes::Node>, size_t>>
+        attributes_by_id;
+    for (auto const &node_data : document.value("nodes", nlohmann::json())) {
+      auto const name = node_data.value("name", std::string());
+      // the type registered last wins, the same as when loading a graph
+      auto const &factories = GetNodeFactories();
+      auto factory = std::find_if(
+          factories.rbegin(), factories.rend(),
+          [&name](auto const &candidate) { return candidate.Name == name; });
+      if (factory == factories.rend()) {
+        printf("No node type registered for %s\n", name.c_str());
+        executor.EndBatch();
+        return false;
+      }
+
+      auto node = graph.CreateNode(*factory);
+      // anything the document does not cover gets an id of its own
+      node->SetId(node_data.contains("id") ? node_data.at("id").get<int>()
+                                           : graph.NodeIds.Allocate());
+      auto const attrs = node_data.value("attrs", nlohmann::json::array());
+      auto &attributes = node->GetAttributes();
+      for (size_t i = 0; i < attributes.size(); i++) {
+        attributes[i].SetId(i < attrs.size() ? attrs[i].get<int>()
+                                             : graph.AttributeIds.Allocate());
+        attributes_by_id[attributes[i].GetId()] = {node, i};
+      }
+      if (auto impl = node_data.find("impl");
+          impl != node_data.end() && !impl->is_null())
+        node->Load(*impl);
+
+      executor.Submit(runtime::command::AddNode{node});
+      graph.Nodes.push_back(std::move(node));
+    }
+
+    for (auto const &link_data : document.value("links", nlohmann::json())) {
+      auto from = attributes_by_id.find(link_data.value("from", -1));
+      auto to = attributes_by_id.find(link_data.value("to", -1));
+      if (from == attributes_by_id.end() || to == attributes_by_id.end())
+        continue;
+
+      // links are keyed by id, so every link needs one of its own
+      int const id = link_data.contains("id") ? link_data.at("id").get<int>()
+                                              : graph.LinkIds.Allocate();
+      executor.Submit(runtime::command::AddLink{
+          id, from->second.first, from->second.second, to->second.first,
+          to->second.second});
+    }
+  } catch (nlohmann::json::exception const &e) {
+    printf("Failed to load the graph: %s\n", e.what());
+    executor.EndBatch();
+    return false;
+  }
+  executor.EndBatch();
+  return true;
+}
+
+HeadlessEngine::~HeadlessEngine() { Stop(); }
+
+auto HeadlessEngine::Load(nlohmann::json const &document) -> bool {
+  // the nodes a run is processing go away below
+  if (Poll()) {
+    printf("The engine has to be stopped to load a graph\n");
+    return false;
+  }
+  m_Executor.Submit(runtime::command::Clear{});
+  m_Graph.Nodes.clear();
+  m_Graph.ResetArena();
+  return LoadGraph(document, m_Graph, m_Executor);
+}
+
+auto HeadlessEngine::Publish(std::string const &name,
+                             runtime::SnapshotCapacity capacity) -> bool {
+  auto publisher = runtime::SnapshotPublisher::Create(name, capacity);
+  if (publisher == nullptr)
+    return false;
+
+  m_Executor.BeginBatch();
+  if (m_Publisher != nullptr)
+    m_Executor.Submit(runtime::command::RemoveObserver{m_Publisher.get()});
+  m_Executor.Submit(runtime::command::AddObserver{publisher});
+  m_Executor.EndBatch();
+  m_Publisher = std::move(publisher);
+  return true;
+}
+
+void HeadlessEngine::EnableCheckpoints(std::filesystem::path const &path,
+                                       std::chrono::milliseconds interval,
+                                       bool restore) {
+  auto checkpointer = std::make_shared<Checkpointer>(path, interval, restore);
+  m_Executor.BeginBatch();
+  if (m_Checkpointer != nullptr)
+    m_Executor.Submit(runtime::command::RemoveObserver{m_Checkpointer.get()});
+  m_Executor.Submit(runtime::command::AddObserver{checkpointer});
+  m_Executor.EndBatch();
+  m_Checkpointer = std::move(checkpointer);
+}
+
+void HeadlessEngine::Stop() {
+  m_Executor.Stop();
+  while (m_Executor.Poll())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+} // namespace dynamic_editor::api
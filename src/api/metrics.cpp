@@ -0,0 +1,292 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/api/metrics.hpp>
+
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define IM_DYNAMIC_EDITOR_POSIX_SOCKETS
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace dynamic_editor::api {
+
+namespace {
+
+constexpr std::string_view MetricPrefix = "im_dynamic_editor_";
+
+template <typename T> void AppendNumber(std::string &out, T value) {
+  char buffer[32];
+  auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void AppendHeader(std::string &out, std::string_view name,
+                  std::string_view type, std::string_view help) {
+  out.append("# HELP ").append(MetricPrefix).append(name).append(" ");
+  out.append(help).append("\n# TYPE ").append(MetricPrefix).append(name);
+  out.append(" ").append(type).append("\n");
+}
+
+void AppendLabel(std::string &out, std::string_view name,
+                 std::string_view value) {
+  out.append(name).append("=\"");
+  for (char c : value) {
+    if (c == '\\' || c == '"')
+      out.push_back('\\');
+    if (c == '\n')
+      out.append("\\n");
+    else
+      out.push_back(c);
+  }
+  out.append("\"");
+}
+
+template <typename T>
+void AppendSample(std::string &out, std::string_view name, T value) {
+  out.append(MetricPrefix).append(name).append(" ");
+  AppendNumber(out, value);
+  out.append("\n");
+}
+
+void AppendNodeSample(std::string &out, std::string_view name,
+                      nodes::Node const &node, uint64_t value) {
+  out.append(MetricPrefix).append(name).append("{id=\"");
+  AppendNumber(out, node.GetId());
+  out.append("\",");
+  AppendLabel(out, "name", node.GetName());
+  out.append("} ");
+  AppendNumber(out, value);
+  out.append("\n");
+}
+
+void AppendChannelSample(std::string &out, std::string_view name,
+                         nodes::DataSourceChannel const &channel,
+                         uint64_t value) {
+  out.append(MetricPrefix).append(name).append("{");
+  AppendLabel(out, "channel", channel.GetName());
+  out.append("} ");
+  AppendNumber(out, value);
+  out.append("\n");
+}
+
+} // namespace
+
+void WritePrometheusMetrics(std::string &out,
+                            runtime::Executor const &executor) {
+  auto const &metrics = executor.GetMetrics();
+
+  AppendHeader(out, "passes_total", "counter", "Processing passes run.");
+  AppendSample(out, "passes_total",
+               metrics.Passes.load(std::memory_order_relaxed));
+  AppendHeader(out, "failed_passes_total", "counter",
+               "Processing passes that ended in an error.");
+  AppendSample(out, "failed_passes_total",
+               metrics.FailedPasses.load(std::memory_order_relaxed));
+
+  auto const &duration = metrics.PassDuration;
+  AppendHeader(out, "pass_duration_seconds", "histogram",
+               "Time a processing pass took.");
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i <= utils::LatencyHistogram::BucketCount; i++) {
+    cumulative += duration.GetBucket(i);
+    out.append(MetricPrefix).append("pass_duration_seconds_bucket{le=\"");
+    if (i < utils::LatencyHistogram::BucketCount)
+      AppendNumber(out, utils::LatencyHistogram::GetUpperBound(i));
+    else
+      out.append("+Inf");
+    out.append("\"} ");
+    AppendNumber(out, cumulative);
+    out.append("\n");
+  }
+  AppendSample(out, "pass_duration_seconds_sum", duration.GetSumSeconds());
+  AppendSample(out, "pass_duration_seconds_count", cumulative);
+
+  // taken off the queue first, so the depth never underflows
+  uint64_t const applied =
+      metrics.AppliedBatches.load(std::memory_order_relaxed);
+  uint64_t const submitted =
+      metrics.SubmittedBatches.load(std::memory_order_relaxed);
+  AppendHeader(out, "command_queue_depth", "gauge",
+               "Graph edits waiting for the next pass boundary.");
+  AppendSample(out, "command_queue_depth",
+               submitted > applied ? submitted - applied : 0);
+
+  if (auto const plan = executor.GetPlan()) {
+    AppendHeader(out, "node_errors_total", "counter",
+                 "Processing passes that failed on a node.");
+    for (auto const &node : plan->Nodes)
+      AppendNodeSample(out, "node_errors_total", *node,
+                       node->GetErrorCount());
+    AppendHeader(out, "node_warnings_total", "counter",
+                 "Warnings a node started showing.");
+    for (auto const &node : plan->Nodes)
+      AppendNodeSample(out, "node_warnings_total", *node,
+                       node->GetWarningCount());
+  }
+
+  auto const channels_snapshot = GetDataSources();
+  auto const &channels = *channels_snapshot;
+  if (channels.empty())
+    return;
+
+  AppendHeader(out, "data_source_pending_samples", "gauge",
+               "Samples waiting in a data source channel.");
+  for (auto const &channel : channels)
+    AppendChannelSample(out, "data_source_pending_samples", *channel,
+                        channel->GetPendingSamples());
+  AppendHeader(out, "data_source_capacity_samples", "gauge",
+               "Samples a data source channel can hold.");
+  for (auto const &channel : channels)
+    AppendChannelSample(out, "data_source_capacity_samples", *channel,
+                        channel->GetCapacity());
+  AppendHeader(out, "data_source_dropped_samples_total", "counter",
+               "Samples dropped because their channel was full.");
+  for (auto const &channel : channels)
+    AppendChannelSample(out, "data_source_dropped_samples_total", *channel,
+                        channel->GetDroppedSamples());
+}
+
+#ifdef IM_DYNAMIC_EDITOR_POSIX_SOCKETS
+
+MetricsServer::MetricsServer(std::filesystem::path path, Source source)
+    : m_Path(std::move(path)), m_Source(std::move(source)) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  auto const native = m_Path.string();
+  if (native.size() >= sizeof(address.sun_path)) {
+    printf("Metrics socket path %s is too long\n", native.c_str());
+    return;
+  }
+  native.copy(address.sun_path, native.size());
+
+  m_Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(native.c_str());
+  if (m_Socket < 0 ||
+      bind(m_Socket, reinterpret_cast<sockaddr const *>(&address),
+           sizeof(address)) != 0 ||
+      listen(m_Socket, 8) != 0) {
+    printf("Failed to listen for metrics on %s\n", native.c_str());
+    if (m_Socket >= 0)
+      ::close(m_Socket);
+    m_Socket = -1;
+    return;
+  }
+  m_Thread = std::thread([this] { Listen(); });
+}
+
+MetricsServer::MetricsServer(uint16_t port, Source source)
+    : m_Source(std::move(source)) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  m_Socket = socket(AF_INET, SOCK_STREAM, 0);
+  int const reuse = 1;
+  if (m_Socket < 0 ||
+      setsockopt(m_Socket, SOL_SOCKET, SO_REUSEADDR, &reuse,
+                 sizeof(reuse)) != 0 ||
+      bind(m_Socket, reinterpret_cast<sockaddr const *>(&address),
+           sizeof(address)) != 0 ||
+      listen(m_Socket, 8) != 0) {
+    printf("Failed to listen for metrics on port %u\n", port);
+    if (m_Socket >= 0)
+      ::close(m_Socket);
+    m_Socket = -1;
+    return;
+  }
+  m_Thread = std::thread([this] { Listen(); });
+}
+
+MetricsServer::~MetricsServer() {
+  m_Stop.store(true, std::memory_order_relaxed);
+  if (m_Thread.joinable())
+    m_Thread.join();
+  if (m_Socket < 0)
+    return;
+
+  ::close(m_Socket);
+  if (!m_Path.empty())
+    ::unlink(m_Path.string().c_str());
+}
+
+void MetricsServer::Listen() {
+  // woken up regularly to notice the server going away
+  pollfd listener{m_Socket, POLLIN, 0};
+  while (!m_Stop.load(std::memory_order_relaxed)) {
+    if (poll(&listener, 1, 100) <= 0)
+      continue;
+
+    int const connection = accept(m_Socket, nullptr, nullptr);
+    if (connection < 0)
+      continue;
+    Serve(connection);
+    ::close(connection);
+  }
+}
+
+void MetricsServer::Serve(int connection) {
+  // a client that stops reading must not hold up the server, or its
+  // destructor joining it
+  timeval const timeout{1, 0};
+  setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  // the request is not looked at, every path gets the metrics. Clients that
+  // send nothing are answered after a short wait
+  pollfd client{connection, POLLIN, 0};
+  if (poll(&client, 1, 100) > 0) {
+    char request[1024];
+    (void)recv(connection, request, sizeof(request), 0);
+  }
+
+  // built into the capacity of the previous response
+  m_Response.assign("HTTP/1.0 200 OK\r\n"
+                    "Content-Type: text/plain; version=0.0.4\r\n"
+                    "Connection: close\r\n\r\n");
+  m_Source(m_Response);
+
+#ifdef MSG_NOSIGNAL
+  int const flags = MSG_NOSIGNAL;
+#else
+  int const flags = 0;
+#endif
+  size_t sent = 0;
+  while (sent < m_Response.size()) {
+    auto const result = send(connection, m_Response.data() + sent,
+                             m_Response.size() - sent, flags);
+    if (result <= 0)
+      return;
+    sent += static_cast<size_t>(result);
+  }
+}
+
+#else
+
+MetricsServer::MetricsServer(std::filesystem::path path, Source source)
+    : m_Path(std::move(path)), m_Source(std::move(source)) {
+  printf("Metrics are only served on POSIX systems\n");
+}
+
+MetricsServer::MetricsServer(uint16_t /*port*/, Source source)
+    : m_Source(std::move(source)) {
+  printf("Metrics are only served on POSIX systems\n");
+}
+
+MetricsServer::~MetricsServer() = default;
+
+void MetricsServer::Listen() {}
+
+void MetricsServer::Serve(int /*connection*/) {}
+
+#endif
+
+} // namespace dynamic_editor::api
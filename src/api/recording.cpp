@@ -0,0 +1,545 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/api/recording.hpp>
+#include <dynamic_editor/nodes/data_source.hpp>
+#include <dynamic_editor/utils/binary_stream.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace dynamic_editor::api {
+
+namespace {
+
+constexpr std::array<char, 4> RecordingMagic{'D', 'E', 'R', 'C'};
+constexpr uint32_t RecordingVersion = 1;
+
+enum class Record : uint8_t { Samples = 1, Default, Properties, Pass };
+
+void WriteValue(utils::BinaryWriter &out,
+                nodes::Attribute::ValueType const &value) {
+  out.Write(static_cast<uint8_t>(value.index()));
+  std::visit(
+      [&out](auto const &v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int>)
+          out.Write(v);
+        else if constexpr (std::is_same_v<T, bool>)
+          out.Write(static_cast<uint8_t>(v));
+      },
+      value);
+}
+
+auto ReadValue(utils::BinaryReader &in, nodes::Attribute::ValueType &value)
+    -> bool {
+  uint8_t index = 0;
+  if (!in.Read(index))
+    return false;
+
+  switch (index) {
+  case 1: {
+    float v = 0.0F;
+    value = v;
+    return in.Read(std::get<float>(value));
+  }
+  case 2: {
+    uint8_t v = 0;
+    if (!in.Read(v))
+      return false;
+    value = v != 0;
+    return true;
+  }
+  case 3: {
+    value = 0;
+    return in.Read(std::get<int>(value));
+  }
+  default:
+    return false;
+  }
+}
+
+// FNV-1a
+void HashBytes(uint64_t &hash, void const *data, size_t size) {
+  auto const *bytes = static_cast<uint8_t const *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ULL;
+  }
+}
+
+} // namespace
+
+auto ChecksumOutputs(runtime::ExecutionPlan const &plan) -> uint64_t {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (auto const &node : plan.Nodes) {
+    for (auto &attribute : node->GetAttributes()) {
+      if (attribute.GetIo() != nodes::Attribute::IO::Out)
+        continue;
+
+      auto const &value = attribute.GetValue(plan.IsConnected(&attribute));
+      auto const index = static_cast<uint8_t>(value.index());
+      HashBytes(hash, &index, sizeof(index));
+      std::visit(
+          [&hash](auto const &v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, nodes::Attribute::Buffer>) {
+              uint64_t const size = v != nullptr ? v->size() : 0;
+              HashBytes(hash, &size, sizeof(size));
+              if (size > 0)
+                HashBytes(hash, v->data(), size * sizeof(float));
+            } else if constexpr (!std::is_same_v<T, std::monostate>) {
+              HashBytes(hash, &v, sizeof(v));
+            }
+          },
+          value);
+    }
+  }
+  return hash;
+}
+
+Recorder::Recorder(nlohmann::json document)
+    : m_Document(std::move(document)) {}
+
+Recorder::Recorder(views::Editor &editor) : Recorder(editor.DumpNodes()) {
+  // edits made before recording started are part of the document
+  for (auto const &node : editor.GetNodes()) {
+    m_SeenVersions[node->GetId()] = node->GetPropertyVersion();
+    m_SeenSnapshots[node->GetId()] =
+        editor.GetHistory().GetSnapshot(node->GetId());
+  }
+}
+
+void Recorder::Update(views::Editor &editor) {
+  if (IsStopped())
+    return;
+
+  // dragging a value bumps the property version every frame, committing
+  // an edit replaces the undo snapshot, nodes not tracking their property
+  // version are only seen by the latter
+  for (auto const &node : editor.GetNodes()) {
+    int const id = node->GetId();
+    uint64_t const version = node->GetPropertyVersion();
+    auto snapshot = editor.GetHistory().GetSnapshot(id);
+
+    auto &seen_version = m_SeenVersions[id];
+    auto &seen_snapshot = m_SeenSnapshots[id];
+    if (seen_version == version && seen_snapshot == snapshot)
+      continue;
+    seen_version = version;
+    seen_snapshot = std::move(snapshot);
+
+    nlohmann::json properties;
+    node->Dump(properties);
+
+    std::lock_guard lock(m_Mutex);
+    m_PropertyChanges.push_back({id, version, GetTicks(),
+                                 nlohmann::json::to_cbor(properties)});
+  }
+}
+
+void Recorder::Stop() {
+  std::lock_guard lock(m_Mutex);
+  m_Stopped.store(true, std::memory_order_relaxed);
+  if (m_InTick)
+    DiscardTick();
+}
+
+void Recorder::BeginRecording(runtime::ExecutionPlan const &plan) {
+  m_PlanVersion = plan.Version;
+  m_Options = plan.Options;
+  m_Start = std::chrono::steady_clock::now();
+
+  // every input is recorded in the first tick
+  auto const &plan_nodes = plan.Nodes;
+  m_NodeVersions.resize(plan_nodes.size());
+  for (uint32_t i = 0; i < plan_nodes.size(); i++) {
+    auto &node = *plan_nodes[i];
+    m_NodeVersions[i] = node.GetPropertyVersion();
+    if (dynamic_cast<nodes::DataSourceNode const *>(&node) != nullptr)
+      m_Sources.push_back(i);
+
+    auto const &attributes = node.GetAttributes();
+    for (uint32_t j = 0; j < attributes.size(); j++) {
+      if (attributes[j].GetIo() == nodes::Attribute::IO::In &&
+          attributes[j].GetType() != nodes::Attribute::Type::Buffer &&
+          plan.FindSource(&attributes[j]) == nullptr)
+        m_Inputs.emplace_back(i, j);
+    }
+  }
+  m_InputValues.resize(m_Inputs.size());
+}
+
+void Recorder::DiscardTick() {
+  m_Log.resize(m_TickBegin);
+  m_InTick = false;
+}
+
+void Recorder::PassStarted(runtime::ExecutionPlan const &plan) {
+  std::lock_guard lock(m_Mutex);
+  if (IsStopped())
+    return;
+
+  // the last pass failed or was cancelled
+  if (m_InTick)
+    DiscardTick();
+
+  if (m_PlanVersion == 0) {
+    BeginRecording(plan);
+  } else if (plan.Version != m_PlanVersion) {
+    m_Stopped.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  uint64_t const tick = GetTicks();
+  m_TickBegin = m_Log.size();
+  m_InTick = true;
+  utils::BinaryWriter log(m_Log);
+
+  auto const &plan_nodes = plan.Nodes;
+  for (uint32_t i = 0; i < plan_nodes.size(); i++) {
+    uint64_t const version = plan_nodes[i]->GetPropertyVersion();
+    if (version != m_NodeVersions[i]) {
+      m_NodeVersions[i] = version;
+      m_VersionTicks.try_emplace({plan_nodes[i]->GetId(), version}, tick);
+    }
+  }
+
+  for (uint32_t index : m_Sources) {
+    auto const &source =
+        static_cast<nodes::DataSourceNode &>(*plan_nodes[index]);
+    auto const &samples = source.GetPassSamples();
+    if (samples.empty())
+      continue;
+
+    log.Write(Record::Samples);
+    log.Write(index);
+    log.Write(static_cast<uint32_t>(samples.size()));
+    for (auto const &sample : samples) {
+      log.Write(sample.Timestamp);
+      log.Write(sample.Value);
+    }
+  }
+
+  for (size_t i = 0; i < m_Inputs.size(); i++) {
+    auto const [node, index] = m_Inputs[i];
+    auto &attribute = plan_nodes[node]->GetAttributes()[index];
+    auto const &value = plan.FindDefault(&attribute)->GetDefaultValue();
+    if (value == m_InputValues[i])
+      continue;
+
+    m_InputValues[i] = value;
+    log.Write(Record::Default);
+    log.Write(node);
+    log.Write(index);
+    WriteValue(log, value);
+  }
+}
+
+void Recorder::PassFinished(runtime::ExecutionPlan const &plan) {
+  std::lock_guard lock(m_Mutex);
+  if (!m_InTick)
+    return;
+
+  utils::BinaryWriter log(m_Log);
+  log.Write(Record::Pass);
+  log.Write(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                          m_Start)
+                .count());
+  log.Write(ChecksumOutputs(plan));
+  m_TickEnds.push_back(m_Log.size());
+  m_InTick = false;
+  m_Ticks.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto Recorder::Save(std::filesystem::path const &path) const -> bool {
+  std::lock_guard lock(m_Mutex);
+
+  std::vector<uint8_t> out;
+  utils::BinaryWriter writer(out);
+  writer.Write(RecordingMagic);
+  writer.Write(RecordingVersion);
+  writer.Write(static_cast<uint8_t>(m_Options.Fuse));
+  writer.Write(static_cast<uint8_t>(m_Options.Bytecode));
+  writer.Write(static_cast<uint32_t>(m_NodeVersions.size()));
+  auto const document = nlohmann::json::to_cbor(m_Document);
+  writer.WriteSpan(std::span<const uint8_t>(document));
+  writer.Write(static_cast<uint64_t>(m_TickEnds.size()));
+
+  // a change lands in the first tick that ran with its property version,
+  // or the tick running when it was reported if no pass observed it
+  std::multimap<uint64_t, PropertyChange const *> changes;
+  for (auto const &change : m_PropertyChanges) {
+    auto it = m_VersionTicks.find({change.NodeId, change.Version});
+    changes.emplace(it != m_VersionTicks.end() ? it->second : change.Tick,
+                    &change);
+  }
+
+  size_t begin = 0;
+  for (uint64_t tick = 0; tick < m_TickEnds.size(); tick++) {
+    auto [first, last] = changes.equal_range(tick);
+    for (auto it = first; it != last; ++it) {
+      writer.Write(Record::Properties);
+      writer.Write(it->second->NodeId);
+      writer.WriteSpan(std::span<const uint8_t>(it->second->Properties));
+    }
+
+    out.insert(out.end(), m_Log.begin() + begin,
+               m_Log.begin() + m_TickEnds[tick]);
+    begin = m_TickEnds[tick];
+  }
+
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<char const *>(out.data()),
+             static_cast<std::streamsize>(out.size()));
+  return file.good();
+}
+
+namespace {
+
+struct RecordedTick {
+  // records of the tick, up to its Pass record
+  std::span<const uint8_t> Records;
+  double Time;
+  uint64_t Checksum;
+};
+
+// Feeds the recorded ticks into the plan of the replay executor.
+class Player : public runtime::PassObserver {
+public:
+  Player(std::vector<RecordedTick> ticks, uint32_t node_count,
+         size_t capacity, std::unordered_map<int, nodes::Node *> nodes,
+         ReplayResult &result)
+      : m_Ticks(std::move(ticks)), m_NodeCount(node_count),
+        m_Capacity(std::max<size_t>(capacity, 1)), m_Nodes(std::move(nodes)),
+        m_Result(result) {
+    m_Result.Checksums.reserve(m_Ticks.size());
+  }
+
+  [[nodiscard]] auto AtEnd() const -> bool { return m_Next >= m_Ticks.size(); }
+
+  void BeforePass(runtime::ExecutionPlan const &plan) override {
+    auto const &plan_nodes = plan.Nodes;
+    if (m_Channels.empty()) {
+      if (plan_nodes.size() != m_NodeCount)
+        throw std::runtime_error("Graph does not match the recording");
+
+      // samples only ever come from the recording
+      m_Channels.resize(plan_nodes.size());
+      for (size_t i = 0; i < plan_nodes.size(); i++) {
+        auto *source =
+            dynamic_cast<nodes::DataSourceNode *>(plan_nodes[i].get());
+        if (source == nullptr)
+          continue;
+        m_Channels[i] = std::make_shared<nodes::DataSourceChannel>(
+            -1, "Replay", m_Capacity);
+        source->SetChannel(m_Channels[i]);
+      }
+    }
+
+    utils::BinaryReader reader(m_Ticks[m_Next].Records);
+    Record record{};
+    while (reader.Read(record)) {
+      uint32_t index = 0;
+      switch (record) {
+      case Record::Samples: {
+        uint32_t count = 0;
+        if (!reader.Read(index) || !reader.Read(count) ||
+            index >= m_Channels.size() || m_Channels[index] == nullptr)
+          throw std::runtime_error("Corrupted samples in the recording");
+        for (uint32_t i = 0; i < count; i++) {
+          nodes::DataSourceSample sample{};
+          reader.Read(sample.Timestamp);
+          reader.Read(sample.Value);
+          m_Channels[index]->Push(sample.Timestamp, sample.Value);
+        }
+        break;
+      }
+      case Record::Default: {
+        uint32_t attribute = 0;
+        nodes::Attribute::ValueType value;
+        if (!reader.Read(index) || !reader.Read(attribute) ||
+            !ReadValue(reader, value) || index >= plan_nodes.size() ||
+            attribute >= plan_nodes[index]->GetAttributes().size())
+          throw std::runtime_error("Corrupted input in the recording");
+        auto &input = plan_nodes[index]->GetAttributes()[attribute];
+        plan.FindDefault(&input)->SetDefaultValue(value);
+        break;
+      }
+      case Record::Properties: {
+        int id = 0;
+        std::span<const uint8_t> properties;
+        if (!reader.Read(id) || !reader.ReadBytes(properties))
+          throw std::runtime_error("Corrupted properties in the recording");
+        auto it = m_Nodes.find(id);
+        if (it != m_Nodes.end())
+          it->second->Load(nlohmann::json::from_cbor(properties));
+        break;
+      }
+      default:
+        return;
+      }
+    }
+  }
+
+  void PassFinished(runtime::ExecutionPlan const &plan) override {
+    uint64_t const checksum = ChecksumOutputs(plan);
+    m_Result.Checksums.push_back(checksum);
+    if (checksum != m_Ticks[m_Next].Checksum) {
+      m_Result.Mismatches++;
+      if (!m_Result.FirstMismatch.has_value())
+        m_Result.FirstMismatch = m_Next;
+    }
+    m_Result.RecordedSeconds = m_Ticks[m_Next].Time;
+    m_Result.Ticks++;
+    m_Next++;
+  }
+
+private:
+  std::vector<RecordedTick> m_Ticks;
+  uint32_t m_NodeCount;
+  size_t m_Capacity;
+  // top level nodes by id, property changes are reported for those
+  std::unordered_map<int, nodes::Node *> m_Nodes;
+  ReplayResult &m_Result;
+  size_t m_Next = 0;
+  std::vector<std::shared_ptr<nodes::DataSourceChannel>> m_Channels;
+};
+
+// splits the records after the header into ticks, the largest number of
+// samples a single source received in one tick is returned in capacity
+auto ReadTicks(utils::BinaryReader &reader, std::span<const uint8_t> data,
+               size_t &capacity) -> std::optional<std::vector<RecordedTick>> {
+  std::vector<RecordedTick> ticks;
+  size_t begin = reader.GetOffset();
+  Record record{};
+  while (reader.Read(record)) {
+    uint32_t index = 0;
+    uint32_t count = 0;
+    bool valid = false;
+    switch (record) {
+    case Record::Samples:
+      valid = reader.Read(index) && reader.Read(count) &&
+              reader.Skip(size_t{count} * (sizeof(double) + sizeof(float)));
+      capacity = std::max<size_t>(capacity, count);
+      break;
+    case Record::Default: {
+      nodes::Attribute::ValueType value;
+      valid = reader.Read(index) && reader.Read(count) &&
+              ReadValue(reader, value);
+      break;
+    }
+    case Record::Properties: {
+      int id = 0;
+      std::span<const uint8_t> properties;
+      valid = reader.Read(id) && reader.ReadBytes(properties);
+      break;
+    }
+    case Record::Pass: {
+      RecordedTick tick{data.subspan(begin, reader.GetOffset() - begin), 0.0,
+                        0};
+      valid = reader.Read(tick.Time) && reader.Read(tick.Checksum);
+      ticks.push_back(tick);
+      begin = reader.GetOffset();
+      break;
+    }
+    }
+    if (!valid)
+      return std::nullopt;
+  }
+
+  if (!reader.AtEnd())
+    return std::nullopt;
+  return ticks;
+}
+
+} // namespace
+
+auto ReplayRecording(std::filesystem::path const &path)
+    -> std::optional<ReplayResult> {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  std::vector<uint8_t> const data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+
+  utils::BinaryReader reader(data);
+  std::array<char, 4> magic{};
+  uint32_t version = 0;
+  uint8_t fuse = 0;
+  uint8_t bytecode = 0;
+  uint32_t node_count = 0;
+  std::span<const uint8_t> document_data;
+  uint64_t tick_count = 0;
+  if (!reader.Read(magic) || magic != RecordingMagic ||
+      !reader.Read(version) || version != RecordingVersion ||
+      !reader.Read(fuse) || !reader.Read(bytecode) ||
+      !reader.Read(node_count) || !reader.ReadBytes(document_data) ||
+      !reader.Read(tick_count)) {
+    printf("%s is not a recording\n", path.string().c_str());
+    return std::nullopt;
+  }
+
+  size_t capacity = 0;
+  auto ticks = ReadTicks(reader, data, capacity);
+  if (!ticks.has_value() || ticks->size() != tick_count) {
+    printf("Recording %s is corrupted\n", path.string().c_str());
+    return std::nullopt;
+  }
+
+  nodes::NodeHolder graph;
+  runtime::Executor executor;
+  executor.SetFusion(fuse != 0);
+  executor.SetBytecode(bytecode != 0);
+  executor.BeginBatch();
+
+  try {
+    auto const document = nlohmann::json::from_cbor(document_data);
+    if (!LoadGraph(document, graph, executor)) {
+      printf("Recording %s: failed to load the graph\n",
+             path.string().c_str());
+      return std::nullopt;
+    }
+  } catch (nlohmann::json::exception const &e) {
+    printf("Recording %s: failed to load the graph: %s\n",
+           path.string().c_str(), e.what());
+    return std::nullopt;
+  }
+
+  std::unordered_map<int, nodes::Node *> nodes_by_id;
+  for (auto const &node : graph.Nodes)
+    nodes_by_id[node->GetId()] = node.get();
+
+  ReplayResult result;
+  auto player = std::make_shared<Player>(std::move(*ticks), node_count,
+                                         capacity, std::move(nodes_by_id),
+                                         result);
+  executor.Submit(runtime::command::AddObserver{player});
+  executor.EndBatch();
+
+  auto const start = std::chrono::steady_clock::now();
+  while (!player->AtEnd()) {
+    uint64_t const ticks = result.Ticks;
+    result.Error = executor.RunOnce();
+    // an empty graph never compiles a plan, so no pass runs at all
+    if (result.Error.has_value() || result.Ticks == ticks)
+      break;
+  }
+  result.ReplaySeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  // the node belongs to the replay graph, which is gone after returning
+  if (result.Error.has_value())
+    result.Error->NodePtr = nullptr;
+  return result;
+}
+
+} // namespace dynamic_editor::api
@@ -1,38 +1,123 @@
 #include <dynamic_editor/nodes/attribute.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <set>
 #include <string>
+#include <tuple>
 #include <utility>
 
 namespace dynamic_editor::nodes {
 
-int Attribute::s_id = 1;
+namespace {
 
-Attribute::Attribute(IO io_type, Type type, std::string name)
-    : m_Id(s_id++), m_Io(io_type), m_Type(type), m_Name(std::move(name)) {
-  switch (m_Type) {
-  case Type::Boolean:
-    m_DefaultValue = false;
-    break;
-  case Type::Int:
-    m_DefaultValue = 0;
-    break;
-  case Type::Float:
-    m_DefaultValue = 0.0f;
-    break;
+auto ZeroValue(Attribute::Type type) -> Attribute::ValueType {
+  switch (type) {
+  case Attribute::Type::Boolean:
+    return false;
+  case Attribute::Type::Int:
+    return 0;
+  case Attribute::Type::Float:
+    return 0.0f;
+  case Attribute::Type::Buffer: {
+    // buffers are never written through, every port can share one
+    static Attribute::Buffer const s_empty =
+        std::make_shared<const std::vector<float>>();
+    return s_empty;
+  }
   default:
-    break;
+    return std::monostate{};
   }
 }
 
+auto PortLess(PortDescriptor const &lhs, PortDescriptor const &rhs) -> bool {
+  return std::tie(lhs.Io, lhs.Type, lhs.Name, lhs.Default) <
+         std::tie(rhs.Io, rhs.Type, rhs.Name, rhs.Default);
+}
+
+} // namespace
+
+Attribute::Attribute(Descriptor const &descriptor, allocator_type alloc)
+    : m_Descriptor(&descriptor), m_ConnectedAttributes(alloc),
+      m_DefaultValue(descriptor.Default) {
+  Publish(m_DefaultValue);
+}
+
+Attribute::Attribute(Attribute const &other, allocator_type alloc)
+    : m_Id(other.m_Id), m_Descriptor(other.m_Descriptor),
+      m_ConnectedAttributes(other.m_ConnectedAttributes, alloc),
+      m_ParentNode(other.m_ParentNode), m_DefaultValue(other.m_DefaultValue),
+      m_OutputValue(other.m_OutputValue),
+      m_PublishedScalar(
+          other.m_PublishedScalar.load(std::memory_order_relaxed)),
+      m_PublishedBuffer(std::atomic_load_explicit(&other.m_PublishedBuffer,
+                                                  std::memory_order_acquire)) {
+}
+
 Attribute::~Attribute() {
   for (auto &[linkId, attr] : this->GetConnectedAttributes()) {
     attr->RemoveConnectedAttribute(linkId);
   }
 }
 
-void Attribute::SetIdCounter(int id) {
-  if (id > s_id) {
-    s_id = id;
+auto Attribute::GetPublishedValue() const -> ValueType {
+  double const scalar = m_PublishedScalar.load(std::memory_order_relaxed);
+  switch (GetType()) {
+  case Type::Float:
+    return static_cast<float>(scalar);
+  case Type::Int:
+    return static_cast<int>(scalar);
+  case Type::Boolean:
+    return scalar != 0.0;
+  case Type::Buffer:
+    return std::atomic_load_explicit(&m_PublishedBuffer,
+                                     std::memory_order_acquire);
   }
+  return std::monostate{};
+}
+
+auto Attribute::ReadInput() -> ValueType & {
+  if (m_ConnectedAttributes.empty())
+    return m_DefaultValue;
+
+  m_ReadValue = m_ConnectedAttributes.begin()->second->GetPublishedValue();
+  return m_ReadValue;
+}
+
+void Attribute::Publish(ValueType const &value) {
+  // neither store allocates, publishing stays out of the pass allocations
+  std::visit(
+      [this](auto const &value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, Buffer>)
+          std::atomic_store_explicit(&m_PublishedBuffer, value,
+                                     std::memory_order_release);
+        else if constexpr (!std::is_same_v<T, std::monostate>)
+          m_PublishedScalar.store(static_cast<double>(value),
+                                  std::memory_order_relaxed);
+      },
+      value);
+}
+
+bool NodeTypeDescriptor::operator<(NodeTypeDescriptor const &rhs) const {
+  return std::lexicographical_compare(m_Ports.begin(), m_Ports.end(),
+                                      rhs.m_Ports.begin(), rhs.m_Ports.end(),
+                                      PortLess);
+}
+
+auto NodeTypeDescriptor::Intern(std::vector<PortDescriptor> ports)
+    -> NodeTypeDescriptor const & {
+  for (auto &port : ports) {
+    if (std::holds_alternative<std::monostate>(port.Default))
+      port.Default = ZeroValue(port.Type);
+  }
+
+  // node types are created from any thread that constructs nodes
+  static std::mutex s_mutex;
+  static std::set<NodeTypeDescriptor> s_types;
+
+  std::lock_guard lock(s_mutex);
+  return *s_types.insert(NodeTypeDescriptor(std::move(ports))).first;
 }
 
 } // namespace dynamic_editor::nodes
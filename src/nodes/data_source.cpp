@@ -0,0 +1,142 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/nodes/data_source.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include "imgui.h"
+
+namespace dynamic_editor::nodes {
+
+static auto SecondsSinceEpoch() -> double {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+DataSourceChannel::DataSourceChannel(int id, std::string name, size_t capacity)
+    : m_Id(id), m_Name(std::move(name)), m_Epoch(SecondsSinceEpoch()),
+      m_Queue(capacity) {}
+
+auto DataSourceChannel::Push(double timestamp, float value) -> bool {
+  if (m_Queue.TryPush(DataSourceSample{timestamp, value})) {
+    return true;
+  }
+
+  m_Dropped.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+auto DataSourceChannel::Push(float value) -> bool {
+  return Push(SecondsSinceEpoch() - m_Epoch, value);
+}
+
+DataSourceNode::DataSourceNode(std::string name)
+    : Node(std::move(name), GetNodeType()) {}
+
+auto DataSourceNode::GetNodeType() -> NodeTypeDescriptor const & {
+  static auto const &s_type = NodeTypeDescriptor::Intern({
+      {Attribute::IO::Out, Attribute::Type::Float, "Value"},
+      {Attribute::IO::Out, Attribute::Type::Buffer, "Samples"},
+  });
+  return s_type;
+}
+
+void DataSourceNode::SetChannel(std::shared_ptr<DataSourceChannel> channel) {
+  m_Channel = std::move(channel);
+  m_PassSamples.clear();
+  m_HasSample = false;
+
+  if (m_Channel != nullptr) {
+    m_PassSamples.reserve(m_Channel->GetCapacity());
+  }
+}
+
+void DataSourceNode::BeginPass() {
+  m_PassSamples.clear();
+  if (m_Channel == nullptr) {
+    return;
+  }
+
+  m_Channel->Drain([this](DataSourceSample const &sample) {
+    m_PassSamples.push_back(sample);
+  });
+
+  if (!m_PassSamples.empty()) {
+    m_LastSample = m_PassSamples.back();
+    m_HasSample = true;
+  }
+}
+
+void DataSourceNode::Process() {
+  if (m_Channel == nullptr) {
+    ThrowNodeError("No data source channel selected!");
+  }
+
+  SetFloatOnOutput(0, m_LastSample.Value);
+
+  // the samples of the last pass may still be read by someone else
+  float *samples = m_Samples.Resize(m_PassSamples.size());
+  for (auto const &sample : m_PassSamples)
+    *samples++ = sample.Value;
+  SetBufferOnOutput(1, m_Samples.Get());
+}
+
+void DataSourceNode::CheckForErrors() {
+  if (m_Channel == nullptr) {
+    SetError("No data source channel selected");
+  } else if (!m_HasSample) {
+    SetWarning("No samples received yet");
+  }
+}
+
+void DataSourceNode::DrawPropertiesContent() {
+  auto const channels_snapshot = api::GetDataSources();
+  auto const &channels = *channels_snapshot;
+  char const *preview =
+      m_Channel != nullptr ? m_Channel->GetName().c_str() : "None";
+
+  if (ImGui::BeginCombo("Channel", preview)) {
+    for (auto const &channel : channels) {
+      if (ImGui::Selectable(channel->GetName().c_str(),
+                            channel == m_Channel)) {
+        SetChannel(channel);
+      }
+    }
+    ImGui::EndCombo();
+  }
+
+  if (m_Channel != nullptr) {
+    ImGui::Text("Pending: %zu / %zu", m_Channel->GetPendingSamples(),
+                m_Channel->GetCapacity());
+    ImGui::Text("Dropped: %llu", static_cast<unsigned long long>(
+                                     m_Channel->GetDroppedSamples()));
+  }
+}
+
+void DataSourceNode::DrawViewerNodeContent() {
+  if (!m_HasSample) {
+    ImGui::TextDisabled("No samples");
+    return;
+  }
+
+  ImGui::Text("%.3f", m_LastSample.Value);
+  ImGui::TextDisabled("t = %.3f s", m_LastSample.Timestamp);
+}
+
+void DataSourceNode::Dump(nlohmann::json &data) const {
+  Node::Dump(data);
+  if (m_Channel != nullptr) {
+    data["channel"] = m_Channel->GetName();
+  }
+}
+
+void DataSourceNode::Load(nlohmann::json const &data) {
+  Node::Load(data);
+  if (data.contains("channel")) {
+    SetChannel(api::FindDataSource(data["channel"].get<std::string>()));
+  }
+}
+
+} // namespace dynamic_editor::nodes
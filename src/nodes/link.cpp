@@ -2,14 +2,6 @@
 
 namespace dynamic_editor::nodes {
 
-int Link::s_id = 1;
-
-Link::Link(int from, int to) : m_Id(s_id++), m_From(from), m_To(to) {}
-
-void Link::SetIdCounter(int id) {
-  if (id > s_id) {
-    s_id = id;
-  }
-}
+Link::Link(int id, int from, int to) : m_Id(id), m_From(from), m_To(to) {}
 
 } // namespace dynamic_editor::nodes
@@ -1,9 +1,11 @@
 
 #include <dynamic_editor/nodes/attribute.hpp>
 #include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/cancellation.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
 #include <dynamic_editor/utils/imgui_extras.hpp>
 
-#include <atomic>
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <imnodes.h>
@@ -13,43 +15,100 @@
 
 namespace dynamic_editor::nodes {
 
-int Node::s_Id = 1;
-static std::atomic<bool> s_interrupted;
+void NodeHolder::AssignIds(Node &node) {
+  node.SetId(NodeIds.Allocate());
+  for (auto &attribute : node.GetAttributes()) {
+    attribute.SetId(AttributeIds.Allocate());
+  }
+}
+
+void NodeHolder::ReserveIds(nlohmann::json const &document) {
+  auto const reserve = [](utils::IdAllocator &ids, nlohmann::json const &id) {
+    if (id.is_number_integer())
+      ids.Reserve(id.get<int>());
+  };
+
+  auto const nodes = document.find("nodes");
+  if (nodes != document.end() && nodes->is_array()) {
+    for (auto const &node : *nodes) {
+      if (!node.is_object())
+        continue;
+      if (auto id = node.find("id"); id != node.end())
+        reserve(NodeIds, *id);
+      if (auto attrs = node.find("attrs");
+          attrs != node.end() && attrs->is_array()) {
+        for (auto const &id : *attrs)
+          reserve(AttributeIds, id);
+      }
+    }
+  }
+
+  auto const links = document.find("links");
+  if (links != document.end() && links->is_array()) {
+    for (auto const &link : *links) {
+      if (!link.is_object())
+        continue;
+      if (auto id = link.find("id"); id != link.end())
+        reserve(LinkIds, *id);
+    }
+  }
+}
+
+static thread_local NodeHolder *t_creating = nullptr;
+
+NodeHolder::CreationScope::CreationScope(NodeHolder &graph)
+    : m_Previous(std::exchange(t_creating, &graph)) {}
+
+NodeHolder::CreationScope::~CreationScope() { t_creating = m_Previous; }
+
+auto NodeHolder::GetCreating() -> NodeHolder * { return t_creating; }
+
+auto NodeHolder::CreateNode(NodeFactory const &factory)
+    -> std::shared_ptr<Node> {
+  utils::ArenaScope scope(Arena);
+  CreationScope creating(*this);
+  return factory.Func();
+}
 
 void NodeHolder::SelectNode(const int id) {
   for (auto &node : Nodes) {
     if (node->GetId() == id) {
-      SelectedNodes.insert(node);
+      if (std::find(SelectedNodes.begin(), SelectedNodes.end(), node) ==
+          SelectedNodes.end())
+        SelectedNodes.push_back(node);
       break;
     }
   }
 }
 
-void Node::Interrupt() { s_interrupted = true; }
+auto Node::IsCancellationRequested() -> bool {
+  auto const *token = runtime::CancellationToken::GetCurrent();
+  return token != nullptr && token->IsCancelled();
+}
 
 void Node::MarkInputProcessed(size_t index) {
-  auto const &[iter, inserted] = m_ProcessedInputs.insert(index);
-  if (!inserted) {
+  if (m_ProcessedInputs.at(index)) {
     throw std::runtime_error("Node recursively processing input!");
   }
-
-  if (s_interrupted) {
-    s_interrupted = false;
-    ThrowNodeError("Execution interrupted!");
-  }
+  m_ProcessedInputs[index] = true;
 }
 
-Node::Node(std::string title, std::vector<Attribute> attributes)
-    : m_Id(s_Id++), m_Title(std::move(title)),
-      m_Attributes(std::move(attributes)) {
-  for (auto &attr : m_Attributes) {
-    attr.SetParentNode(this);
-  }
+Node::Node(std::string title, NodeTypeDescriptor const &type)
+    : m_Id(-1), m_Title(std::move(title)),
+      m_Arena(utils::Arena::GetCurrent()),
+      m_Attributes(utils::GetCurrentResource()),
+      m_ProcessedInputs(utils::GetCurrentResource()) {
+  SetNodeType(type);
 }
 
-void Node::SetIdCounter(int id) {
-  if (id > s_Id)
-    s_Id = id;
+void Node::SetNodeType(NodeTypeDescriptor const &type) {
+  m_Type = &type;
+  m_Attributes.clear();
+  m_Attributes.reserve(type.GetPorts().size());
+  for (auto const &port : type.GetPorts()) {
+    m_Attributes.emplace_back(port).SetParentNode(this);
+  }
+  m_ProcessedInputs.assign(m_Attributes.size(), false);
 }
 
 void Node::WrapDrawNode() {
@@ -65,23 +124,36 @@ void Node::WrapDrawNode() {
 }
 
 auto Node::GetValueOnInput(size_t index) -> Attribute::ValueType & {
-  auto *attribute = this->GetConnectedInputAttribute(index);
-  auto &output_data = [&]() -> Attribute::ValueType & {
-    if (attribute != nullptr) {
-      MarkInputProcessed(index);
-      attribute->GetParentNode()->Process();
-      UnmarkInputProcessed(index);
-
-      return attribute->GetOutputValue();
+  // passes run in dependency order, the source was already processed
+  if (auto const *plan = runtime::ExecutionPlan::GetActive()) {
+    auto &input = this->GetAttribute(index);
+    auto *source = plan->FindSource(&input);
+    auto &value = source != nullptr
+                      ? source->GetValue(true)
+                      : plan->FindDefault(&input)->GetValue(false);
+
+    if (std::holds_alternative<std::monostate>(value)) {
+      ThrowNodeError("Attribute not connected!");
     }
-    return this->GetAttribute(index).GetOutputValue();
-  }();
 
-  if (std::holds_alternative<std::monostate>(output_data)) {
+    return value;
+  }
+
+  // outside a pass, e.g. in CheckForErrors on the UI thread, the source is
+  // not processed again, its last published value is read instead
+  auto &value = this->GetAttribute(index).ReadInput();
+  if (std::holds_alternative<std::monostate>(value)) {
     ThrowNodeError("Attribute not connected!");
   }
 
-  return output_data;
+  return value;
+}
+
+auto Node::GetOutputSlot(Attribute &attribute) -> Attribute::ValueType & {
+  if (auto const *plan = runtime::ExecutionPlan::GetActive()) {
+    return attribute.GetValue(plan->IsConnected(&attribute));
+  }
+  return attribute.GetOutputValue();
 }
 
 void Node::SetFloatOnOutput(size_t index, float value) {
@@ -99,7 +171,7 @@ void Node::SetFloatOnOutput(size_t index, float value) {
     ThrowNodeError("Tried to set float on non-float attribute!");
   }
 
-  attribute.GetOutputValue() = value;
+  GetOutputSlot(attribute) = value;
 }
 
 void Node::SetMonostateOnOutput(size_t index) {
@@ -110,7 +182,7 @@ void Node::SetMonostateOnOutput(size_t index) {
   if (attribute.GetIo() != Attribute::IO::Out) {
     ThrowNodeError("Tried to set output data of an input attribute!");
   }
-  attribute.GetOutputValue() = std::monostate{};
+  GetOutputSlot(attribute) = std::monostate{};
 }
 
 void Node::SetBoolOnOutput(size_t index, bool value) {
@@ -128,7 +200,25 @@ void Node::SetBoolOnOutput(size_t index, bool value) {
     ThrowNodeError("Tried to set bool on non-bool attribute!");
   }
 
-  attribute.GetOutputValue() = value;
+  GetOutputSlot(attribute) = value;
+}
+
+void Node::SetBufferOnOutput(size_t index, Attribute::Buffer value) {
+  if (index >= this->GetAttributes().size()) {
+    ThrowNodeError("Attribute index out of bounds!");
+  }
+
+  auto &attribute = this->GetAttributes()[index];
+
+  if (attribute.GetIo() != Attribute::IO::Out) {
+    ThrowNodeError("Tried to set output data of an input attribute!");
+  }
+
+  if (attribute.GetType() != Attribute::Type::Buffer) {
+    ThrowNodeError("Tried to set buffer on non-buffer attribute!");
+  }
+
+  GetOutputSlot(attribute) = std::move(value);
 }
 
 } // namespace dynamic_editor::nodes
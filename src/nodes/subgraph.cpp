@@ -0,0 +1,171 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/nodes/subgraph.hpp>
+#include <dynamic_editor/utils/id_allocator.hpp>
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "imgui.h"
+
+namespace dynamic_editor::nodes {
+
+auto SubgraphDefinition::Dump() const -> nlohmann::json {
+  nlohmann::json output;
+  output["graph"] = Graph;
+
+  output["ports"] = nlohmann::json::array();
+  for (auto const &port : Ports) {
+    output["ports"].push_back({{"name", port.Name},
+                               {"node", port.NodeId},
+                               {"attr", port.AttributeIndex}});
+  }
+  return output;
+}
+
+auto SubgraphDefinition::Load(std::string name, nlohmann::json const &data)
+    -> std::shared_ptr<SubgraphDefinition> {
+  auto definition = std::make_shared<SubgraphDefinition>();
+  definition->Name = std::move(name);
+  definition->Graph = data.at("graph");
+
+  for (auto const &port : data.at("ports")) {
+    definition->Ports.push_back({port.at("name").get<std::string>(),
+                                 port.at("node").get<int>(),
+                                 port.at("attr").get<size_t>()});
+  }
+  return definition;
+}
+
+SubgraphNode::SubgraphNode(std::string name,
+                           std::shared_ptr<const SubgraphDefinition> definition)
+    : Node(std::move(name), {}), m_Definition(std::move(definition)),
+      m_Arena(utils::Arena::GetCurrent()) {
+  if (m_Definition != nullptr) {
+    Instantiate();
+  }
+}
+
+void SubgraphNode::Instantiate() {
+  // the same as NodeHolder::CreateNode does for the outer node
+  utils::ArenaScope scope(m_Arena);
+
+  // ids come from the graph the node is created for, so they are unique in
+  // it. A node made outside of any graph numbers its parts below -1 itself
+  auto *graph = NodeHolder::GetCreating();
+  utils::IdAllocator own_ids(2);
+  auto const allocate = [graph, &own_ids](utils::IdAllocator NodeHolder::*ids) {
+    return graph != nullptr ? (graph->*ids).Allocate() : -own_ids.Allocate();
+  };
+
+  // keyed by the ids of the definition, which links and ports refer to
+  std::map<int, std::shared_ptr<Node>> nodes_by_id;
+  std::map<int, PortTarget> attributes_by_id;
+
+  for (auto const &node_data : m_Definition->Graph.value("nodes",
+                                                         nlohmann::json())) {
+    std::shared_ptr<Node> node;
+    for (auto const &factory : api::GetNodeFactories()) {
+      if (factory.Name == node_data.value("name", std::string())) {
+        node = factory.Func();
+        break;
+      }
+    }
+
+    if (node == nullptr) {
+      printf("Subgraph %s: no node type registered for %s\n",
+             m_Definition->Name.c_str(), node_data.dump().c_str());
+      continue;
+    }
+
+    int id = 0;
+    try {
+      id = node_data.at("id").get<int>();
+      node->SetId(allocate(&NodeHolder::NodeIds));
+      node->SetTitle(node_data.value("title", node->GetTitle()));
+      auto const attrs = node_data.value("attrs", nlohmann::json::array());
+      auto &attributes = node->GetAttributes();
+      for (size_t i = 0; i < attributes.size(); i++) {
+        attributes[i].SetId(allocate(&NodeHolder::AttributeIds));
+        if (i < attrs.size())
+          attributes_by_id[attrs[i].get<int>()] = {node, i};
+      }
+      if (auto impl = node_data.find("impl");
+          impl != node_data.end() && !impl->is_null())
+        node->Load(*impl);
+    } catch (nlohmann::json::exception const &e) {
+      printf("Subgraph %s: failed to load node: %s\n",
+             m_Definition->Name.c_str(), e.what());
+      continue;
+    }
+
+    nodes_by_id[id] = node;
+    m_InnerNodes.push_back(std::move(node));
+    m_InnerNodeIds.push_back(id);
+  }
+
+  for (auto const &link_data : m_Definition->Graph.value("links",
+                                                         nlohmann::json())) {
+    auto from = attributes_by_id.find(link_data.value("from", -1));
+    auto to = attributes_by_id.find(link_data.value("to", -1));
+    if (from == attributes_by_id.end() || to == attributes_by_id.end())
+      continue;
+
+    int const link_id = allocate(&NodeHolder::LinkIds);
+    auto &from_attr = from->second.Node->GetAttributes()[from->second.Index];
+    auto &to_attr = to->second.Node->GetAttributes()[to->second.Index];
+    from_attr.AddConnectedAttribute(link_id, &to_attr);
+    to_attr.AddConnectedAttribute(link_id, &from_attr);
+
+    m_InnerLinks.push_back({from->second.Node, from->second.Index,
+                            to->second.Node, to->second.Index});
+  }
+
+  std::vector<PortDescriptor> ports;
+  for (auto const &port : m_Definition->Ports) {
+    auto it = nodes_by_id.find(port.NodeId);
+    if (it == nodes_by_id.end() ||
+        port.AttributeIndex >= it->second->GetAttributes().size()) {
+      printf("Subgraph %s: port %s has no target\n",
+             m_Definition->Name.c_str(), port.Name.c_str());
+      continue;
+    }
+
+    auto const &inner = it->second->GetAttributes()[port.AttributeIndex];
+    ports.push_back({inner.GetIo(), inner.GetType(), port.Name,
+                     inner.GetDefaultValue()});
+    m_Ports.push_back({it->second, port.AttributeIndex});
+  }
+  SetNodeType(NodeTypeDescriptor::Intern(std::move(ports)));
+}
+
+auto SubgraphNode::GetPortTarget(size_t index) const -> PortTarget const * {
+  return index < m_Ports.size() ? &m_Ports[index] : nullptr;
+}
+
+auto SubgraphNode::IsCurrent() const -> bool {
+  return api::FindSubgraph(GetName()) == m_Definition;
+}
+
+// the plan processes the inner nodes in its place
+void SubgraphNode::Process() {}
+
+void SubgraphNode::DrawPropertiesContent() {
+  if (m_Definition == nullptr) {
+    ImGui::TextDisabled("No definition");
+    return;
+  }
+
+  ImGui::Text("Definition: %s", m_Definition->Name.c_str());
+  ImGui::Text("Nodes: %zu", m_InnerNodes.size());
+  ImGui::Text("Links: %zu", m_InnerLinks.size());
+}
+
+void SubgraphNode::Dump(nlohmann::json &data) const {
+  Node::Dump(data);
+  if (m_Definition != nullptr) {
+    data["definition"] = m_Definition->Name;
+  }
+}
+
+} // namespace dynamic_editor::nodes
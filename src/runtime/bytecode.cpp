@@ -0,0 +1,209 @@
+#include <dynamic_editor/runtime/bytecode.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dynamic_editor::runtime {
+
+void BytecodeProgram::Run(std::span<float> r, CancellationToken const &token,
+                          std::atomic<nodes::Node *> &current) const {
+  for (auto const &instruction : Code) {
+    auto const dst = instruction.Dst;
+    auto const a = instruction.A;
+    auto const b = instruction.B;
+
+    switch (instruction.Op) {
+    case Opcode::Load:
+      r[dst] = ReadScalar(Loads[a]);
+      break;
+    case Opcode::Store:
+      WriteScalar(Stores[dst], r[a]);
+      break;
+    case Opcode::Call: {
+      // same granularity as the node by node executor
+      if (token.IsCancelled())
+        return;
+      auto *node = Calls[a];
+      current.store(node, std::memory_order_relaxed);
+      node->Reset();
+      node->ResetProcessedInputs();
+      node->Process();
+      break;
+    }
+    case Opcode::Negate:
+      r[dst] = -r[a];
+      break;
+    case Opcode::Abs:
+      r[dst] = std::fabs(r[a]);
+      break;
+    case Opcode::Add:
+      r[dst] = r[a] + r[b];
+      break;
+    case Opcode::Subtract:
+      r[dst] = r[a] - r[b];
+      break;
+    case Opcode::Multiply:
+      r[dst] = r[a] * r[b];
+      break;
+    case Opcode::Divide:
+      r[dst] = r[a] / r[b];
+      break;
+    case Opcode::Min:
+      r[dst] = std::min(r[a], r[b]);
+      break;
+    case Opcode::Max:
+      r[dst] = std::max(r[a], r[b]);
+      break;
+    case Opcode::Less:
+      r[dst] = r[a] < r[b] ? 1.0F : 0.0F;
+      break;
+    case Opcode::LessEqual:
+      r[dst] = r[a] <= r[b] ? 1.0F : 0.0F;
+      break;
+    case Opcode::Greater:
+      r[dst] = r[a] > r[b] ? 1.0F : 0.0F;
+      break;
+    case Opcode::GreaterEqual:
+      r[dst] = r[a] >= r[b] ? 1.0F : 0.0F;
+      break;
+    case Opcode::Equal:
+      r[dst] = r[a] == r[b] ? 1.0F : 0.0F;
+      break;
+    }
+  }
+}
+
+static auto ToOpcode(ExprOp op) -> Opcode {
+  switch (op) {
+  case ExprOp::Negate:
+    return Opcode::Negate;
+  case ExprOp::Abs:
+    return Opcode::Abs;
+  case ExprOp::Add:
+    return Opcode::Add;
+  case ExprOp::Subtract:
+    return Opcode::Subtract;
+  case ExprOp::Multiply:
+    return Opcode::Multiply;
+  case ExprOp::Divide:
+    return Opcode::Divide;
+  case ExprOp::Min:
+    return Opcode::Min;
+  case ExprOp::Max:
+    return Opcode::Max;
+  case ExprOp::Less:
+    return Opcode::Less;
+  case ExprOp::LessEqual:
+    return Opcode::LessEqual;
+  case ExprOp::Greater:
+    return Opcode::Greater;
+  case ExprOp::GreaterEqual:
+    return Opcode::GreaterEqual;
+  default:
+    return Opcode::Equal;
+  }
+}
+
+void CompileBytecode(ExecutionPlan &plan) {
+  auto program = std::make_unique<BytecodeProgram>();
+
+  std::unordered_set<nodes::Node *> native;
+  for (auto *node : plan.Order) {
+    if (!plan.IsConstant(node) && IsExpressible(*node))
+      native.insert(node);
+  }
+
+  // output attribute -> register holding its value for the rest of the pass
+  std::unordered_map<nodes::Attribute const *, uint32_t> registers;
+  auto allocate = [&program](float initial) {
+    program->Registers.push_back(initial);
+    return static_cast<uint32_t>(program->Registers.size() - 1);
+  };
+  auto emit = [&program](Opcode op, size_t dst, size_t a, size_t b) {
+    program->Code.push_back({op, static_cast<uint32_t>(dst),
+                             static_cast<uint32_t>(a),
+                             static_cast<uint32_t>(b)});
+  };
+
+  // constants are read like the outputs of calls
+  for (auto *node : plan.Order) {
+    if (plan.IsConstant(node))
+      continue;
+
+    if (!native.contains(node)) {
+      program->Calls.push_back(node);
+      emit(Opcode::Call, 0, program->Calls.size() - 1, 0);
+      continue;
+    }
+
+    auto &attributes = node->GetAttributes();
+    for (size_t i = 0; i < attributes.size(); i++) {
+      if (attributes[i].GetIo() != nodes::Attribute::IO::Out)
+        continue;
+
+      ExpressionBuilder builder;
+      auto const root = static_cast<size_t>(
+          node->DescribeExpression(i, builder).value_or(0));
+      auto const &terms = builder.GetTerms();
+
+      // operands always come before the terms using them
+      std::vector<uint32_t> term_registers(terms.size());
+      for (size_t t = 0; t <= root; t++) {
+        auto const &term = terms[t];
+        switch (term.Op) {
+        case ExprOp::Input: {
+          auto &input = attributes[term.Input];
+          auto *source = plan.FindSource(&input);
+          if (source != nullptr) {
+            if (auto it = registers.find(source); it != registers.end()) {
+              term_registers[t] = it->second;
+              break;
+            }
+          }
+
+          // outputs of calls are loaded once, they do not change afterwards
+          term_registers[t] = allocate(0.0F);
+          if (source != nullptr) {
+            program->Loads.push_back({source, true, node});
+            registers[source] = term_registers[t];
+          } else {
+            program->Loads.push_back({plan.FindDefault(&input), false, node});
+          }
+          emit(Opcode::Load, term_registers[t], program->Loads.size() - 1, 0);
+          break;
+        }
+        case ExprOp::Constant:
+          term_registers[t] = allocate(term.Value);
+          break;
+        case ExprOp::Negate:
+        case ExprOp::Abs:
+          term_registers[t] = allocate(0.0F);
+          emit(ToOpcode(term.Op), term_registers[t], term_registers[term.Lhs],
+               0);
+          break;
+        default:
+          term_registers[t] = allocate(0.0F);
+          emit(ToOpcode(term.Op), term_registers[t], term_registers[term.Lhs],
+               term_registers[term.Rhs]);
+          break;
+        }
+      }
+
+      // stored even when only native nodes read it, the executor publishes
+      // every output after the pass
+      registers[&attributes[i]] = term_registers[root];
+      program->Stores.push_back(
+          {&attributes[i], plan.IsConnected(&attributes[i]), node});
+      emit(Opcode::Store, program->Stores.size() - 1, term_registers[root], 0);
+    }
+
+    plan.ExpressionVersions.emplace_back(node, node->GetPropertyVersion());
+  }
+
+  plan.Program = std::move(program);
+}
+
+} // namespace dynamic_editor::runtime
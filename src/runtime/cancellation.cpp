@@ -0,0 +1,18 @@
+#include <dynamic_editor/runtime/cancellation.hpp>
+
+namespace dynamic_editor::runtime {
+
+static thread_local CancellationToken const *s_current_token = nullptr;
+
+auto CancellationToken::GetCurrent() -> CancellationToken const * {
+  return s_current_token;
+}
+
+CancellationScope::CancellationScope(CancellationToken const &token)
+    : m_Previous(s_current_token) {
+  s_current_token = &token;
+}
+
+CancellationScope::~CancellationScope() { s_current_token = m_Previous; }
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,338 @@
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/utils/allocation_counter.hpp>
+#include <dynamic_editor/utils/interned_string.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace dynamic_editor::runtime {
+
+Executor::~Executor() {
+  Stop();
+  if (m_Thread.joinable())
+    m_Thread.join();
+}
+
+void Executor::Submit(GraphCommand command) {
+  // a thread only ever reads its own id here, so the batch state is never
+  // touched by anyone but the thread that opened the batch
+  if (m_BatchThread.load(std::memory_order_relaxed) ==
+      std::this_thread::get_id()) {
+    m_Batch.push_back(std::move(command));
+    return;
+  }
+
+  std::vector<GraphCommand> commands;
+  commands.push_back(std::move(command));
+  m_Metrics.SubmittedBatches.fetch_add(1, std::memory_order_relaxed);
+  m_Commands.Push(std::move(commands));
+}
+
+void Executor::BeginBatch() {
+  if (m_BatchDepth++ == 0)
+    m_BatchThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+}
+
+void Executor::EndBatch() {
+  if (m_BatchDepth == 0 || --m_BatchDepth > 0)
+    return;
+
+  m_BatchThread.store(std::thread::id(), std::memory_order_relaxed);
+
+  if (!m_Batch.empty()) {
+    m_Metrics.SubmittedBatches.fetch_add(1, std::memory_order_relaxed);
+    m_Commands.Push(std::move(m_Batch));
+  }
+  m_Batch = {};
+}
+
+auto Executor::GetPlan() const -> std::shared_ptr<const ExecutionPlan> {
+  return std::atomic_load_explicit(&m_Plan, std::memory_order_acquire);
+}
+
+auto Executor::ApplyCommands() -> bool {
+  utils::TraceScope trace("Apply commands");
+  bool changed = false;
+  std::vector<GraphCommand> commands;
+  while (m_Commands.TryPop(commands)) {
+    m_Metrics.AppliedBatches.fetch_add(1, std::memory_order_relaxed);
+    for (auto &command : commands)
+      changed |= Apply(command);
+  }
+  return changed;
+}
+
+auto Executor::Apply(GraphCommand &command) -> bool {
+  return std::visit(
+      [this](auto &command) {
+        using T = std::decay_t<decltype(command)>;
+        if constexpr (std::is_same_v<T, command::AddObserver>) {
+          m_Observers.push_back(std::move(command.Observer));
+          return false;
+        } else if constexpr (std::is_same_v<T, command::RemoveObserver>) {
+          std::erase_if(m_Observers, [&command](auto const &observer) {
+            return observer.get() == command.Observer;
+          });
+          return false;
+        }
+
+        if constexpr (std::is_same_v<T, command::AddNode>) {
+          int const id = command.Node->GetId();
+          m_GraphNodes[id] = std::move(command.Node);
+        } else if constexpr (std::is_same_v<T, command::EraseNode>) {
+          m_GraphNodes.erase(command.Id);
+        } else if constexpr (std::is_same_v<T, command::AddLink>) {
+          m_GraphLinks[command.Id] = {std::move(command.FromNode),
+                                      command.FromIndex,
+                                      std::move(command.ToNode),
+                                      command.ToIndex};
+        } else if constexpr (std::is_same_v<T, command::EraseLink>) {
+          m_GraphLinks.erase(command.Id);
+        } else if constexpr (std::is_same_v<T, command::Clear>) {
+          m_GraphNodes.clear();
+          m_GraphLinks.clear();
+        }
+        return true;
+      },
+      command);
+}
+
+void Executor::Compile(PlanOptions options) {
+  utils::TraceScope trace("Compile");
+  std::vector<std::shared_ptr<nodes::Node>> nodes;
+  nodes.reserve(m_GraphNodes.size());
+  for (auto const &[id, node] : m_GraphNodes)
+    nodes.push_back(node);
+
+  std::vector<PlanLink> links;
+  links.reserve(m_GraphLinks.size());
+  for (auto const &[id, link] : m_GraphLinks)
+    links.push_back(link);
+
+  m_Options = options;
+  auto plan = CompilePlan(std::move(nodes), links, options);
+  plan->Version = ++m_Version;
+  for (auto const &node : plan->Nodes)
+    node->BindPlan(*plan);
+
+  std::atomic_store_explicit(
+      &m_Plan, std::shared_ptr<const ExecutionPlan>(std::move(plan)),
+      std::memory_order_release);
+}
+
+void Executor::Start(bool continuous) {
+  if (Poll())
+    return;
+
+  SetContinuous(continuous);
+  m_Token = std::make_shared<CancellationToken>();
+  m_StopRequested.reset();
+  m_Finished.store(false, std::memory_order_relaxed);
+  m_Thread = std::thread([this, token = m_Token] { RunLoop(*token); });
+}
+
+void Executor::Stop() {
+  if (m_Token == nullptr || m_StopRequested.has_value())
+    return;
+
+  m_Token->Cancel();
+  m_StopRequested = std::chrono::steady_clock::now();
+}
+
+auto Executor::Poll() -> bool {
+  if (!m_Thread.joinable())
+    return false;
+  if (!m_Finished.load(std::memory_order_acquire))
+    return true;
+
+  m_Thread.join();
+  m_Token.reset();
+  m_StopRequested.reset();
+  return false;
+}
+
+auto Executor::TakeError() -> std::optional<nodes::Node::NodeError> {
+  std::lock_guard lock(m_ErrorMutex);
+  return std::exchange(m_Error, std::nullopt);
+}
+
+auto Executor::GetOverrunNode() const -> nodes::Node * {
+  if (!m_StopRequested.has_value() ||
+      std::chrono::steady_clock::now() - *m_StopRequested <
+          m_CancelLatencyBound)
+    return nullptr;
+
+  return m_CurrentNode.load(std::memory_order_relaxed);
+}
+
+auto Executor::RunOnce() -> std::optional<nodes::Node::NodeError> {
+  CancellationToken token;
+  CancellationScope scope(token);
+  utils::AllocationScope allocations;
+  auto error = RunMeasuredPass(token);
+  m_PassAllocations.store(allocations.GetCount(), std::memory_order_relaxed);
+  m_CurrentNode.store(nullptr, std::memory_order_relaxed);
+  return error;
+}
+
+void Executor::RunLoop(CancellationToken const &token) {
+  CancellationScope scope(token);
+  utils::SetTraceThreadName("Processing");
+
+  do {
+    utils::AllocationScope allocations;
+    auto error = RunMeasuredPass(token);
+    m_PassAllocations.store(allocations.GetCount(), std::memory_order_relaxed);
+
+    if (error.has_value()) {
+      std::lock_guard lock(m_ErrorMutex);
+      m_Error = std::move(error);
+      break;
+    }
+  } while (m_Continuous.load(std::memory_order_relaxed) &&
+           !token.IsCancelled());
+
+  m_CurrentNode.store(nullptr, std::memory_order_relaxed);
+  m_Finished.store(true, std::memory_order_release);
+}
+
+auto Executor::RunMeasuredPass(CancellationToken const &token)
+    -> std::optional<nodes::Node::NodeError> {
+  auto const begin = std::chrono::steady_clock::now();
+  auto error = RunPass(token);
+  m_Metrics.PassDuration.Record(std::chrono::steady_clock::now() - begin);
+  m_Metrics.Passes.fetch_add(1, std::memory_order_relaxed);
+  if (error.has_value()) {
+    m_Metrics.FailedPasses.fetch_add(1, std::memory_order_relaxed);
+    if (error->NodePtr != nullptr)
+      error->NodePtr->CountError();
+  }
+  return error;
+}
+
+auto Executor::ConstantsChanged(ExecutionPlan const &plan) const -> bool {
+  if (plan.Version != m_FoldedVersion)
+    return true;
+
+  for (size_t i = 0; i < plan.ConstantInputs.size(); i++) {
+    if (plan.ConstantInputs[i]->GetValue(false) != m_FoldedInputs[i])
+      return true;
+  }
+  for (size_t i = 0; i < plan.Constants.size(); i++) {
+    if (plan.Constants[i]->GetPropertyVersion() != m_FoldedProperties[i])
+      return true;
+  }
+  return false;
+}
+
+void Executor::FoldConstants(ExecutionPlan const &plan) {
+  // taken first, so edits made while processing are picked up next pass
+  m_FoldedInputs.clear();
+  for (auto *input : plan.ConstantInputs)
+    m_FoldedInputs.push_back(input->GetValue(false));
+  m_FoldedProperties.clear();
+  for (auto *node : plan.Constants)
+    m_FoldedProperties.push_back(node->GetPropertyVersion());
+
+  // retried next pass if a node throws
+  m_FoldedVersion = 0;
+  utils::TraceScope trace("Fold constants");
+  for (auto *node : plan.Constants) {
+    m_CurrentNode.store(node, std::memory_order_relaxed);
+    node->Reset();
+    node->ResetProcessedInputs();
+    node->Process();
+  }
+  m_FoldedVersion = plan.Version;
+}
+
+auto Executor::RunPass(CancellationToken const &token)
+    -> std::optional<nodes::Node::NodeError> {
+  utils::TraceScope trace("Pass");
+  PlanOptions const options{m_Fuse.load(std::memory_order_relaxed),
+                            m_Bytecode.load(std::memory_order_relaxed)};
+  if (ApplyCommands() || options != m_Options ||
+      (m_Plan != nullptr && m_Plan->HasStaleExpressions()))
+    Compile(options);
+
+  // only this thread ever stores the plan, so no atomic load is needed here
+  auto const plan = m_Plan;
+  if (plan == nullptr)
+    return std::nullopt;
+  if (plan->Error.has_value())
+    return plan->Error;
+
+  ActivePlanScope scope(*plan);
+  // commands were applied above, so the observers stay put for the pass
+  try {
+    for (auto const &observer : m_Observers)
+      observer->BeforePass(*plan);
+    {
+      utils::TraceScope begin_trace("Begin pass");
+      for (auto const &node : plan->Nodes)
+        node->BeginPass();
+    }
+    for (auto const &observer : m_Observers)
+      observer->PassStarted(*plan);
+
+    if (!plan->Constants.empty() && ConstantsChanged(*plan))
+      FoldConstants(*plan);
+
+    if (plan->Program != nullptr) {
+      utils::TraceScope program_trace("Bytecode");
+      auto const &program = *plan->Program;
+      m_Registers.assign(program.Registers.begin(), program.Registers.end());
+      program.Run(m_Registers, token, m_CurrentNode);
+    } else {
+      RunSteps(*plan, token);
+    }
+
+    if (!token.IsCancelled()) {
+      for (auto const &[output, connected] : plan->Outputs)
+        output->PublishValue(connected);
+      for (auto const &[port, inner] : plan->PortOutputs)
+        port->PublishValue(*inner, plan->IsConnected(inner));
+      for (auto const &observer : m_Observers)
+        observer->PassFinished(*plan);
+    }
+  } catch (nodes::Node::NodeError const &error) {
+    if (!token.IsCancelled())
+      return error;
+  } catch (std::exception const &e) {
+    if (!token.IsCancelled())
+      return nodes::Node::NodeError{
+          m_CurrentNode.load(std::memory_order_relaxed),
+          utils::CopyString(m_ExceptionMessage, e.what())};
+  }
+
+  return std::nullopt;
+}
+
+void Executor::RunSteps(ExecutionPlan const &plan,
+                        CancellationToken const &token) {
+  // cancellation is observed between nodes, so the latency is bounded by
+  // the slowest single node unless that node polls the token itself
+  for (auto const &step : plan.Steps) {
+    if (token.IsCancelled())
+      break;
+
+    auto *node = step.Node;
+    m_CurrentNode.store(node, std::memory_order_relaxed);
+    if (step.Kernel != nullptr) {
+      utils::TraceScope trace("Fused kernel", "node", node->GetId());
+      step.Kernel->Run();
+      continue;
+    }
+
+    utils::TraceScope trace(step.Name, "node", node->GetId());
+    node->Reset();
+    node->ResetProcessedInputs();
+    node->Process();
+  }
+}
+
+} // namespace dynamic_editor::runtime
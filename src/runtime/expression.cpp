@@ -0,0 +1,294 @@
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/expression.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dynamic_editor::runtime {
+
+auto ExpressionBuilder::Input(size_t index) -> Ref {
+  m_Terms.push_back({ExprOp::Input, -1, -1, 0.0F, index});
+  return static_cast<Ref>(m_Terms.size()) - 1;
+}
+
+auto ExpressionBuilder::Constant(float value) -> Ref {
+  m_Terms.push_back({ExprOp::Constant, -1, -1, value, 0});
+  return static_cast<Ref>(m_Terms.size()) - 1;
+}
+
+auto ExpressionBuilder::Unary(ExprOp op, Ref operand) -> Ref {
+  m_Terms.push_back({op, operand, -1, 0.0F, 0});
+  return static_cast<Ref>(m_Terms.size()) - 1;
+}
+
+auto ExpressionBuilder::Binary(ExprOp op, Ref lhs, Ref rhs) -> Ref {
+  m_Terms.push_back({op, lhs, rhs, 0.0F, 0});
+  return static_cast<Ref>(m_Terms.size()) - 1;
+}
+
+static auto IsUnary(ExprOp op) -> bool {
+  return op == ExprOp::Negate || op == ExprOp::Abs;
+}
+
+static auto Evaluate(ExprOp op, float lhs, float rhs) -> float {
+  switch (op) {
+  case ExprOp::Negate:
+    return -lhs;
+  case ExprOp::Abs:
+    return std::fabs(lhs);
+  case ExprOp::Add:
+    return lhs + rhs;
+  case ExprOp::Subtract:
+    return lhs - rhs;
+  case ExprOp::Multiply:
+    return lhs * rhs;
+  case ExprOp::Divide:
+    return lhs / rhs;
+  case ExprOp::Min:
+    return std::min(lhs, rhs);
+  case ExprOp::Max:
+    return std::max(lhs, rhs);
+  case ExprOp::Less:
+    return lhs < rhs ? 1.0F : 0.0F;
+  case ExprOp::LessEqual:
+    return lhs <= rhs ? 1.0F : 0.0F;
+  case ExprOp::Greater:
+    return lhs > rhs ? 1.0F : 0.0F;
+  case ExprOp::GreaterEqual:
+    return lhs >= rhs ? 1.0F : 0.0F;
+  case ExprOp::Equal:
+    return lhs == rhs ? 1.0F : 0.0F;
+  default:
+    return 0.0F;
+  }
+}
+
+void FusedKernel::Run() const {
+  float stack[MaxStack];
+  size_t top = 0;
+  size_t pc = 0;
+
+  for (auto const &store : Stores) {
+    for (; pc < store.End; pc++) {
+      auto const &instruction = Code[pc];
+      switch (instruction.Op) {
+      case ExprOp::Input:
+        stack[top++] = ReadScalar(Loads[instruction.Operand]);
+        break;
+      case ExprOp::Constant:
+        stack[top++] = Constants[instruction.Operand];
+        break;
+      case ExprOp::Negate:
+      case ExprOp::Abs:
+        stack[top - 1] = Evaluate(instruction.Op, stack[top - 1], 0.0F);
+        break;
+      default:
+        top--;
+        stack[top - 1] = Evaluate(instruction.Op, stack[top - 1], stack[top]);
+        break;
+      }
+    }
+
+    WriteScalar(store.Slot, stack[--top]);
+  }
+}
+
+auto IsExpressible(nodes::Node const &node) -> bool {
+  bool has_output = false;
+  auto const &attributes = node.GetAttributes();
+  for (size_t i = 0; i < attributes.size(); i++) {
+    auto const type = attributes[i].GetType();
+    if (type != nodes::Attribute::Type::Float &&
+        type != nodes::Attribute::Type::Boolean)
+      return false;
+    if (attributes[i].GetIo() != nodes::Attribute::IO::Out)
+      continue;
+
+    has_output = true;
+    ExpressionBuilder builder;
+    auto root = node.DescribeExpression(i, builder);
+    auto const &terms = builder.GetTerms();
+    if (!root.has_value() || *root < 0 ||
+        static_cast<size_t>(*root) >= terms.size())
+      return false;
+
+    for (size_t t = 0; t < terms.size(); t++) {
+      auto const &term = terms[t];
+      auto const ref = static_cast<ExpressionBuilder::Ref>(t);
+      if (term.Op == ExprOp::Input) {
+        if (term.Input >= attributes.size() ||
+            attributes[term.Input].GetIo() != nodes::Attribute::IO::In)
+          return false;
+      } else if (term.Op != ExprOp::Constant) {
+        // operands are built before the terms using them
+        if (term.Lhs < 0 || term.Lhs >= ref)
+          return false;
+        if (!IsUnary(term.Op) && (term.Rhs < 0 || term.Rhs >= ref))
+          return false;
+      }
+    }
+  }
+  return has_output;
+}
+
+namespace {
+
+// emits the postfix code of one kernel, following links into inlined nodes
+class KernelEmitter {
+public:
+  KernelEmitter(ExecutionPlan &plan,
+                std::unordered_set<nodes::Node *> const &inlined,
+                FusedKernel &kernel)
+      : m_Plan(plan), m_Inlined(inlined), m_Kernel(kernel) {}
+
+  // every output is stored, the executor publishes all of them
+  void EmitNode(nodes::Node *node) {
+    auto &attributes = node->GetAttributes();
+    for (size_t i = 0; i < attributes.size(); i++) {
+      if (attributes[i].GetIo() == nodes::Attribute::IO::Out)
+        EmitOutput(node, i);
+    }
+  }
+
+  [[nodiscard]] auto Overflowed() const -> bool {
+    return m_MaxDepth > FusedKernel::MaxStack;
+  }
+
+private:
+  // computes an output of the node and stores it into its attribute
+  void EmitOutput(nodes::Node *node, size_t output) {
+    ExpressionBuilder builder;
+    auto root = node->DescribeExpression(output, builder);
+    EmitTerm(node, builder.GetTerms(), *root);
+
+    auto &attribute = node->GetAttributes()[output];
+    m_Kernel.Stores.push_back(
+        {{&attribute, m_Plan.IsConnected(&attribute), node},
+         m_Kernel.Code.size()});
+    m_Depth--;
+
+    auto &nodes = m_Kernel.Nodes;
+    if (std::find(nodes.begin(), nodes.end(), node) == nodes.end())
+      nodes.push_back(node);
+  }
+
+  void EmitTerm(nodes::Node *node,
+                std::vector<ExpressionBuilder::Term> const &terms,
+                ExpressionBuilder::Ref ref) {
+    auto const &term = terms[ref];
+    switch (term.Op) {
+    case ExprOp::Input: {
+      auto &input = node->GetAttributes()[term.Input];
+      auto *source = m_Plan.FindSource(&input);
+      // an inlined node is computed the first time it is read, every read
+      // loads its output back from the attribute
+      if (source != nullptr && m_Inlined.contains(source->GetParentNode()) &&
+          m_Emitted.insert(source->GetParentNode()).second)
+        EmitNode(source->GetParentNode());
+
+      if (source != nullptr)
+        m_Kernel.Loads.push_back({source, true, node});
+      else
+        m_Kernel.Loads.push_back({m_Plan.FindDefault(&input), false, node});
+      Push(ExprOp::Input, m_Kernel.Loads.size() - 1);
+      return;
+    }
+    case ExprOp::Constant:
+      m_Kernel.Constants.push_back(term.Value);
+      Push(ExprOp::Constant, m_Kernel.Constants.size() - 1);
+      return;
+    default:
+      EmitTerm(node, terms, term.Lhs);
+      if (IsUnary(term.Op)) {
+        m_Kernel.Code.push_back({term.Op, 0});
+        return;
+      }
+      EmitTerm(node, terms, term.Rhs);
+      m_Kernel.Code.push_back({term.Op, 0});
+      m_Depth--;
+      return;
+    }
+  }
+
+  void Push(ExprOp op, size_t operand) {
+    m_Kernel.Code.push_back({op, static_cast<uint32_t>(operand)});
+    m_MaxDepth = std::max(m_MaxDepth, ++m_Depth);
+  }
+
+  ExecutionPlan &m_Plan;
+  std::unordered_set<nodes::Node *> const &m_Inlined;
+  FusedKernel &m_Kernel;
+  std::unordered_set<nodes::Node *> m_Emitted;
+  size_t m_Depth = 0;
+  size_t m_MaxDepth = 0;
+};
+
+} // namespace
+
+void FuseExpressions(ExecutionPlan &plan) {
+  std::unordered_set<nodes::Node *> fusible;
+  for (auto *node : plan.Order) {
+    if (!plan.IsConstant(node) && IsExpressible(*node))
+      fusible.insert(node);
+  }
+  if (fusible.empty())
+    return;
+
+  // one entry per link
+  std::unordered_map<nodes::Node *, std::vector<nodes::Node *>> consumers;
+  for (auto const &[input, output] : plan.Sources)
+    consumers[output->GetParentNode()].push_back(input->GetParentNode());
+
+  // nodes whose value is needed in more than one place stay the root of
+  // their own group, everything else is computed where it is used
+  std::unordered_set<nodes::Node *> inlined;
+  for (auto *node : fusible) {
+    auto it = consumers.find(node);
+    if (it != consumers.end() && it->second.size() == 1 &&
+        fusible.contains(it->second.front()))
+      inlined.insert(node);
+  }
+
+  std::unordered_map<nodes::Node *, FusedKernel const *> roots;
+  std::unordered_set<nodes::Node *> fused;
+  for (auto *node : plan.Order) {
+    if (!fusible.contains(node) || inlined.contains(node))
+      continue;
+
+    auto kernel = std::make_unique<FusedKernel>();
+    KernelEmitter emitter(plan, inlined, *kernel);
+    emitter.EmitNode(node);
+
+    // the nodes of a group that is too deep are processed one by one
+    if (emitter.Overflowed())
+      continue;
+
+    for (auto *fused_node : kernel->Nodes) {
+      plan.ExpressionVersions.emplace_back(fused_node,
+                                           fused_node->GetPropertyVersion());
+    }
+
+    fused.insert(kernel->Nodes.begin(), kernel->Nodes.end());
+    roots[node] = kernel.get();
+    plan.Kernels.push_back(std::move(kernel));
+  }
+
+  // the steps left keep their interned names
+  std::unordered_map<nodes::Node *, std::string_view> names;
+  for (auto const &step : plan.Steps)
+    names[step.Node] = step.Name;
+
+  plan.Steps.clear();
+  for (auto *node : plan.Order) {
+    if (auto it = roots.find(node); it != roots.end())
+      plan.Steps.push_back({node, it->second, names[node]});
+    else if (!fused.contains(node) && !plan.IsConstant(node))
+      plan.Steps.push_back({node, nullptr, names[node]});
+  }
+}
+
+} // namespace dynamic_editor::runtime
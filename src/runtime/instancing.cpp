@@ -0,0 +1,277 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/runtime/instancing.hpp>
+#include <dynamic_editor/utils/binary_stream.hpp>
+#include <dynamic_editor/utils/interned_string.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+#include <dynamic_editor/views/history.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <utility>
+
+namespace dynamic_editor::runtime {
+
+auto InstanceColumn::Get(size_t instance) const
+    -> nodes::Attribute::ValueType {
+  switch (Type) {
+  case nodes::Attribute::Type::Float:
+    return Floats[instance];
+  case nodes::Attribute::Type::Int:
+    return Ints[instance];
+  case nodes::Attribute::Type::Boolean:
+    return Bools[instance] != 0;
+  case nodes::Attribute::Type::Buffer:
+    return Buffers[instance];
+  default:
+    return std::monostate{};
+  }
+}
+
+void InstanceColumn::Set(size_t instance,
+                         nodes::Attribute::ValueType const &value) {
+  switch (Type) {
+  case nodes::Attribute::Type::Float:
+    if (auto const *f = std::get_if<float>(&value))
+      Floats[instance] = *f;
+    break;
+  case nodes::Attribute::Type::Int:
+    if (auto const *i = std::get_if<int>(&value))
+      Ints[instance] = *i;
+    break;
+  case nodes::Attribute::Type::Boolean:
+    if (auto const *b = std::get_if<bool>(&value))
+      Bools[instance] = *b ? 1 : 0;
+    break;
+  case nodes::Attribute::Type::Buffer:
+    if (auto const *buffer = std::get_if<nodes::Attribute::Buffer>(&value))
+      Buffers[instance] = *buffer;
+    break;
+  default:
+    break;
+  }
+}
+
+static auto MakeColumn(nodes::Attribute const &attribute, size_t instances)
+    -> std::unique_ptr<InstanceColumn> {
+  auto column = std::make_unique<InstanceColumn>();
+  column->Type = attribute.GetType();
+  switch (column->Type) {
+  case nodes::Attribute::Type::Float:
+    column->Floats.resize(instances);
+    break;
+  case nodes::Attribute::Type::Int:
+    column->Ints.resize(instances);
+    break;
+  case nodes::Attribute::Type::Boolean:
+    column->Bools.resize(instances);
+    break;
+  case nodes::Attribute::Type::Buffer:
+    column->Buffers.resize(instances);
+    break;
+  default:
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < instances; i++)
+    column->Set(i, attribute.GetDefaultValue());
+  return column;
+}
+
+// a fresh node of the same type carrying the same properties
+static auto CloneNode(nodes::Node const &node)
+    -> std::shared_ptr<nodes::Node> {
+  for (auto const &factory : api::GetNodeFactories()) {
+    if (factory.Name != node.GetName())
+      continue;
+
+    auto clone = factory.Func();
+    // errors of a clone are reported with the id of the original
+    clone->SetId(node.GetId());
+    views::History::RestoreNode(*clone, *views::History::CaptureNode(node));
+    return clone;
+  }
+  return nullptr;
+}
+
+InstancedGraph::InstancedGraph(std::shared_ptr<const ExecutionPlan> plan,
+                               size_t instances, size_t workers)
+    : m_Plan(std::move(plan)), m_Instances(instances) {
+  if (m_Plan == nullptr || m_Plan->Error.has_value())
+    return;
+
+  for (auto *node : m_Plan->Order) {
+    Step step{node, utils::InternString(node->GetName()), {}, {}, false};
+    for (auto &attribute : node->GetAttributes()) {
+      auto *source = attribute.GetIo() == nodes::Attribute::IO::In
+                         ? m_Plan->FindSource(&attribute)
+                         : nullptr;
+
+      // linked inputs read straight from the column of their source, which
+      // comes earlier in the plan
+      if (source != nullptr) {
+        auto it = m_ColumnsById.find(source->GetId());
+        step.Columns.push_back(it != m_ColumnsById.end() ? it->second
+                                                         : nullptr);
+        continue;
+      }
+
+      // unlinked inputs of inlined subgraphs start from the port default
+      auto column = MakeColumn(*m_Plan->FindDefault(&attribute), m_Instances);
+      step.Columns.push_back(column.get());
+      if (column != nullptr) {
+        m_ColumnsById[attribute.GetId()] = column.get();
+        m_Columns.push_back(std::move(column));
+      }
+    }
+
+    step.State.resize(node->GetInstanceStateSize() * m_Instances);
+    m_Steps.push_back(std::move(step));
+  }
+
+  if (workers == 0)
+    workers = std::max(1U, std::thread::hardware_concurrency());
+  workers = std::clamp<size_t>(workers, 1, std::max<size_t>(m_Instances, 1));
+
+  size_t const block = (m_Instances + workers - 1) / workers;
+  for (size_t begin = 0; begin < m_Instances; begin += block) {
+    Worker worker{begin, std::min(block, m_Instances - begin), {}, {}, {}};
+    for (auto const &step : m_Steps)
+      worker.Clones.push_back(CloneNode(*step.Node));
+    m_Workers.push_back(std::move(worker));
+  }
+
+  // asked of a clone, the nodes of the plan belong to the processing thread
+  std::vector<uint8_t> state;
+  for (size_t s = 0; s < m_Steps.size() && !m_Workers.empty(); s++) {
+    auto const &clone = m_Workers.front().Clones[s];
+    if (clone == nullptr)
+      continue;
+    state.clear();
+    utils::BinaryWriter writer(state);
+    clone->SaveState(writer);
+    m_Steps[s].Stateful = !state.empty();
+  }
+}
+
+void InstancedGraph::SetValue(size_t instance, int attribute_id,
+                              nodes::Attribute::ValueType const &value) {
+  auto *column = GetColumn(attribute_id);
+  if (column != nullptr && instance < m_Instances)
+    column->Set(instance, value);
+}
+
+auto InstancedGraph::GetValue(size_t instance, int attribute_id) const
+    -> nodes::Attribute::ValueType {
+  auto it = m_ColumnsById.find(attribute_id);
+  if (it == m_ColumnsById.end() || instance >= m_Instances)
+    return std::monostate{};
+  return it->second->Get(instance);
+}
+
+auto InstancedGraph::GetColumn(int attribute_id) -> InstanceColumn * {
+  auto it = m_ColumnsById.find(attribute_id);
+  return it != m_ColumnsById.end() ? it->second : nullptr;
+}
+
+auto InstancedGraph::Run(CancellationToken const *token)
+    -> std::optional<nodes::Node::NodeError> {
+  if (m_Plan == nullptr)
+    return std::nullopt;
+  if (m_Plan->Error.has_value())
+    return m_Plan->Error;
+
+  // the calling thread takes the first block
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < m_Workers.size(); i++) {
+    threads.emplace_back([this, i, token] {
+      utils::SetTraceThreadName("Instance worker");
+      RunWorker(m_Workers[i], token);
+    });
+  }
+  if (!m_Workers.empty())
+    RunWorker(m_Workers.front(), token);
+
+  {
+    utils::TraceScope trace("Wait for workers");
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  for (auto &worker : m_Workers) {
+    if (worker.Error.has_value())
+      return std::exchange(worker.Error, std::nullopt);
+  }
+  return std::nullopt;
+}
+
+void InstancedGraph::RunWorker(Worker &worker,
+                               CancellationToken const *token) {
+  utils::TraceScope trace("Instances");
+  worker.Error.reset();
+
+  for (size_t s = 0; s < m_Steps.size(); s++) {
+    if (token != nullptr && token->IsCancelled())
+      return;
+
+    auto &step = m_Steps[s];
+    utils::TraceScope step_trace(step.Name, "node", step.Node->GetId());
+    try {
+      InstanceBlock block(step.Columns, step.State, worker.Begin,
+                          worker.Count);
+      if (step.Node->ProcessInstances(block))
+        continue;
+
+      // one clone runs every instance of the worker, state would leak from
+      // one instance into the next
+      if (step.Stateful) {
+        worker.Error = nodes::Node::NodeError{
+            step.Node, "Stateful node does not support instancing!"};
+        return;
+      }
+
+      auto *clone = worker.Clones[s].get();
+      if (clone == nullptr) {
+        worker.Error = nodes::Node::NodeError{step.Node,
+                                              "Node type can not be cloned!"};
+        return;
+      }
+
+      // the clone is unlinked, so its inputs and outputs all live in the
+      // attribute default values
+      auto &attributes = clone->GetAttributes();
+      if (attributes.size() != step.Columns.size()) {
+        worker.Error = nodes::Node::NodeError{
+            step.Node, "Clone has a different attribute layout!"};
+        return;
+      }
+
+      for (size_t i = worker.Begin; i < worker.Begin + worker.Count; i++) {
+        for (size_t a = 0; a < attributes.size(); a++) {
+          if (step.Columns[a] != nullptr &&
+              attributes[a].GetIo() == nodes::Attribute::IO::In)
+            attributes[a].SetDefaultValue(step.Columns[a]->Get(i));
+        }
+
+        clone->ResetProcessedInputs();
+        clone->Process();
+
+        for (size_t a = 0; a < attributes.size(); a++) {
+          if (step.Columns[a] != nullptr &&
+              attributes[a].GetIo() == nodes::Attribute::IO::Out)
+            step.Columns[a]->Set(i, attributes[a].GetValue(false));
+        }
+      }
+    } catch (nodes::Node::NodeError const &error) {
+      worker.Error = nodes::Node::NodeError{step.Node, error.Message};
+      return;
+    } catch (std::exception const &e) {
+      worker.Error =
+          nodes::Node::NodeError{step.Node,
+                                 utils::CopyString(worker.Message, e.what())};
+      return;
+    }
+  }
+}
+
+} // namespace dynamic_editor::runtime
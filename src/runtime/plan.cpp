@@ -0,0 +1,216 @@
+#include <dynamic_editor/nodes/subgraph.hpp>
+#include <dynamic_editor/runtime/plan.hpp>
+#include <dynamic_editor/utils/interned_string.hpp>
+
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace dynamic_editor::runtime {
+
+static thread_local ExecutionPlan const *s_active_plan = nullptr;
+
+auto ExecutionPlan::GetActive() -> ExecutionPlan const * {
+  return s_active_plan;
+}
+
+// follows ports into (nested) subgraphs until a plain node is reached
+static auto ResolveEndpoint(std::shared_ptr<nodes::Node> node, size_t index)
+    -> std::pair<std::shared_ptr<nodes::Node>, size_t> {
+  while (auto *subgraph = dynamic_cast<nodes::SubgraphNode *>(node.get())) {
+    auto const *target = subgraph->GetPortTarget(index);
+    if (target == nullptr)
+      return {nullptr, 0};
+    node = target->Node;
+    index = target->Index;
+  }
+  return {std::move(node), index};
+}
+
+// path holds the ids of the subgraphs around node, inner nodes are known by
+// their id in the definition so paths stay the same from run to run
+static void Flatten(std::shared_ptr<nodes::Node> const &node, int id,
+                    ExecutionPlan &plan, std::vector<PlanLink> &links,
+                    std::vector<int> &path) {
+  path.push_back(id);
+  auto *subgraph = dynamic_cast<nodes::SubgraphNode *>(node.get());
+  if (subgraph == nullptr) {
+    plan.Nodes.push_back(node);
+    plan.NodePaths.push_back(path);
+    path.pop_back();
+    return;
+  }
+
+  auto const &inner_nodes = subgraph->GetInnerNodes();
+  for (size_t i = 0; i < inner_nodes.size(); i++)
+    Flatten(inner_nodes[i], subgraph->GetInnerNodeIds()[i], plan, links,
+            path);
+  path.pop_back();
+  links.insert(links.end(), subgraph->GetInnerLinks().begin(),
+               subgraph->GetInnerLinks().end());
+
+  // after recursing, so the outermost port wins for nested subgraphs
+  auto &attributes = subgraph->GetAttributes();
+  for (size_t i = 0; i < attributes.size(); i++) {
+    auto [inner, index] = ResolveEndpoint(node, i);
+    if (inner == nullptr)
+      continue;
+
+    if (attributes[i].GetIo() == nodes::Attribute::IO::In)
+      plan.Defaults[&inner->GetAttributes()[index]] = &attributes[i];
+    else
+      plan.PortOutputs.emplace_back(&attributes[i],
+                                    &inner->GetAttributes()[index]);
+  }
+}
+
+// Order is dependencies first, so sources are classified before the nodes
+// reading them
+static void FindConstants(ExecutionPlan &plan) {
+  for (auto *node : plan.Order) {
+    if (!node->IsPure() && !IsExpressible(*node))
+      continue;
+
+    bool varying = false;
+    for (auto const &attribute : node->GetAttributes()) {
+      auto const *source = attribute.GetIo() == nodes::Attribute::IO::In
+                               ? plan.FindSource(&attribute)
+                               : nullptr;
+      varying |= source != nullptr && !plan.IsConstant(source->GetParentNode());
+    }
+    if (varying)
+      continue;
+
+    plan.Constants.push_back(node);
+    plan.ConstantNodes.insert(node);
+  }
+
+  for (auto *node : plan.Constants) {
+    for (auto &attribute : node->GetAttributes()) {
+      if (attribute.GetIo() == nodes::Attribute::IO::In &&
+          plan.FindSource(&attribute) == nullptr)
+        plan.ConstantInputs.push_back(plan.FindDefault(&attribute));
+    }
+  }
+}
+
+auto CompilePlan(std::vector<std::shared_ptr<nodes::Node>> nodes,
+                 std::vector<PlanLink> const &links, PlanOptions options)
+    -> std::shared_ptr<ExecutionPlan> {
+  auto plan = std::make_shared<ExecutionPlan>();
+  plan->Options = options;
+
+  std::vector<PlanLink> all_links = links;
+  std::vector<int> path;
+  for (auto const &node : nodes)
+    Flatten(node, node->GetId(), *plan, all_links, path);
+
+  std::unordered_set<nodes::Node const *> live;
+  for (auto const &node : plan->Nodes)
+    live.insert(node.get());
+
+  std::unordered_map<nodes::Node *, std::vector<nodes::Node *>> upstream;
+  for (auto const &original : all_links) {
+    PlanLink link = original;
+    std::tie(link.FromNode, link.FromIndex) =
+        ResolveEndpoint(link.FromNode, link.FromIndex);
+    std::tie(link.ToNode, link.ToIndex) =
+        ResolveEndpoint(link.ToNode, link.ToIndex);
+    if (!live.contains(link.FromNode.get()) ||
+        !live.contains(link.ToNode.get()))
+      continue;
+
+    auto &from_attributes = link.FromNode->GetAttributes();
+    auto &to_attributes = link.ToNode->GetAttributes();
+    if (link.FromIndex >= from_attributes.size() ||
+        link.ToIndex >= to_attributes.size())
+      continue;
+
+    // links may be drawn from either end
+    auto *output = &from_attributes[link.FromIndex];
+    auto *input = &to_attributes[link.ToIndex];
+    if (output->GetIo() != nodes::Attribute::IO::Out)
+      std::swap(output, input);
+    if (output->GetIo() != nodes::Attribute::IO::Out ||
+        input->GetIo() != nodes::Attribute::IO::In)
+      continue;
+
+    plan->Sources[input] = output;
+    plan->ConnectedOutputs.insert(output);
+    upstream[input->GetParentNode()].push_back(output->GetParentNode());
+  }
+
+  // depth first from every end node, a node is appended once all of its
+  // dependencies are
+  enum class Mark { None, Visiting, Done };
+  std::unordered_map<nodes::Node *, Mark> marks;
+  std::vector<std::pair<nodes::Node *, size_t>> stack;
+
+  for (auto const &node : plan->Nodes) {
+    bool has_input = false;
+    bool has_output = false;
+    for (auto const &attribute : node->GetAttributes()) {
+      has_input |= attribute.GetIo() == nodes::Attribute::IO::In;
+      has_output |= attribute.GetIo() == nodes::Attribute::IO::Out;
+    }
+    if (!has_input || has_output || marks[node.get()] != Mark::None)
+      continue;
+
+    stack.emplace_back(node.get(), 0);
+    marks[node.get()] = Mark::Visiting;
+    while (!stack.empty() && !plan->Error.has_value()) {
+      auto &[current, next] = stack.back();
+      auto const &dependencies = upstream[current];
+      if (next == dependencies.size()) {
+        marks[current] = Mark::Done;
+        plan->Order.push_back(current);
+        stack.pop_back();
+        continue;
+      }
+
+      auto *dependency = dependencies[next++];
+      auto &mark = marks[dependency];
+      if (mark == Mark::Visiting) {
+        plan->Error = nodes::Node::NodeError{dependency, "Cycle detected!"};
+      } else if (mark == Mark::None) {
+        mark = Mark::Visiting;
+        stack.emplace_back(dependency, 0);
+      }
+    }
+
+    if (plan->Error.has_value()) {
+      plan->Order.clear();
+      break;
+    }
+  }
+
+  if (!plan->Error.has_value())
+    FindConstants(*plan);
+
+  for (auto *node : plan->Order) {
+    if (!plan->IsConstant(node))
+      plan->Steps.push_back(
+          {node, nullptr, utils::InternString(node->GetName())});
+    for (auto &attribute : node->GetAttributes()) {
+      if (attribute.GetIo() == nodes::Attribute::IO::Out)
+        plan->Outputs.emplace_back(&attribute, plan->IsConnected(&attribute));
+    }
+  }
+  if (!plan->Error.has_value()) {
+    if (options.Bytecode)
+      CompileBytecode(*plan);
+    else if (options.Fuse)
+      FuseExpressions(*plan);
+  }
+
+  return plan;
+}
+
+ActivePlanScope::ActivePlanScope(ExecutionPlan const &plan)
+    : m_Previous(s_active_plan) {
+  s_active_plan = &plan;
+}
+
+ActivePlanScope::~ActivePlanScope() { s_active_plan = m_Previous; }
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,262 @@
+#include <dynamic_editor/runtime/snapshot.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <variant>
+
+namespace dynamic_editor::runtime {
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "snapshot segments need address free atomics");
+static_assert(std::is_trivially_copyable_v<SnapshotInfo> &&
+              std::is_trivially_copyable_v<SnapshotNode> &&
+              std::is_trivially_copyable_v<SnapshotValue>);
+
+// a torn read is retried this often before giving up for the frame
+constexpr int ReadAttempts = 16;
+
+struct SnapshotLayout {
+  size_t Nodes;
+  size_t Values;
+  size_t Samples;
+  size_t Size;
+};
+
+auto Align(size_t offset) -> size_t { return (offset + 63) & ~size_t{63}; }
+
+auto GetLayout(uint32_t nodes, uint32_t values, uint32_t samples)
+    -> SnapshotLayout {
+  SnapshotLayout layout{};
+  layout.Nodes = Align(sizeof(SnapshotHeader));
+  layout.Values = Align(layout.Nodes + nodes * sizeof(SnapshotNode));
+  layout.Samples = Align(layout.Values + values * sizeof(SnapshotValue));
+  layout.Size = layout.Samples + samples * sizeof(float);
+  return layout;
+}
+
+auto GetLayout(SnapshotHeader const &header) -> SnapshotLayout {
+  return GetLayout(header.NodeCapacity, header.ValueCapacity,
+                   header.SampleCapacity);
+}
+
+template <size_t N> void CopyName(char (&out)[N], std::string const &name) {
+  size_t const size = std::min(name.size(), N - 1);
+  std::memcpy(out, name.data(), size);
+  out[size] = '\0';
+}
+
+auto Now() -> int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+auto SnapshotPublisher::Create(std::string const &name,
+                               SnapshotCapacity capacity)
+    -> std::shared_ptr<SnapshotPublisher> {
+  auto const layout =
+      GetLayout(capacity.Nodes, capacity.Values, capacity.Samples);
+  auto memory = utils::SharedMemory::Create(name, layout.Size);
+  if (memory == nullptr)
+    return nullptr;
+
+  // the segment starts out zeroed, readers ignore it until the magic is set
+  auto *header = new (memory->GetData()) SnapshotHeader{};
+  header->LayoutVersion = SnapshotLayoutVersion;
+  header->NodeCapacity = capacity.Nodes;
+  header->ValueCapacity = capacity.Values;
+  header->SampleCapacity = capacity.Samples;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->Magic = SnapshotMagic;
+
+  return std::shared_ptr<SnapshotPublisher>(
+      new SnapshotPublisher(std::move(memory)));
+}
+
+SnapshotPublisher::SnapshotPublisher(
+    std::unique_ptr<utils::SharedMemory> memory)
+    : m_Memory(std::move(memory)),
+      m_Header(static_cast<SnapshotHeader *>(m_Memory->GetData())) {
+  auto const layout = GetLayout(*m_Header);
+  auto *const base = static_cast<char *>(m_Memory->GetData());
+  m_Nodes = reinterpret_cast<SnapshotNode *>(base + layout.Nodes);
+  m_Values = reinterpret_cast<SnapshotValue *>(base + layout.Values);
+  m_Samples = reinterpret_cast<float *>(base + layout.Samples);
+}
+
+SnapshotPublisher::~SnapshotPublisher() {
+  m_Header->Closed.store(1, std::memory_order_release);
+}
+
+void SnapshotPublisher::PassFinished(ExecutionPlan const &plan) {
+  auto const now = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds const interval(
+      m_Interval.load(std::memory_order_relaxed));
+  if (interval.count() > 0 && now - m_LastPublish < interval)
+    return;
+  m_LastPublish = now;
+
+  utils::TraceScope trace("Publish snapshot");
+  auto &header = *m_Header;
+  uint64_t const sequence = header.Sequence.load(std::memory_order_relaxed);
+  header.Sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  SnapshotInfo info{};
+  info.Pass = header.Info.Pass + 1;
+  info.PlanVersion = plan.Version;
+  for (auto const &node : plan.Nodes) {
+    if (info.NodeCount == header.NodeCapacity) {
+      info.Truncated = 1;
+      break;
+    }
+
+    auto &out = m_Nodes[info.NodeCount++];
+    out.Id = node->GetId();
+    out.FirstValue = info.ValueCount;
+    out.ValueCount = 0;
+    out.ErrorCount = node->GetErrorCount();
+    out.WarningCount = node->GetWarningCount();
+    CopyName(out.Title, node->GetTitle());
+
+    for (auto &attribute : node->GetAttributes()) {
+      if (attribute.GetIo() != nodes::Attribute::IO::Out)
+        continue;
+      if (info.ValueCount == header.ValueCapacity) {
+        info.Truncated = 1;
+        break;
+      }
+
+      auto &value = m_Values[info.ValueCount++];
+      out.ValueCount++;
+      value = SnapshotValue{};
+      value.AttributeId = attribute.GetId();
+      value.Type = static_cast<uint8_t>(attribute.GetType());
+      value.FirstSample = info.SampleCount;
+      CopyName(value.Name, attribute.GetName());
+      std::visit(
+          [&](auto const &v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, nodes::Attribute::Buffer>) {
+              value.HasValue = 1;
+              if (v == nullptr)
+                return;
+              uint32_t const free = header.SampleCapacity - info.SampleCount;
+              value.BufferSize = v->size();
+              value.SampleCount =
+                  static_cast<uint32_t>(std::min<size_t>(v->size(), free));
+              if (value.SampleCount < v->size())
+                info.Truncated = 1;
+              std::copy_n(v->data(), value.SampleCount,
+                          m_Samples + info.SampleCount);
+              info.SampleCount += value.SampleCount;
+            } else if constexpr (!std::is_same_v<T, std::monostate>) {
+              value.HasValue = 1;
+              value.Scalar = static_cast<double>(v);
+            }
+          },
+          attribute.GetValue(plan.IsConnected(&attribute)));
+    }
+  }
+  info.PublishedAt = Now();
+  header.Info = info;
+
+  header.Sequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto SnapshotReader::Open(std::string const &name)
+    -> std::unique_ptr<SnapshotReader> {
+  auto memory = utils::SharedMemory::Open(name);
+  if (memory == nullptr || memory->GetSize() < sizeof(SnapshotHeader))
+    return nullptr;
+
+  auto const &header =
+      *static_cast<SnapshotHeader const *>(memory->GetData());
+  if (header.Magic != SnapshotMagic)
+    return nullptr;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header.LayoutVersion != SnapshotLayoutVersion) {
+    printf("Snapshot %s has layout version %u, expected %u\n", name.c_str(),
+           header.LayoutVersion, SnapshotLayoutVersion);
+    return nullptr;
+  }
+  if (GetLayout(header).Size > memory->GetSize()) {
+    printf("Snapshot %s is smaller than its capacities\n", name.c_str());
+    return nullptr;
+  }
+  return std::unique_ptr<SnapshotReader>(new SnapshotReader(std::move(memory)));
+}
+
+SnapshotReader::SnapshotReader(std::unique_ptr<utils::SharedMemory> memory)
+    : m_Memory(std::move(memory)),
+      m_Header(static_cast<SnapshotHeader const *>(m_Memory->GetData())) {}
+
+auto SnapshotReader::Read(Snapshot &out) const -> bool {
+  auto const &header = *m_Header;
+  auto const layout = GetLayout(header);
+  auto const *const base = static_cast<char const *>(m_Memory->GetData());
+
+  // the copies may race with the publisher, which is only noticed through
+  // Sequence afterwards. Whatever they read is thrown away in that case
+  for (int attempt = 0; attempt < ReadAttempts; attempt++) {
+    uint64_t const sequence = header.Sequence.load(std::memory_order_acquire);
+    if (sequence == 0)
+      return false;
+    if (sequence % 2 != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    SnapshotInfo info{};
+    std::memcpy(&info, &header.Info, sizeof(info));
+    bool const fits = info.NodeCount <= header.NodeCapacity &&
+                      info.ValueCount <= header.ValueCapacity &&
+                      info.SampleCount <= header.SampleCapacity;
+    if (fits) {
+      out.Nodes.resize(info.NodeCount);
+      out.Values.resize(info.ValueCount);
+      out.Samples.resize(info.SampleCount);
+      std::memcpy(out.Nodes.data(), base + layout.Nodes,
+                  info.NodeCount * sizeof(SnapshotNode));
+      std::memcpy(out.Values.data(), base + layout.Values,
+                  info.ValueCount * sizeof(SnapshotValue));
+      std::memcpy(out.Samples.data(), base + layout.Samples,
+                  info.SampleCount * sizeof(float));
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.Sequence.load(std::memory_order_relaxed) != sequence)
+      continue;
+    if (!fits)
+      return false;
+
+    // consistent, but still written by another process
+    for (auto &node : out.Nodes) {
+      node.Title[SnapshotNameLength - 1] = '\0';
+      if (node.FirstValue > info.ValueCount ||
+          node.ValueCount > info.ValueCount - node.FirstValue)
+        return false;
+    }
+    for (auto &value : out.Values) {
+      value.Name[SnapshotNameLength - 1] = '\0';
+      if (value.FirstSample > info.SampleCount ||
+          value.SampleCount > info.SampleCount - value.FirstSample)
+        return false;
+    }
+    out.Info = info;
+    return true;
+  }
+  return false;
+}
+
+} // namespace dynamic_editor::runtime
@@ -0,0 +1,54 @@
+#include <dynamic_editor/utils/allocation_counter.hpp>
+
+#include <cstdlib>
+#include <new>
+
+namespace dynamic_editor::utils {
+
+static thread_local uint64_t s_thread_allocations = 0;
+
+auto GetThreadAllocationCount() -> uint64_t { return s_thread_allocations; }
+
+auto IsCountingAllocations() -> bool {
+#ifdef IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+} // namespace dynamic_editor::utils
+
+#ifdef IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS
+
+// every other form of operator new ends up in one of these two
+void *operator new(std::size_t size) {
+  dynamic_editor::utils::s_thread_allocations++;
+  if (void *pointer = std::malloc(size != 0 ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  dynamic_editor::utils::s_thread_allocations++;
+  auto const align = static_cast<std::size_t>(alignment);
+  // aligned_alloc wants a multiple of the alignment
+  size = (size + align - 1) / align * align;
+  if (void *pointer = std::aligned_alloc(align, size != 0 ? size : align))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, std::align_val_t /*alignment*/) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, std::size_t /*size*/,
+                     std::align_val_t /*alignment*/) noexcept {
+  std::free(pointer);
+}
+
+#endif
@@ -0,0 +1,24 @@
+#include <dynamic_editor/utils/arena.hpp>
+
+#include <utility>
+
+namespace dynamic_editor::utils {
+
+static thread_local std::shared_ptr<Arena> s_current_arena;
+
+auto Arena::GetCurrent() -> std::shared_ptr<Arena> const & {
+  return s_current_arena;
+}
+
+auto GetCurrentResource() -> std::pmr::memory_resource * {
+  if (s_current_arena != nullptr)
+    return s_current_arena.get();
+  return std::pmr::get_default_resource();
+}
+
+ArenaScope::ArenaScope(std::shared_ptr<Arena> arena)
+    : m_Previous(std::exchange(s_current_arena, std::move(arena))) {}
+
+ArenaScope::~ArenaScope() { s_current_arena = std::move(m_Previous); }
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,87 @@
+#include <dynamic_editor/utils/durable_file.hpp>
+
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define IM_DYNAMIC_EDITOR_POSIX_FILES
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace dynamic_editor::utils {
+
+#ifdef IM_DYNAMIC_EDITOR_POSIX_FILES
+
+static auto WriteAll(int fd, std::string_view data) -> bool {
+  while (!data.empty()) {
+    auto const written = ::write(fd, data.data(), data.size());
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    data.remove_prefix(static_cast<size_t>(written));
+  }
+  return true;
+}
+
+auto ReplaceFile(std::filesystem::path const &path, std::string_view data)
+    -> bool {
+  auto temp_path = path;
+  temp_path += ".tmp";
+
+  int const fd =
+      ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return false;
+  bool const written = WriteAll(fd, data) && ::fsync(fd) == 0;
+  if (::close(fd) != 0 || !written) {
+    ::unlink(temp_path.c_str());
+    return false;
+  }
+
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+    return false;
+  return SyncDirectory(path.parent_path());
+}
+
+auto SyncDirectory(std::filesystem::path const &directory) -> bool {
+  auto const &name = directory.empty() ? "." : directory.native();
+  int const fd = ::open(name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  bool const synced = ::fsync(fd) == 0;
+  return ::close(fd) == 0 && synced;
+}
+
+#else
+
+// without POSIX the data is only flushed to the system, which keeps the
+// rename atomic but may lose both files on power loss
+auto ReplaceFile(std::filesystem::path const &path, std::string_view data)
+    -> bool {
+  auto temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path,
+                       std::ios::out | std::ios::trunc | std::ios::binary);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.flush();
+    if (!file)
+      return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  return !error;
+}
+
+auto SyncDirectory(std::filesystem::path const & /*directory*/) -> bool {
+  return true;
+}
+
+#endif
+
+} // namespace dynamic_editor::utils
@@ -27,13 +27,14 @@ void BeginSubWindow(char const *label, ImVec2 size, ImGuiChildFlags flags) {
   bool const has_menu_bar = !std::string_view(label).empty();
 
   PushStyleVar(ImGuiStyleVar_ChildRounding, 5.0F);
-  auto label_s = std::string(label) + "##SubWindow";
-  if (BeginChild(label_s.c_str(), size,
+  // the id of label + "##SubWindow", hashed on without building the string
+  ImGuiID const id = ImHashStr("##SubWindow", 0, GetID(label));
+  if (BeginChild(id, size,
                  ImGuiChildFlags_Border | ImGuiChildFlags_AutoResizeY | flags,
                  has_menu_bar ? ImGuiWindowFlags_MenuBar
                               : ImGuiWindowFlags_None)) {
     if (has_menu_bar && BeginMenuBar()) {
-      TextUnformatted(label);
+      TextUnformatted(label, ImGui::FindRenderedTextEnd(label));
       EndMenuBar();
     }
   }
@@ -44,26 +45,31 @@ void EndSubWindow() { EndChild(); }
 
 void TextUnformattedCentered(char const *text) {
   auto available_space = ImGui::GetContentRegionAvail();
-
-  std::string draw_string;
+  float const wrap_width = available_space.x * 0.8F;
   auto const *text_end = text + strlen(text);
-  for (auto const *wrap_pos = text; wrap_pos != text_end;) {
-    wrap_pos = ImGui::GetFont()->CalcWordWrapPositionA(
-        1, wrap_pos, text_end, available_space.x * 0.8F);
-    draw_string += std::string(text, wrap_pos) + "\n";
-    text = wrap_pos;
-  }
-
-  if (!draw_string.empty())
-    draw_string.pop_back();
 
-  auto text_size = ImGui::CalcTextSize(draw_string.c_str());
+  // lines are drawn one by one from the wrap positions, so nothing has to
+  // be copied into a wrapped string
+  int lines = 0;
+  for (auto const *wrap_pos = text; wrap_pos != text_end; lines++) {
+    wrap_pos = ImGui::GetFont()->CalcWordWrapPositionA(1, wrap_pos, text_end,
+                                                       wrap_width);
+  }
 
-  ImPlot::AddTextCentered(ImGui::GetWindowDrawList(),
-                          ImGui::GetCursorScreenPos() + ImVec2(available_space.x / 2, available_space.y / 2) -
-                              ImVec2(0, text_size.y / 2),
-                          ImGui::GetColorU32(ImGuiCol_Text),
-                          draw_string.c_str());
+  float const line_height = ImGui::GetTextLineHeight();
+  auto top_center = ImGui::GetCursorScreenPos() +
+                    ImVec2(available_space.x / 2, available_space.y / 2) -
+                    ImVec2(0, line_height * static_cast<float>(lines) / 2);
+
+  for (auto const *line = text; line != text_end;) {
+    auto const *wrap_pos = ImGui::GetFont()->CalcWordWrapPositionA(
+        1, line, text_end, wrap_width);
+    ImPlot::AddTextCentered(ImGui::GetWindowDrawList(), top_center,
+                            ImGui::GetColorU32(ImGuiCol_Text), line,
+                            wrap_pos);
+    top_center.y += line_height;
+    line = wrap_pos;
+  }
 }
 
 bool InputText(char const *label, std::u8string &buffer,
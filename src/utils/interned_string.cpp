@@ -0,0 +1,26 @@
+#include <dynamic_editor/utils/interned_string.hpp>
+
+#include <functional>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+
+namespace dynamic_editor::utils {
+
+auto InternString(std::string_view text) -> std::string_view {
+  // set nodes never move, so views into them stay valid
+  static std::shared_mutex s_mutex;
+  static std::set<std::string, std::less<>> s_strings;
+
+  {
+    std::shared_lock lock(s_mutex);
+    if (auto it = s_strings.find(text); it != s_strings.end())
+      return *it;
+  }
+
+  std::unique_lock lock(s_mutex);
+  return *s_strings.emplace(text).first;
+}
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,100 @@
+#include <dynamic_editor/utils/shared_memory.hpp>
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define IM_DYNAMIC_EDITOR_POSIX_SHARED_MEMORY
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dynamic_editor::utils {
+
+#ifdef IM_DYNAMIC_EDITOR_POSIX_SHARED_MEMORY
+
+auto SharedMemory::Create(std::string const &name, size_t size)
+    -> std::unique_ptr<SharedMemory> {
+  // readers of a stale segment keep their mapping, the name is ours now
+  shm_unlink(name.c_str());
+  int const fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    printf("Failed to create shared memory %s\n", name.c_str());
+    return nullptr;
+  }
+
+  struct stat info {};
+  void *data = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0 && fstat(fd, &info) == 0)
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    printf("Failed to map shared memory %s\n", name.c_str());
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  auto memory = std::unique_ptr<SharedMemory>(
+      new SharedMemory(name, data, size, true));
+  memory->m_Device = static_cast<uint64_t>(info.st_dev);
+  memory->m_Inode = static_cast<uint64_t>(info.st_ino);
+  return memory;
+}
+
+auto SharedMemory::Open(std::string const &name)
+    -> std::unique_ptr<SharedMemory> {
+  int const fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat info {};
+  void *data = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  return std::unique_ptr<SharedMemory>(new SharedMemory(
+      name, data, static_cast<size_t>(info.st_size), false));
+}
+
+SharedMemory::~SharedMemory() {
+  munmap(m_Data, m_Size);
+  if (!m_Owner)
+    return;
+
+  // the name may have been taken over by a newer segment in the meantime,
+  // which is left alone
+  int const fd = shm_open(m_Name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return;
+  struct stat info {};
+  bool const ours = fstat(fd, &info) == 0 &&
+                    static_cast<uint64_t>(info.st_dev) == m_Device &&
+                    static_cast<uint64_t>(info.st_ino) == m_Inode;
+  ::close(fd);
+  if (ours)
+    shm_unlink(m_Name.c_str());
+}
+
+#else
+
+auto SharedMemory::Create(std::string const &name, size_t /*size*/)
+    -> std::unique_ptr<SharedMemory> {
+  printf("Shared memory %s: only supported on POSIX systems\n",
+         name.c_str());
+  return nullptr;
+}
+
+auto SharedMemory::Open(std::string const & /*name*/)
+    -> std::unique_ptr<SharedMemory> {
+  return nullptr;
+}
+
+SharedMemory::~SharedMemory() = default;
+
+#endif
+
+} // namespace dynamic_editor::utils
@@ -0,0 +1,160 @@
+#include <dynamic_editor/utils/mpsc_queue.hpp>
+#include <dynamic_editor/utils/trace.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::utils {
+
+namespace {
+
+constexpr size_t TraceBufferCapacity = 16384;
+
+using TraceBuffer = MpscRingBuffer<TraceEvent>;
+
+struct TraceRegistry {
+  // also held while flushing, so the buffers only ever have one consumer
+  std::mutex Mutex;
+  std::vector<std::unique_ptr<TraceBuffer>> Buffers;
+  // buffers of threads that exited, handed to the next thread that traces
+  std::vector<TraceBuffer *> Free;
+  std::map<uint32_t, std::string> ThreadNames;
+};
+
+auto GetRegistry() -> TraceRegistry & {
+  static TraceRegistry s_registry;
+  return s_registry;
+}
+
+std::atomic<bool> s_tracing{false};
+std::atomic<uint64_t> s_dropped{0};
+std::atomic<uint32_t> s_next_thread{1};
+
+auto Now() -> uint64_t {
+  static auto const s_epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - s_epoch)
+      .count();
+}
+
+// events carry the thread id, so a buffer can outlive its thread and be
+// reused by the next one
+struct TraceThread {
+  uint32_t Id = s_next_thread.fetch_add(1, std::memory_order_relaxed);
+  TraceBuffer *Buffer = nullptr;
+
+  ~TraceThread() {
+    if (Buffer == nullptr)
+      return;
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.Mutex);
+    registry.Free.push_back(Buffer);
+  }
+};
+
+thread_local TraceThread t_thread;
+
+void RecordEvent(TraceEvent const &event) {
+  auto &thread = t_thread;
+  if (thread.Buffer == nullptr) {
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.Mutex);
+    if (!registry.Free.empty()) {
+      thread.Buffer = registry.Free.back();
+      registry.Free.pop_back();
+    } else {
+      thread.Buffer = registry.Buffers
+                          .emplace_back(std::make_unique<TraceBuffer>(
+                              TraceBufferCapacity))
+                          .get();
+    }
+  }
+
+  if (!thread.Buffer->TryPush(event))
+    s_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void SetTracing(bool enabled) {
+  if (enabled && !IsTracing())
+    s_dropped.store(0, std::memory_order_relaxed);
+  s_tracing.store(enabled, std::memory_order_relaxed);
+}
+
+auto IsTracing() -> bool { return s_tracing.load(std::memory_order_relaxed); }
+
+void SetTraceThreadName(std::string_view name) {
+  auto &registry = GetRegistry();
+  std::lock_guard lock(registry.Mutex);
+  registry.ThreadNames[t_thread.Id] = name;
+}
+
+auto GetDroppedTraceEvents() -> uint64_t {
+  return s_dropped.load(std::memory_order_relaxed);
+}
+
+auto WriteChromeTrace(std::filesystem::path const &path) -> bool {
+  auto &registry = GetRegistry();
+  std::lock_guard lock(registry.Mutex);
+
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  // timestamps are in microseconds
+  file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+  bool first = true;
+  auto const separate = [&] {
+    file << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  for (auto const &[id, name] : registry.ThreadNames) {
+    separate();
+    file << R"({"ph":"M","pid":1,"tid":)" << id
+         << R"(,"name":"thread_name","args":{"name":)"
+         << nlohmann::json(name).dump() << "}}";
+  }
+
+  TraceEvent event{};
+  for (auto const &buffer : registry.Buffers) {
+    while (buffer->TryPop(event)) {
+      separate();
+      file << R"({"ph":"X","pid":1,"tid":)" << event.Thread
+           << R"(,"cat":)" << nlohmann::json(event.Category).dump()
+           << R"(,"name":)" << nlohmann::json(event.Name).dump()
+           << R"(,"ts":)" << static_cast<double>(event.Begin) / 1000.0
+           << R"(,"dur":)" << static_cast<double>(event.Duration) / 1000.0;
+      if (event.Id >= 0)
+        file << R"(,"args":{"id":)" << event.Id << "}";
+      file << "}";
+    }
+  }
+
+  file << "\n]}\n";
+  return file.good();
+}
+
+TraceScope::TraceScope(std::string_view name, char const *category, int id)
+    : m_Name(name), m_Category(category), m_Id(id), m_Enabled(IsTracing()) {
+  if (m_Enabled)
+    m_Begin = Now();
+}
+
+TraceScope::~TraceScope() {
+  if (!m_Enabled)
+    return;
+
+  uint64_t const end = Now();
+  RecordEvent({m_Name, m_Category, m_Begin, end - m_Begin, m_Id, t_thread.Id});
+}
+
+} // namespace dynamic_editor::utils
@@ -1,8 +1,11 @@
 #include <dynamic_editor/api/dynamic_editor.hpp>
 
 #include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/nodes/data_source.hpp>
 #include <dynamic_editor/nodes/link.hpp>
 #include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/nodes/subgraph.hpp>
+#include <dynamic_editor/utils/allocation_counter.hpp>
 #include <dynamic_editor/views/editor.hpp>
 #include <dynamic_editor/views/inspector.hpp>
 
@@ -10,12 +13,77 @@
 
 #include <nlohmann/json.hpp>
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 
 #include "imgui.h"
 
 namespace dynamic_editor::views {
+
+// definitions have to be known before any node refers to them by name
+static void RegisterSubgraphs(const nlohmann::json &data) {
+  if (!data.contains("subgraphs"))
+    return;
+
+  for (auto const &[name, definition] : data["subgraphs"].items()) {
+    try {
+      api::RegisterSubgraph(nodes::SubgraphDefinition::Load(name, definition));
+    } catch (nlohmann::json::exception const &e) {
+      printf("Error loading subgraph %s: %s\n", name.c_str(), e.what());
+    }
+  }
+}
+
+// places the viewer entry of a node where Node::Dump saved it
+static void LoadGridPosition(int id, nlohmann::json const &impl) {
+  auto const grid = impl.find("grid");
+  if (grid == impl.end())
+    return;
+
+  ImGridPosition const grid_position = {
+      grid->at("x").get<float>(),
+      grid->at("y").get<float>(),
+      grid->at("w").get<float>(),
+      grid->at("h").get<float>(),
+  };
+  ImGrid::SetEntryPosition(id, grid_position);
+}
+
+// description of a node type in the add node menu, with its ports when the
+// type declares them
+static void FactoryTooltip(nodes::NodeFactory const &factory) {
+  if (factory.Description.empty() || !ImGui::BeginItemTooltip())
+    return;
+
+  ImGui::Text("%s", factory.Description.c_str());
+  if (factory.Type != nullptr) {
+    for (auto const &port : factory.Type->GetPorts()) {
+      ImGui::TextDisabled("%s %s",
+                          port.Io == nodes::Attribute::IO::In ? "in " : "out",
+                          port.Name.c_str());
+    }
+  }
+  ImGui::EndTooltip();
+}
+
+static void CollectSubgraphs(
+    nodes::Node const &node,
+    std::map<std::string, std::shared_ptr<const nodes::SubgraphDefinition>>
+        &definitions) {
+  auto const *subgraph = dynamic_cast<nodes::SubgraphNode const *>(&node);
+  if (subgraph == nullptr || subgraph->GetDefinition() == nullptr)
+    return;
+
+  auto const &definition = subgraph->GetDefinition();
+  if (!definitions.emplace(definition->Name, definition).second)
+    return;
+
+  for (auto const &inner : subgraph->GetInnerNodes())
+    CollectSubgraphs(*inner, definitions);
+}
+
 void Editor::RenderWindowed(bool &show) {
   if (!show)
     return;
@@ -26,11 +94,19 @@ void Editor::RenderWindowed(bool &show) {
 
 void Editor::LoadNodes(const nlohmann::json &data) {
   m_Nodes->Nodes.clear();
-  m_EndNodes.clear();
   m_Links.clear();
+  // the old graph is freed in one go once the processing thread let go of it
+  m_Nodes->ResetArena();
   printf("loading nodes from %s\n", data.dump(4).c_str());
 
+  // the processing thread switches to the new graph in one go
+  m_Executor.BeginBatch();
+  m_Executor.Submit(runtime::command::Clear{});
+
   try {
+    RegisterSubgraphs(data);
+    m_Nodes->ReserveIds(data);
+
     if (data.contains("nodes")) {
       auto nodes_data = data["nodes"];
       for (const auto &node_data : nodes_data) {
@@ -38,27 +114,6 @@ void Editor::LoadNodes(const nlohmann::json &data) {
         if (new_node == nullptr)
           continue;
 
-        bool hasOutput = false;
-        bool hasInput = false;
-        uint32_t attrIndex = 0;
-        for (auto &attr : new_node->GetAttributes()) {
-          if (attr.GetIo() == nodes::Attribute::IO::Out)
-            hasOutput = true;
-
-          if (attr.GetIo() == nodes::Attribute::IO::In)
-            hasInput = true;
-
-          if (attrIndex < node_data["attrs"].size())
-            attr.SetId(node_data["attrs"][attrIndex]);
-          else
-            attr.SetId(-1);
-
-          attrIndex++;
-        }
-
-        if (hasInput && !hasOutput)
-          m_EndNodes.push_back(new_node.get());
-
         new_node->SetPosition(
             ImVec2(node_data["pos"]["x"], node_data["pos"]["y"]));
 
@@ -66,97 +121,206 @@ void Editor::LoadNodes(const nlohmann::json &data) {
       }
     }
 
-    int maxLinkId = 0;
+    for (auto &node : m_Nodes->Nodes)
+      m_Executor.Submit(runtime::command::AddNode{node});
+
     if (data.contains("links")) {
-      for (auto &link : data["links"]) {
-        nodes::Link newLink(link["from"], link["to"]);
+      for (auto &link : data["links"])
+        CreateLink(link["from"], link["to"], link["id"]);
+    }
 
-        int linkId = link["id"];
-        maxLinkId = std::max(linkId, maxLinkId);
+    m_Changes = {};
+    m_Changes.Reset = true;
 
-        newLink.SetId(linkId);
-        m_Links.push_back(newLink);
+    m_History.Clear();
+    for (auto &node : m_Nodes->Nodes)
+      m_History.SetSnapshot(node->GetId(), History::CaptureNode(*node));
 
-        nodes::Attribute *fromAttr = nullptr, *toAttr = nullptr;
-        for (auto &node : m_Nodes->Nodes) {
-          for (auto &attribute : node->GetAttributes()) {
-            if (attribute.GetId() == newLink.GetFromId())
-              fromAttr = &attribute;
-            else if (attribute.GetId() == newLink.GetToId())
-              toAttr = &attribute;
-          }
-        }
+    m_UpdateNodePositions = true;
+  } catch (nlohmann::json::exception const &e) {
+    printf("Error loading nodes: %s\n", e.what());
+  }
 
-        if (fromAttr == nullptr || toAttr == nullptr)
-          continue;
+  m_Executor.EndBatch();
+}
 
-        if (fromAttr->GetType() != toAttr->GetType())
-          continue;
+void Editor::ReconcileNodes(const nlohmann::json &data) {
+  std::map<int, nlohmann::json const *> incoming_nodes;
+  std::map<int, nlohmann::json const *> incoming_links;
 
-        if (fromAttr->GetIo() == toAttr->GetIo())
-          continue;
+  try {
+    RegisterSubgraphs(data);
+    m_Nodes->ReserveIds(data);
+    if (data.contains("nodes")) {
+      for (auto const &node_data : data["nodes"])
+        incoming_nodes[node_data.at("id").get<int>()] = &node_data;
+    }
+    if (data.contains("links")) {
+      for (auto const &link_data : data["links"])
+        incoming_links[link_data.at("id").get<int>()] = &link_data;
+    }
+  } catch (nlohmann::json::exception const &e) {
+    printf("Error reconciling nodes: %s\n", e.what());
+    return;
+  }
+
+  // the whole reconcile is a single undo step
+  m_History.BeginStep();
+  m_Executor.BeginBatch();
+
+  // links that disappeared or now connect different attributes go first, so
+  // erasing or replacing nodes below never leaves dangling connections
+  std::vector<int> stale_links;
+  for (auto const &link : m_Links) {
+    auto it = incoming_links.find(link.GetId());
+    if (it == incoming_links.end() ||
+        (*it->second)["from"].get<int>() != link.GetFromId() ||
+        (*it->second)["to"].get<int>() != link.GetToId())
+      stale_links.push_back(link.GetId());
+  }
+  for (int id : stale_links)
+    EraseLink(id);
+
+  // a node is replaced when its type or attribute layout changed, otherwise
+  // the live instance is patched and keeps its runtime state
+  std::vector<int> stale_nodes;
+  for (auto const &node : m_Nodes->Nodes) {
+    auto it = incoming_nodes.find(node->GetId());
+    if (it == incoming_nodes.end()) {
+      stale_nodes.push_back(node->GetId());
+      continue;
+    }
+
+    auto const &node_data = *it->second;
+    bool same_layout =
+        node_data.value("name", std::string()) == node->GetName() &&
+        node_data["attrs"].size() == node->GetAttributes().size();
+    for (size_t i = 0; same_layout && i < node->GetAttributes().size(); i++)
+      same_layout = node_data["attrs"][i].get<int>() ==
+                    node->GetAttributes()[i].GetId();
+
+    // subgraphs whose definition was replaced would keep running the inner
+    // graph of the old one
+    if (auto const *subgraph =
+            dynamic_cast<nodes::SubgraphNode const *>(node.get()))
+      same_layout = same_layout && subgraph->IsCurrent();
+
+    if (!same_layout)
+      stale_nodes.push_back(node->GetId());
+  }
+  EraseNodes(stale_nodes);
+
+  for (auto const &[id, node_data_ptr] : incoming_nodes) {
+    auto const &node_data = *node_data_ptr;
 
-        if (!toAttr->GetConnectedAttributes().empty())
+    try {
+      ImVec2 const pos(node_data["pos"]["x"], node_data["pos"]["y"]);
+      auto *node = FindNode(id);
+
+      if (node == nullptr) {
+        auto new_node = LoadNode(node_data);
+        if (new_node == nullptr)
           continue;
 
-        fromAttr->AddConnectedAttribute(newLink.GetId(), toAttr);
-        toAttr->AddConnectedAttribute(newLink.GetId(), fromAttr);
+        new_node->SetPosition(pos);
+        m_PendingNodePositions.insert(id);
+        AddNode(std::move(new_node));
+        continue;
       }
-    }
-
-    int maxNodeId = 0;
-    int maxAttrId = 0;
-    for (auto &node : m_Nodes->Nodes) {
-      maxNodeId = std::max(maxNodeId, node->GetId());
 
-      for (auto &attr : node->GetAttributes()) {
-        maxAttrId = std::max(maxAttrId, attr.GetId());
+      // compare against the last committed state instead of dumping
+      // every live node
+      auto current = m_History.GetSnapshot(id);
+      if (current == nullptr)
+        current = History::CaptureNode(*node);
+
+      auto const title = node_data.value("title", node->GetTitle());
+      bool const impl_changed = !node_data["impl"].is_null() &&
+                                node_data["impl"] != current->at("impl");
+
+      if (impl_changed || title != current->at("title")) {
+        node->SetTitle(title);
+        if (impl_changed) {
+          node->Load(node_data["impl"]);
+          LoadGridPosition(id, node_data["impl"]);
+        }
+        CommitNodeEdit(id);
       }
-    }
 
-    for (auto &node : m_Nodes->Nodes) {
-      if (node->GetId() == -1) {
-        maxNodeId += 1;
-        node->SetId(maxNodeId);
+      if (pos.x != node->GetPosition().x || pos.y != node->GetPosition().y) {
+        node->SetPosition(pos);
+        m_PendingNodePositions.insert(id);
+        m_Changes.MarkNode(id);
       }
+    } catch (nlohmann::json::exception const &e) {
+      printf("Error reconciling node %d: %s\n", id, e.what());
     }
+  }
 
-    nodes::Node::SetIdCounter(maxNodeId + 1);
-    nodes::Attribute::SetIdCounter(maxAttrId + 1);
-    nodes::Link::SetIdCounter(maxLinkId + 1);
+  for (auto const &[id, link_data] : incoming_links) {
+    if (FindLink(id) != nullptr)
+      continue;
 
-    m_UpdateNodePositions = true;
-  } catch (nlohmann::json::exception const &e) {
-    printf("Error loading nodes: %s\n", e.what());
+    try {
+      CreateLink((*link_data)["from"].get<int>(), (*link_data)["to"].get<int>(),
+                 id);
+    } catch (nlohmann::json::exception const &e) {
+      printf("Error reconciling link %d: %s\n", id, e.what());
+    }
   }
+
+  m_Executor.EndBatch();
+  m_History.EndStep();
 }
 
 std::shared_ptr<nodes::Node> Editor::LoadNode(const nlohmann::json &data) {
   std::shared_ptr<nodes::Node> new_node = nullptr;
   try {
-    for (const auto &node_factory : api::GetNodeFactories()) {
-      if (data.contains("name") &&
-          data["name"].get<std::string>() == node_factory.Name) {
-        new_node = node_factory.Func();
+    auto const name = data.find("name");
+    if (name != data.end() && name->is_string()) {
+      auto const &type_name = name->get_ref<std::string const &>();
+      // the type registered last wins
+      auto const &factories = api::GetNodeFactories();
+      for (auto it = factories.rbegin(); it != factories.rend(); ++it) {
+        if (type_name == it->Name) {
+          new_node = m_Nodes->CreateNode(*it);
+          break;
+        }
       }
     }
 
-    if (data.contains("id"))
+    if (new_node == nullptr) {
+      printf("No node type registered for %s\n", data.dump().c_str());
+      return nullptr;
+    }
+
+    // saved ids win, anything the file does not cover gets a fresh one.
+    // The callers reserved every id of the document first, see
+    // NodeHolder::ReserveIds, so fresh ids never collide with saved ones
+    if (data.contains("id")) {
       new_node->SetId(data["id"].get<int>());
+      m_Nodes->NodeIds.Reserve(new_node->GetId());
+    } else {
+      new_node->SetId(m_Nodes->NodeIds.Allocate());
+    }
     if (data.contains("title"))
       new_node->SetTitle(data["title"].get<std::string>());
     uint32_t attrIndex = 0;
     for (auto &attr : new_node->GetAttributes()) {
-      if (attrIndex < data["attrs"].size())
+      if (attrIndex < data["attrs"].size()) {
         attr.SetId(data["attrs"][attrIndex]);
-      else
-        attr.SetId(-1);
+        m_Nodes->AttributeIds.Reserve(attr.GetId());
+      } else {
+        attr.SetId(m_Nodes->AttributeIds.Allocate());
+      }
 
       attrIndex++;
     }
 
-    if (!data["impl"].is_null())
+    if (!data["impl"].is_null()) {
       new_node->Load(data["impl"]);
+      LoadGridPosition(new_node->GetId(), data["impl"]);
+    }
 
   } catch (nlohmann::json::exception const &e) {
     printf("Failed to create a new node from json with %s\n", e.what());
@@ -189,33 +353,94 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
     return output;
   }
 
+  nlohmann::json Editor::DumpNodeEntry(nodes::Node *node) const {
+    auto output = DumpNode(node);
+    auto pos = node->GetPosition();
+
+    output["id"] = node->GetId();
+    output["pos"] = {{"x", pos.x}, {"y", pos.y}};
+    return output;
+  }
+
+  nlohmann::json Editor::DumpLinkEntry(nodes::Link const &link) const {
+    nlohmann::json output;
+
+    output["id"] = link.GetId();
+    output["from"] = link.GetFromId();
+    output["to"] = link.GetToId();
+    return output;
+  }
+
   nlohmann::json Editor::DumpNodes() const {
     nlohmann::json output;
 
     output["nodes"] = nlohmann::json::array();
     for (auto &node : m_Nodes->Nodes) {
-      auto id = node->GetId();
-      auto &currNodeOutput = output["nodes"].emplace_back();
-      auto pos = node->GetPosition();
-
-      currNodeOutput = DumpNode(node.get());
-      currNodeOutput["id"] = id;
-      currNodeOutput["pos"] = {{"x", pos.x}, {"y", pos.y}};
+      output["nodes"].push_back(DumpNodeEntry(node.get()));
     }
 
     output["links"] = nlohmann::json::array();
     for (auto &link : m_Links) {
-      auto id = link.GetId();
-      auto &currOutput = output["links"].emplace_back();
-
-      currOutput["id"] = id;
-      currOutput["from"] = link.GetFromId();
-      currOutput["to"] = link.GetToId();
+      output["links"].push_back(DumpLinkEntry(link));
     }
 
+    // every definition is saved once no matter how often it is used
+    std::map<std::string, std::shared_ptr<const nodes::SubgraphDefinition>>
+        definitions;
+    for (auto const &node : m_Nodes->Nodes)
+      CollectSubgraphs(*node, definitions);
+    for (auto const &[name, definition] : definitions)
+      output["subgraphs"][name] = definition->Dump();
+
     return output;
   }
 
+  nodes::Node *Editor::FindNode(int id) const {
+    for (auto const &node : m_Nodes->Nodes) {
+      if (node->GetId() == id)
+        return node.get();
+    }
+    return nullptr;
+  }
+
+  nodes::Link const *Editor::FindLink(int id) const {
+    for (auto const &link : m_Links) {
+      if (link.GetId() == id)
+        return &link;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<runtime::ExecutionPlan> Editor::CompilePlan() const {
+    std::vector<runtime::PlanLink> links;
+    for (auto const &link : m_Links) {
+      runtime::PlanLink plan_link{};
+      for (auto const &node : m_Nodes->Nodes) {
+        auto const &attributes = node->GetAttributes();
+        for (size_t i = 0; i < attributes.size(); i++) {
+          if (attributes[i].GetId() == link.GetFromId()) {
+            plan_link.FromNode = node;
+            plan_link.FromIndex = i;
+          } else if (attributes[i].GetId() == link.GetToId()) {
+            plan_link.ToNode = node;
+            plan_link.ToIndex = i;
+          }
+        }
+      }
+
+      if (plan_link.FromNode != nullptr && plan_link.ToNode != nullptr)
+        links.push_back(std::move(plan_link));
+    }
+
+    return runtime::CompilePlan(m_Nodes->Nodes, links);
+  }
+
+  GraphChanges Editor::TakeChanges() {
+    GraphChanges changes = std::move(m_Changes);
+    m_Changes = {};
+    return changes;
+  }
+
   void Editor::Render() {
     if (ImGui::BeginMenuBar()) {
       if (ImGui::BeginMenu("File")) {
@@ -229,9 +454,31 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
         }
         ImGui::EndMenu();
       }
+      if (ImGui::BeginMenu("Edit")) {
+        if (ImGui::MenuItem("Undo", "CTRL+Z", false, m_History.CanUndo()))
+          Undo();
+        if (ImGui::MenuItem("Redo", "CTRL+Y", false, m_History.CanRedo()))
+          Redo();
+        ImGui::EndMenu();
+      }
       ImGui::EndMenuBar();
     }
 
+    if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+        !ImGui::IsAnyItemActive()) {
+      if (ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Z))
+        Undo();
+      else if (ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Y) ||
+               ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiMod_Shift |
+                                        ImGuiKey_Z))
+        Redo();
+    }
+
+    // property edits reported by any of the views become undo steps
+    for (int id : m_Nodes->EditedNodes)
+      CommitNodeEdit(id);
+    m_Nodes->EditedNodes.clear();
+
     ImNodes::SetCurrentContext(m_Context.get());
 
     // adding nodes and such
@@ -248,7 +495,6 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
                                        m_NewDroppedNodeMousePos);
         m_NewDroppedNodeId = -1;
       }
-      bool const still_updating = m_UpdateNodePositions;
       if (m_Nodes) {
         for (auto &node : m_Nodes->Nodes) {
           node->CheckForErrors();
@@ -256,8 +502,9 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
 
           bool const has_error =
               node->GetState() != nodes::NodeState_OK ||
+              node->GetId() == m_OverrunNodeId ||
               (m_CurrNodeError.has_value() &&
-               m_CurrNodeError->NodePtr->GetId() == node->GetId());
+               m_CurrNodeError->NodePtr == node.get());
           if (has_error) {
             ImNodes::PushColorStyle(ImNodesCol_NodeOutline, 0xFF0000FF);
           }
@@ -268,6 +515,9 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
             ImNodes::PopColorStyle();
           }
         }
+        m_UpdateNodePositions = false;
+        m_PendingNodePositions.clear();
+
         // render links
         for (auto const &link : m_Links) {
           ImNodes::Link(link.GetId(), link.GetFromId(), link.GetToId());
@@ -280,28 +530,35 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
 
     if (ImGui::BeginDragDropTarget()) {
       if (ImGuiPayload const *payload =
-              ImGui::AcceptDragDropPayload("INPUT DATA SOURCE")) {
-        // TODO: generalize
-        // auto node =
-        //     std::make_unique<DataSourceNode>(dropped_channel.ChannelId,
-        //     GetTag());
-        // m_Nodes.push_back(std::move(node));
-        // m_NewDroppedNodeMousePos = ImGui::GetMousePos();
-        // m_NewDroppedNodeId = m_Nodes.back()->GetId();
+              ImGui::AcceptDragDropPayload(nodes::DataSourcePayload)) {
+        int const channel_id = *static_cast<int const *>(payload->Data);
+        if (auto channel = api::FindDataSource(channel_id)) {
+          auto node = m_Nodes->MakeNode<nodes::DataSourceNode>("Data Source");
+          m_Nodes->AssignIds(*node);
+          node->SetName("Data Source");
+          node->SetTitle(channel->GetName());
+          node->SetChannel(std::move(channel));
+          node->SetPosition(ImGui::GetMousePos());
+
+          m_NewDroppedNodeMousePos = ImGui::GetMousePos();
+          m_NewDroppedNodeId = node->GetId();
+          AddNode(std::move(node));
+        }
       }
       ImGui::EndDragDropTarget();
     }
 
-    int *num_selected_nodes = new int(ImNodes::NumSelectedNodes());
-    ImNodes::GetSelectedNodes(num_selected_nodes);
-    for (int i = 0; i < *num_selected_nodes; i++) {
-      auto node = ImNodes::ObjectPoolFind(ImNodes::EditorContextGet().Nodes,
-                                          num_selected_nodes[i]);
+    m_SelectedNodeIds.resize(
+        static_cast<size_t>(ImNodes::NumSelectedNodes()));
+    if (!m_SelectedNodeIds.empty())
+      ImNodes::GetSelectedNodes(m_SelectedNodeIds.data());
+    for (int const id : m_SelectedNodeIds) {
+      auto node =
+          ImNodes::ObjectPoolFind(ImNodes::EditorContextGet().Nodes, id);
       if (node >= 0) {
-        m_Nodes->SelectNode(num_selected_nodes[i]);
+        m_Nodes->SelectNode(id);
       }
     }
-    delete num_selected_nodes;
 
     {
       int linkId;
@@ -312,49 +569,8 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
     // Handle creation of new links
     {
       int from, to;
-      if (ImNodes::IsLinkCreated(&from, &to)) {
-
-        do {
-          nodes::Attribute *fromAttr = nullptr, *toAttr = nullptr;
-
-          // Find the attributes that are connected by the link
-          for (auto &node : m_Nodes->Nodes) {
-            for (auto &attribute : node->GetAttributes()) {
-              if (attribute.GetId() == from)
-                fromAttr = &attribute;
-              else if (attribute.GetId() == to)
-                toAttr = &attribute;
-            }
-          }
-
-          // If one of the attributes could not be found, the link is invalid
-          // and can't be created
-          if (fromAttr == nullptr || toAttr == nullptr)
-            break;
-
-          // If the attributes have different types, don't create the link
-          if (fromAttr->GetType() != toAttr->GetType())
-            break;
-
-          // If the link tries to connect two input or two output attributes,
-          // don't create the link
-          if (fromAttr->GetIo() == toAttr->GetIo())
-            break;
-
-          // If the link tries to connect to a input attribute that already has
-          // a link connected to it, don't create the link
-          if (!toAttr->GetConnectedAttributes().empty())
-            break;
-
-          // Add a new link to the current workspace
-          auto newLink = m_Links.emplace_back(from, to);
-
-          // Add the link to the attributes that are connected by it
-          fromAttr->AddConnectedAttribute(newLink.GetId(), toAttr);
-          toAttr->AddConnectedAttribute(newLink.GetId(), fromAttr);
-
-        } while (false);
-      }
+      if (ImNodes::IsLinkCreated(&from, &to))
+        CreateLink(from, to);
     }
 
     {
@@ -365,8 +581,12 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
         ImNodes::GetSelectedLinks(selectedLinks.data());
         ImNodes::ClearLinkSelection();
 
+        m_History.BeginStep();
+        m_Executor.BeginBatch();
         for (const int id : selectedLinks)
           EraseLink(id);
+        m_Executor.EndBatch();
+        m_History.EndStep();
       }
     }
 
@@ -383,17 +603,91 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
     }
 
     // processing
-    if (!m_thread.joinable()) {
+    UpdateProcessing();
+    if (!m_Executor.IsRunning()) {
       if (ImGui::Button(ICON_VS_DEBUG_START)) {
         ProcessNodes();
       }
     } else {
       if (ImGui::Button(ICON_VS_DEBUG_STOP)) {
-        m_continuousProcessing = false;
+        m_Executor.Stop();
       }
     }
     ImGui::SameLine();
-    ImGui::Checkbox("Continuous Processing", &m_continuousProcessing);
+    if (ImGui::Checkbox("Continuous Processing", &m_continuousProcessing))
+      m_Executor.SetContinuous(m_continuousProcessing);
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Fuse Math", &m_fuseExpressions))
+      m_Executor.SetFusion(m_fuseExpressions);
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Bytecode", &m_bytecodeBackend))
+      m_Executor.SetBytecode(m_bytecodeBackend);
+    if (utils::IsCountingAllocations()) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("%llu allocations per pass",
+                          static_cast<unsigned long long>(
+                              m_Executor.GetPassAllocations()));
+    }
+  }
+
+  bool Editor::CreateLink(int from, int to, int id) {
+    nodes::Attribute *fromAttr = nullptr, *toAttr = nullptr;
+    runtime::command::AddLink command{};
+
+    // Find the attributes that are connected by the link
+    for (auto &node : m_Nodes->Nodes) {
+      auto &attributes = node->GetAttributes();
+      for (size_t i = 0; i < attributes.size(); i++) {
+        if (attributes[i].GetId() == from) {
+          fromAttr = &attributes[i];
+          command.FromNode = node;
+          command.FromIndex = i;
+        } else if (attributes[i].GetId() == to) {
+          toAttr = &attributes[i];
+          command.ToNode = node;
+          command.ToIndex = i;
+        }
+      }
+    }
+
+    // If one of the attributes could not be found, the link is invalid
+    // and can't be created
+    if (fromAttr == nullptr || toAttr == nullptr)
+      return false;
+
+    // If the attributes have different types, don't create the link
+    if (fromAttr->GetType() != toAttr->GetType())
+      return false;
+
+    // If the link tries to connect two input or two output attributes,
+    // don't create the link
+    if (fromAttr->GetIo() == toAttr->GetIo())
+      return false;
+
+    // If the link tries to connect to a input attribute that already has
+    // a link connected to it, don't create the link
+    if (!toAttr->GetConnectedAttributes().empty())
+      return false;
+
+    // Add a new link to the current workspace
+    if (id > 0)
+      m_Nodes->LinkIds.Reserve(id);
+    else
+      id = m_Nodes->LinkIds.Allocate();
+    auto &newLink = m_Links.emplace_back(id, from, to);
+
+    // Add the link to the attributes that are connected by it
+    fromAttr->AddConnectedAttribute(newLink.GetId(), toAttr);
+    toAttr->AddConnectedAttribute(newLink.GetId(), fromAttr);
+
+    command.Id = newLink.GetId();
+    m_Executor.Submit(std::move(command));
+
+    if (!m_ApplyingHistory)
+      m_History.Record(history::AddLink{newLink.GetId(), from, to});
+    m_Changes.MarkLink(newLink.GetId());
+
+    return true;
   }
 
   void Editor::EraseLink(int id) {
@@ -408,15 +702,38 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
       for (auto &attribute : node->GetAttributes())
         attribute.RemoveConnectedAttribute(id);
     }
+
+    if (!m_ApplyingHistory) {
+      m_History.Record(
+          history::EraseLink{id, link->GetFromId(), link->GetToId()});
+    }
+    m_Executor.Submit(runtime::command::EraseLink{id});
+    m_Changes.EraseLink(id);
     m_Links.erase(link);
   }
 
+  void Editor::AddNode(std::shared_ptr<nodes::Node> node) {
+    m_Executor.Submit(runtime::command::AddNode{node});
+
+    if (!m_ApplyingHistory) {
+      m_History.SetSnapshot(node->GetId(), History::CaptureNode(*node));
+      m_History.Record(history::AddNode{node});
+    }
+    m_Changes.MarkNode(node->GetId());
+    m_Nodes->Nodes.push_back(std::move(node));
+  }
+
   void Editor::EraseNodes(std::vector<int> const &ids) {
+    m_History.BeginStep();
+    m_Executor.BeginBatch();
+
     // Loop over the IDs of all nodes that should be removed
     for (int id : ids) {
       auto node =
           std::find_if(m_Nodes->Nodes.begin(), m_Nodes->Nodes.end(),
                        [&id](auto const &node) { return node->GetId() == id; });
+      if (node == m_Nodes->Nodes.end())
+        continue;
 
       for (auto &attr : (*node)->GetAttributes()) {
         std::vector<int> links_to_remove;
@@ -433,43 +750,237 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
       auto node =
           std::find_if(m_Nodes->Nodes.begin(), m_Nodes->Nodes.end(),
                        [&id](auto const &node) { return node->GetId() == id; });
+      if (node == m_Nodes->Nodes.end())
+        continue;
 
-      std::erase_if(m_EndNodes,
-                    [&id](auto const &node) { return node->GetId() == id; });
-
+      m_Executor.Submit(runtime::command::EraseNode{id});
+      if (!m_ApplyingHistory)
+        m_History.Record(history::EraseNode{*node});
+      m_Changes.EraseNode(id);
       m_Nodes->Nodes.erase(node);
     }
+
+    m_Executor.EndBatch();
+    m_History.EndStep();
   }
 
-  void Editor::ProcessNodes() {
-    if (m_thread.joinable())
-      m_thread.join();
+  void Editor::GroupIntoSubgraph(std::vector<int> const &ids) {
+    std::set<int> const selected(ids.begin(), ids.end());
+
+    struct Endpoint {
+      nodes::Node *Node;
+      size_t Index;
+    };
+    std::map<int, Endpoint> attributes;
+    for (auto const &node : m_Nodes->Nodes) {
+      for (size_t i = 0; i < node->GetAttributes().size(); i++)
+        attributes[node->GetAttributes()[i].GetId()] = {node.get(), i};
+    }
 
-    m_thread = std::thread([this]() {
-      m_CurrNodeError = std::nullopt;
+    auto definition = std::make_shared<nodes::SubgraphDefinition>();
+    for (int n = 1; definition->Name.empty(); n++) {
+      auto name = "Subgraph " + std::to_string(n);
+      if (api::FindSubgraph(name) == nullptr)
+        definition->Name = std::move(name);
+    }
+
+    definition->Graph["nodes"] = nlohmann::json::array();
+    definition->Graph["links"] = nlohmann::json::array();
+    ImVec2 center(0.0F, 0.0F);
+    float count = 0.0F;
+    for (int id : selected) {
+      if (auto *node = FindNode(id)) {
+        definition->Graph["nodes"].push_back(DumpNodeEntry(node));
+        center.x += node->GetPosition().x;
+        center.y += node->GetPosition().y;
+        count += 1.0F;
+      }
+    }
+    if (count == 0.0F)
+      return;
 
-      do {
-        for (auto &endNode : m_EndNodes) {
-          endNode->ResetOutputValue();
+    // links crossing the selection become ports, one per inner attribute
+    struct Crossing {
+      int Outer;
+      int Inner;
+      bool InnerIsFrom;
+    };
+    std::vector<Crossing> crossings;
+    std::map<int, size_t> ports;
+    for (auto const &link : m_Links) {
+      auto from = attributes.find(link.GetFromId());
+      auto to = attributes.find(link.GetToId());
+      if (from == attributes.end() || to == attributes.end())
+        continue;
+
+      bool const from_inside = selected.contains(from->second.Node->GetId());
+      bool const to_inside = selected.contains(to->second.Node->GetId());
+      if (from_inside && to_inside) {
+        definition->Graph["links"].push_back(DumpLinkEntry(link));
+        continue;
+      }
+      if (!from_inside && !to_inside)
+        continue;
+
+      auto const &[inner_id, inner] = from_inside ? *from : *to;
+      if (ports.try_emplace(inner_id, definition->Ports.size()).second) {
+        auto const &attribute = inner.Node->GetAttributes()[inner.Index];
+        definition->Ports.push_back(
+            {inner.Node->GetTitle() + "." + attribute.GetName(),
+             inner.Node->GetId(), inner.Index});
+      }
+      crossings.push_back({from_inside ? link.GetToId() : link.GetFromId(),
+                           inner_id, from_inside});
+    }
 
-          for (auto &node : m_Nodes->Nodes) {
-            node->Reset();
-            node->ResetProcessedInputs();
-          }
+    api::RegisterSubgraph(definition);
+    m_Changes.MarkSubgraph(definition->Name);
 
-          endNode->Process();
-        }
-      } while (m_continuousProcessing);
+    std::shared_ptr<nodes::Node> node;
+    for (auto const &factory : api::GetNodeFactories()) {
+      if (factory.Name == definition->Name)
+        node = m_Nodes->CreateNode(factory);
+    }
+    if (node == nullptr)
+      return;
+
+    m_Nodes->AssignIds(*node);
+    node->SetPosition(ImVec2(center.x / count, center.y / count));
+    m_PendingNodePositions.insert(node->GetId());
+
+    m_History.BeginStep();
+    m_Executor.BeginBatch();
+
+    EraseNodes(std::vector<int>(selected.begin(), selected.end()));
+    AddNode(node);
+    for (auto const &crossing : crossings) {
+      int const port = node->GetAttributes()[ports[crossing.Inner]].GetId();
+      if (crossing.InnerIsFrom)
+        CreateLink(port, crossing.Outer);
+      else
+        CreateLink(crossing.Outer, port);
+    }
+
+    m_Executor.EndBatch();
+    m_History.EndStep();
+  }
+
+  void Editor::CommitNodeEdit(int id) {
+    auto node =
+        std::find_if(m_Nodes->Nodes.begin(), m_Nodes->Nodes.end(),
+                     [&id](auto const &node) { return node->GetId() == id; });
+    if (node == m_Nodes->Nodes.end())
+      return;
+
+    auto after = History::CaptureNode(**node);
+    auto before = m_History.GetSnapshot(id);
+    if (before == nullptr) {
+      m_History.SetSnapshot(id, std::move(after));
+      return;
+    }
+    if (*before == *after)
+      return;
+
+    m_History.Record(
+        history::ChangeProperties{id, std::move(before), std::move(after)});
+    m_Changes.MarkNode(id);
+  }
+
+  void Editor::Undo() {
+    if (!m_History.CanUndo())
+      return;
+
+    auto step = m_History.PopUndo();
+    m_ApplyingHistory = true;
+    m_Executor.BeginBatch();
+    for (auto it = step.Commands.rbegin(); it != step.Commands.rend(); ++it) {
+      std::visit(
+          [this](auto const &command) {
+            using T = std::decay_t<decltype(command)>;
+            if constexpr (std::is_same_v<T, history::AddNode>) {
+              EraseNodes({command.Node->GetId()});
+            } else if constexpr (std::is_same_v<T, history::EraseNode>) {
+              AddNode(command.Node);
+            } else if constexpr (std::is_same_v<T, history::AddLink>) {
+              EraseLink(command.Id);
+            } else if constexpr (std::is_same_v<T, history::EraseLink>) {
+              CreateLink(command.From, command.To, command.Id);
+            } else if constexpr (std::is_same_v<T,
+                                                history::ChangeProperties>) {
+              ApplyNodeSnapshot(command.NodeId, command.Before);
+            }
+          },
+          *it);
+    }
+    m_Executor.EndBatch();
+    m_ApplyingHistory = false;
+  }
+
+  void Editor::Redo() {
+    if (!m_History.CanRedo())
+      return;
+
+    auto step = m_History.PopRedo();
+    m_ApplyingHistory = true;
+    m_Executor.BeginBatch();
+    for (auto const &command : step.Commands) {
+      std::visit(
+          [this](auto const &command) {
+            using T = std::decay_t<decltype(command)>;
+            if constexpr (std::is_same_v<T, history::AddNode>) {
+              AddNode(command.Node);
+            } else if constexpr (std::is_same_v<T, history::EraseNode>) {
+              EraseNodes({command.Node->GetId()});
+            } else if constexpr (std::is_same_v<T, history::AddLink>) {
+              CreateLink(command.From, command.To, command.Id);
+            } else if constexpr (std::is_same_v<T, history::EraseLink>) {
+              EraseLink(command.Id);
+            } else if constexpr (std::is_same_v<T,
+                                                history::ChangeProperties>) {
+              ApplyNodeSnapshot(command.NodeId, command.After);
+            }
+          },
+          command);
+    }
+    m_Executor.EndBatch();
+    m_ApplyingHistory = false;
+  }
+
+  void Editor::ApplyNodeSnapshot(int id, NodeSnapshot const &snapshot) {
+    for (auto &node : m_Nodes->Nodes) {
+      if (node->GetId() != id)
+        continue;
+
+      History::RestoreNode(*node, *snapshot);
+      LoadGridPosition(id, snapshot->at("impl"));
+      m_History.SetSnapshot(id, snapshot);
+      m_Changes.MarkNode(id);
+      return;
+    }
+  }
 
-      m_thread.detach();
-    });
+  void Editor::ProcessNodes() {
+    m_CurrNodeError = std::nullopt;
+    m_Executor.Start(m_continuousProcessing);
+  }
+
+  void Editor::UpdateProcessing() {
+    bool const running = m_Executor.Poll();
+    if (auto error = m_Executor.TakeError())
+      m_CurrNodeError = std::move(error);
+
+    // the overrunning node is still inside Process() on the processing
+    // thread, so it is only marked here and never written to. The plan of
+    // the run keeps it alive until the run is joined
+    auto const *overrun = running ? m_Executor.GetOverrunNode() : nullptr;
+    m_OverrunNodeId = overrun != nullptr ? overrun->GetId() : -1;
   }
 
   void Editor::DrawNode(nodes::Node & node) {
 
     // If a Node position update is pending, update the Node position
     int const node_id = node.GetId();
-    if (m_UpdateNodePositions) {
+    if (m_UpdateNodePositions || m_PendingNodePositions.contains(node_id)) {
       ImNodes::SetNodeGridSpacePos(node_id, node.GetPosition());
     } else {
       if (ImNodes::ObjectPoolFind(ImNodes::EditorContextGet().Nodes, node_id) >=
@@ -483,8 +994,14 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
       ImNodes::BeginNodeTitleBar();
       ImGui::TextUnformatted(node.GetTitle().c_str());
       node.RenderErrors();
+      if (node_id == m_OverrunNodeId) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(ICON_VS_WATCH);
+        ImGui::SetItemTooltip("Not responding to cancellation");
+      }
       ImNodes::EndNodeTitleBar();
 
+      ImGui::BeginGroup();
       node.WrapDrawNode();
       ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(1.0F, 1.0F));
 
@@ -518,6 +1035,9 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
       }
 
       ImGui::PopStyleVar();
+      ImGui::EndGroup();
+      if (node.TakeEditCommitted() || ImGui::IsItemDeactivatedAfterEdit())
+        m_Nodes->MarkNodeEdited(node_id);
     }
 
     ImNodes::EndNode();
@@ -546,6 +1066,9 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
 
       if (ImNodes::NumSelectedNodes() > 0 || ImNodes::NumSelectedLinks() > 0) {
         if (ImGui::MenuItem("Remove Selection")) {
+          m_History.BeginStep();
+          m_Executor.BeginBatch();
+
           // delete nodes
           {
             std::vector<int> ids;
@@ -566,56 +1089,51 @@ nlohmann::json Editor::DumpNode(nodes::Node *node) const {
               EraseLink(id);
             ImNodes::ClearLinkSelection();
           }
+
+          m_Executor.EndBatch();
+          m_History.EndStep();
         }
       }
 
-      for (auto const &[cat, name, desc, function] : api::GetNodeFactories()) {
-        if (name.empty() && desc.empty()) {
+      if (ImNodes::NumSelectedNodes() > 0) {
+        if (ImGui::MenuItem("Group Into Subgraph")) {
+          std::vector<int> ids;
+          ids.resize(ImNodes::NumSelectedNodes());
+          ImNodes::GetSelectedNodes(ids.data());
+          ImNodes::ClearNodeSelection();
+
+          GroupIntoSubgraph(ids);
+        }
+      }
+
+      for (auto const &factory : api::GetNodeFactories()) {
+        auto const &cat = factory.Cat;
+        auto const &name = factory.Name;
+        if (name.empty() && factory.Description.empty()) {
           ImGui::Separator();
         } else if (cat.empty()) {
           if (ImGui::MenuItem(name.c_str())) {
-            node = function();
-          }
-          if (!desc.empty() && ImGui::BeginItemTooltip()) {
-            ImGui::Text("%s", desc.c_str());
-            ImGui::EndTooltip();
+            node = m_Nodes->CreateNode(factory);
           }
+          FactoryTooltip(factory);
         } else {
           if (ImGui::BeginMenu(cat.c_str())) {
             if (ImGui::MenuItem(name.c_str())) {
-              node = function();
-            }
-            if (!desc.empty() && ImGui::BeginItemTooltip()) {
-              ImGui::Text("%s", desc.c_str());
-              ImGui::EndTooltip();
+              node = m_Nodes->CreateNode(factory);
             }
+            FactoryTooltip(factory);
             ImGui::EndMenu();
           }
         }
       }
 
       if (node != nullptr) {
-        bool has_output = false;
-        bool has_input = false;
-        for (auto &attr : node->GetAttributes()) {
-          switch (attr.GetIo()) {
-          case nodes::Attribute::IO::In:
-            has_input = true;
-            break;
-          case nodes::Attribute::IO::Out:
-            has_output = true;
-            break;
-          }
-        }
-
-        if (has_input && !has_output) {
-          m_EndNodes.push_back(node.get());
-        }
-        ImNodes::SetNodeScreenSpacePos(node->GetId(), m_RightClickedCoords);
-        node->SetPosition(m_RightClickedCoords);
         if (!m_Nodes)
           throw std::runtime_error("Nodes is null!");
-        m_Nodes->Nodes.push_back(node);
+        m_Nodes->AssignIds(*node);
+        ImNodes::SetNodeScreenSpacePos(node->GetId(), m_RightClickedCoords);
+        node->SetPosition(m_RightClickedCoords);
+        AddNode(node);
       }
 
       ImGui::EndPopup();
@@ -0,0 +1,143 @@
+#include <dynamic_editor/views/history.hpp>
+
+#include <utility>
+
+namespace dynamic_editor::views {
+
+static auto ValueToJson(nodes::Attribute::ValueType const &value)
+    -> nlohmann::json {
+  return std::visit(
+      [](auto const &v) -> nlohmann::json {
+        using T = std::decay_t<decltype(v)>;
+        // buffers are produced while processing, there is nothing to save
+        if constexpr (std::is_same_v<T, std::monostate> ||
+                      std::is_same_v<T, nodes::Attribute::Buffer>) {
+          return nullptr;
+        } else {
+          return v;
+        }
+      },
+      value);
+}
+
+static auto ValueFromJson(nlohmann::json const &data,
+                          nodes::Attribute::Type type)
+    -> nodes::Attribute::ValueType {
+  if (data.is_null())
+    return std::monostate{};
+
+  switch (type) {
+  case nodes::Attribute::Type::Float:
+    return data.get<float>();
+  case nodes::Attribute::Type::Boolean:
+    return data.get<bool>();
+  case nodes::Attribute::Type::Int:
+    return data.get<int>();
+  default:
+    return std::monostate{};
+  }
+}
+
+void History::BeginStep() { m_StepDepth++; }
+
+void History::EndStep() {
+  if (m_StepDepth == 0)
+    return;
+
+  m_StepDepth--;
+  if (m_StepDepth == 0 && !m_CurrentStep.Commands.empty()) {
+    PushUndo(std::move(m_CurrentStep));
+    m_CurrentStep = {};
+  }
+}
+
+void History::Record(HistoryCommand command) {
+  if (auto const *change = std::get_if<history::ChangeProperties>(&command))
+    m_Snapshots[change->NodeId] = change->After;
+
+  if (m_StepDepth > 0) {
+    m_CurrentStep.Commands.push_back(std::move(command));
+    return;
+  }
+
+  HistoryStep step;
+  step.Commands.push_back(std::move(command));
+  PushUndo(std::move(step));
+}
+
+void History::PushUndo(HistoryStep step) {
+  m_RedoSteps.clear();
+  m_UndoSteps.push_back(std::move(step));
+  while (m_UndoSteps.size() > m_MaxSteps)
+    m_UndoSteps.pop_front();
+}
+
+auto History::PopUndo() -> HistoryStep {
+  HistoryStep step = std::move(m_UndoSteps.back());
+  m_UndoSteps.pop_back();
+  m_RedoSteps.push_back(step);
+  return step;
+}
+
+auto History::PopRedo() -> HistoryStep {
+  HistoryStep step = std::move(m_RedoSteps.back());
+  m_RedoSteps.pop_back();
+  m_UndoSteps.push_back(step);
+  return step;
+}
+
+void History::Clear() {
+  m_UndoSteps.clear();
+  m_RedoSteps.clear();
+  m_CurrentStep = {};
+  m_StepDepth = 0;
+  m_Snapshots.clear();
+}
+
+void History::SetMaxSteps(size_t max_steps) {
+  m_MaxSteps = max_steps;
+  while (m_UndoSteps.size() > m_MaxSteps)
+    m_UndoSteps.pop_front();
+}
+
+auto History::GetSnapshot(int node_id) const -> NodeSnapshot {
+  auto it = m_Snapshots.find(node_id);
+  if (it == m_Snapshots.end())
+    return nullptr;
+  return it->second;
+}
+
+void History::SetSnapshot(int node_id, NodeSnapshot snapshot) {
+  m_Snapshots[node_id] = std::move(snapshot);
+}
+
+void History::EraseSnapshot(int node_id) { m_Snapshots.erase(node_id); }
+
+auto History::CaptureNode(nodes::Node const &node) -> NodeSnapshot {
+  auto state = std::make_shared<nlohmann::json>();
+  (*state)["title"] = node.GetTitle();
+
+  nlohmann::json impl;
+  node.Dump(impl);
+  (*state)["impl"] = std::move(impl);
+
+  auto &defaults = (*state)["defaults"] = nlohmann::json::array();
+  for (auto const &attr : node.GetAttributes())
+    defaults.push_back(ValueToJson(attr.GetDefaultValue()));
+
+  return state;
+}
+
+void History::RestoreNode(nodes::Node &node, nlohmann::json const &state) {
+  node.SetTitle(state.at("title").get<std::string>());
+  node.Load(state.at("impl"));
+
+  auto const &defaults = state.at("defaults");
+  auto &attributes = node.GetAttributes();
+  for (size_t i = 0; i < attributes.size() && i < defaults.size(); i++) {
+    attributes[i].SetDefaultValue(
+        ValueFromJson(defaults[i], attributes[i].GetType()));
+  }
+}
+
+} // namespace dynamic_editor::views
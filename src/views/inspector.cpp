@@ -1,3 +1,5 @@
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/nodes/data_source.hpp>
 #include <dynamic_editor/utils/imgui_extras.hpp>
 #include <dynamic_editor/views/inspector.hpp>
 
@@ -11,7 +13,32 @@ void Inspector::Render() {
     return;
 
   for (auto &node : m_Nodes->SelectedNodes) {
+    ImGui::BeginGroup();
     node->DrawProperties();
+    ImGui::EndGroup();
+    if (node->TakeEditCommitted() || ImGui::IsItemDeactivatedAfterEdit())
+      m_Nodes->MarkNodeEdited(node->GetId());
+  }
+}
+
+void Inspector::RenderDataSources() {
+  auto const channels_snapshot = api::GetDataSources();
+  auto const &channels = *channels_snapshot;
+  if (channels.empty())
+    return;
+
+  if (!ImGui::CollapsingHeader("Data Sources"))
+    return;
+
+  for (auto const &channel : channels) {
+    ImGui::Selectable(channel->GetName().c_str());
+    if (ImGui::BeginDragDropSource()) {
+      int const channel_id = channel->GetId();
+      ImGui::SetDragDropPayload(nodes::DataSourcePayload, &channel_id,
+                                sizeof(channel_id));
+      ImGui::Text("%s", channel->GetName().c_str());
+      ImGui::EndDragDropSource();
+    }
   }
 }
 
@@ -20,6 +47,7 @@ void Inspector::RenderWindowed(bool &show) {
     return;
   if (ImGui::Begin("Dynamic Editor Inspector", &show)) {
     ImGui::Text("Inspector");
+    RenderDataSources();
     Render();
   }
   ImGui::End();
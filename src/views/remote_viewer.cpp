@@ -0,0 +1,129 @@
+#include <dynamic_editor/nodes/attribute.hpp>
+#include <dynamic_editor/views/remote_viewer.hpp>
+
+#include <cfloat>
+#include <cstdio>
+#include <utility>
+
+#include "imgui.h"
+
+namespace dynamic_editor::views {
+
+namespace {
+
+// how often a missing or silent segment is opened again
+constexpr auto ReconnectInterval = std::chrono::seconds(1);
+
+} // namespace
+
+void RemoteViewer::Update() {
+  auto const now = std::chrono::steady_clock::now();
+  // a restarted engine publishes into a new segment of the same name, which
+  // is only seen by opening the name again
+  bool const stale = !IsConnected() || now - m_LastChange > ReconnectInterval;
+  if (stale && now - m_LastConnect > ReconnectInterval) {
+    m_LastConnect = now;
+    if (auto reader = runtime::SnapshotReader::Open(m_Name))
+      m_Reader = std::move(reader);
+  }
+
+  if (m_Reader == nullptr || !m_Reader->Read(m_Scratch))
+    return;
+  if (!m_HasSnapshot ||
+      m_Scratch.Info.PublishedAt != m_Snapshot.Info.PublishedAt)
+    m_LastChange = now;
+  std::swap(m_Snapshot, m_Scratch);
+  m_HasSnapshot = true;
+}
+
+void RemoteViewer::RenderValue(runtime::SnapshotValue const &value) {
+  if (value.HasValue == 0) {
+    ImGui::TextDisabled("-");
+    return;
+  }
+
+  switch (static_cast<nodes::Attribute::Type>(value.Type)) {
+  case nodes::Attribute::Type::Float:
+    ImGui::Text("%g", value.Scalar);
+    break;
+  case nodes::Attribute::Type::Boolean:
+    ImGui::Text("%s", value.Scalar != 0.0 ? "true" : "false");
+    break;
+  case nodes::Attribute::Type::Int:
+    ImGui::Text("%lld", static_cast<long long>(value.Scalar));
+    break;
+  case nodes::Attribute::Type::Buffer: {
+    char overlay[48];
+    snprintf(overlay, sizeof(overlay), "%llu samples",
+             static_cast<unsigned long long>(value.BufferSize));
+    ImGui::PlotLines("##samples", m_Snapshot.Samples.data() + value.FirstSample,
+                     static_cast<int>(value.SampleCount), 0, overlay, FLT_MAX,
+                     FLT_MAX, ImVec2(-1.0f, 60.0f));
+    break;
+  }
+  }
+}
+
+void RemoteViewer::Render() {
+  Update();
+  if (!m_HasSnapshot) {
+    ImGui::TextDisabled("Waiting for %s", m_Name.c_str());
+    return;
+  }
+
+  auto const &info = m_Snapshot.Info;
+  auto const now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  ImGui::Text("%s, pass %llu", IsConnected() ? "Connected" : "Disconnected",
+              static_cast<unsigned long long>(info.Pass));
+  ImGui::SameLine();
+  ImGui::TextDisabled("%.0f ms ago",
+                      static_cast<double>(now - info.PublishedAt) * 1e-6);
+  if (info.Truncated != 0) {
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1, 1, 0, 1), "Truncated");
+    if (ImGui::IsItemHovered())
+      ImGui::SetTooltip("The graph does not fit the capacities of %s",
+                        m_Name.c_str());
+  }
+
+  for (auto const &node : m_Snapshot.Nodes) {
+    ImGui::PushID(node.Id);
+    if (ImGui::CollapsingHeader(node.Title, ImGuiTreeNodeFlags_DefaultOpen)) {
+      if (node.ErrorCount != 0 || node.WarningCount != 0) {
+        ImGui::TextColored(ImVec4(1, 0, 0, 1), "%llu errors, %llu warnings",
+                           static_cast<unsigned long long>(node.ErrorCount),
+                           static_cast<unsigned long long>(node.WarningCount));
+      }
+
+      if (node.ValueCount > 0 &&
+          ImGui::BeginTable("outputs", 2, ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("name", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("value", ImGuiTableColumnFlags_WidthStretch);
+        for (uint32_t i = 0; i < node.ValueCount; i++) {
+          auto const &value = m_Snapshot.Values[node.FirstValue + i];
+          ImGui::PushID(value.AttributeId);
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("%s", value.Name);
+          ImGui::TableNextColumn();
+          RenderValue(value);
+          ImGui::PopID();
+        }
+        ImGui::EndTable();
+      }
+    }
+    ImGui::PopID();
+  }
+}
+
+void RemoteViewer::RenderWindowed(bool &show) {
+  if (!show)
+    return;
+  if (ImGui::Begin("Dynamic Editor Remote Viewer", &show))
+    Render();
+  ImGui::End();
+}
+
+} // namespace dynamic_editor::views
@@ -18,8 +18,13 @@ void Viewer::Render() {
         ImGrid::EndEntryTitleBar();
       }
 
-      if (!node->GetHasError())
+      if (!node->GetHasError()) {
+        ImGui::BeginGroup();
         node->DrawViewerNodeContent();
+        ImGui::EndGroup();
+        if (node->TakeEditCommitted() || ImGui::IsItemDeactivatedAfterEdit())
+          m_Nodes->MarkNodeEdited(node->GetId());
+      }
     }
     ImGrid::EndEntry();
 
@@ -0,0 +1,170 @@
+// Runs the same graph node by node, fused, as bytecode and instanced, and
+// checks that every backend publishes the same value for every output. The
+// chain starts at a constant, so every run folds it, and between two passes
+// both a default the constant reads and a property compiled into the
+// expressions are edited.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/runtime/instancing.hpp>
+
+#include "imgrid.h"
+#include "imgui.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr size_t Instances = 8;
+
+// a constant sum through a limit, which is not pure, into two gains. The
+// first gain is only read by the second, so fusion inlines it and the
+// square of the second reads it twice. Every value is exact in a float
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Sum", "attrs": [10, 11, 12], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Limit", "attrs": [20, 21], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 100}},
+    {"id": 3, "name": "Gain", "attrs": [30, 31, 32], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "gain": 1.5}},
+    {"id": 4, "name": "Gain", "attrs": [40, 41, 42], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "gain": 0.5}},
+    {"id": 5, "name": "Probe", "attrs": [50], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 12, "to": 20},
+    {"id": 101, "from": 21, "to": 30},
+    {"id": 102, "from": 31, "to": 40},
+    {"id": 103, "from": 41, "to": 50}
+  ]
+})";
+
+using Outputs = std::map<int, nodes::Attribute::ValueType>;
+
+// one copy of the graph run by one backend of the executor
+struct Graph {
+  nodes::NodeHolder Nodes;
+  runtime::Executor Executor;
+
+  explicit Graph(runtime::PlanOptions options) {
+    api::LoadGraph(nlohmann::json::parse(s_graph), Nodes, Executor);
+    Executor.SetFusion(options.Fuse);
+    Executor.SetBytecode(options.Bytecode);
+    SetInputs(2.0F, 3.0F);
+  }
+
+  void SetInputs(float a, float b) {
+    auto &attributes = Nodes.Nodes[0]->GetAttributes();
+    attributes[0].SetDefaultValue(a);
+    attributes[1].SetDefaultValue(b);
+  }
+
+  // recompiles the expressions of the second gain and refolds the sum
+  void Edit() {
+    SetInputs(4.0F, 3.0F);
+    static_cast<tests::GainNode &>(*Nodes.Nodes[3]).SetGain(2.0F);
+  }
+
+  auto Run() -> bool { return !Executor.RunOnce().has_value(); }
+
+  [[nodiscard]] auto GetPublished() const -> Outputs {
+    Outputs outputs;
+    for (auto const &node : Nodes.Nodes) {
+      for (auto const &attribute : node->GetAttributes()) {
+        if (attribute.GetIo() == nodes::Attribute::IO::Out)
+          outputs[attribute.GetId()] = attribute.GetPublishedValue();
+      }
+    }
+    return outputs;
+  }
+};
+
+void CheckSame(Outputs const &expected, Outputs const &actual,
+               char const *backend) {
+  for (auto const &[id, value] : expected) {
+    auto it = actual.find(id);
+    if (it == actual.end() || it->second != value) {
+      printf("%s: output %d differs\n", backend, id);
+      tests::Check(false, "every backend publishes the same outputs");
+    }
+  }
+}
+
+// every instance of the plan of the reference graph, which has the same
+// inputs, computes what the reference published
+void CheckInstanced(Graph &reference, Outputs const &expected) {
+  runtime::InstancedGraph instanced(reference.Executor.GetPlan(), Instances,
+                                    2);
+  if (!tests::Check(!instanced.Run().has_value(), "the instances run"))
+    return;
+
+  for (size_t i = 0; i < Instances; i++) {
+    Outputs outputs;
+    for (auto const &[id, value] : expected)
+      outputs[id] = instanced.GetValue(i, id);
+    CheckSame(expected, outputs, "instanced");
+  }
+}
+
+} // namespace
+
+int main() {
+  tests::RegisterTestNodes();
+  // instancing clones nodes by dumping them, which reads their grid entry
+  ImGui::CreateContext();
+  ImGrid::CreateContext();
+
+  Graph reference({});
+  Graph fused({.Fuse = true});
+  Graph bytecode({.Bytecode = true});
+  Graph *compiled[] = {&fused, &bytecode};
+  char const *names[] = {"fused", "bytecode"};
+
+  for (int pass = 0; pass < 2; pass++) {
+    if (pass == 1) {
+      reference.Edit();
+      for (auto *graph : compiled)
+        graph->Edit();
+    }
+
+    tests::Check(reference.Run(), "the reference pass succeeds");
+    auto const expected = reference.GetPublished();
+    for (size_t i = 0; i < 2; i++) {
+      tests::Check(compiled[i]->Run(), "the compiled pass succeeds");
+      CheckSame(expected, compiled[i]->GetPublished(), names[i]);
+    }
+    CheckInstanced(reference, expected);
+
+    // (a + b) limited, times 1.5, times 0.5 or 2 after the edit
+    auto const &probe =
+        static_cast<tests::ProbeNode const &>(*reference.Nodes.Nodes[4]);
+    tests::Check(probe.GetValue() == (pass == 0 ? 3.75F : 21.0F),
+                 "the reference computes the chain");
+  }
+
+  // what the backends were meant to cover
+  auto const fused_plan = fused.Executor.GetPlan();
+  tests::Check(fused_plan->Kernels.size() == 1 &&
+                   fused_plan->Kernels.front()->Nodes.size() == 2,
+               "both gains are fused into one kernel");
+  tests::Check(bytecode.Executor.GetPlan()->Program != nullptr,
+               "the bytecode plan has a program");
+  tests::Check(reference.Executor.GetPlan()->Constants.size() == 1,
+               "the sum is folded");
+
+  ImGui::DestroyContext();
+  return tests::Finish();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdio>
+#include <source_location>
+
+namespace dynamic_editor::tests {
+
+// Every test is a plain executable, ctest only looks at its exit code. A
+// failed check is reported and the test keeps going, so one run shows every
+// failure.
+inline int s_failures = 0;
+
+inline auto Check(bool condition, char const *what,
+                  std::source_location location =
+                      std::source_location::current()) -> bool {
+  if (!condition) {
+    printf("%s:%u: check failed: %s\n", location.file_name(),
+           static_cast<unsigned>(location.line()), what);
+    s_failures++;
+  }
+  return condition;
+}
+
+// exit code of the test
+inline auto Finish() -> int {
+  if (s_failures > 0) {
+    printf("%d checks failed\n", s_failures);
+    return 1;
+  }
+  printf("All checks passed\n");
+  return 0;
+}
+
+} // namespace dynamic_editor::tests
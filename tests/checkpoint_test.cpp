@@ -0,0 +1,135 @@
+// Checkpoints an integrator after a few passes, reads the checkpoint back
+// and restores it into a second copy of the graph, both directly and
+// through a Checkpointer. A corrupted or cut off checkpoint is rejected.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/checkpoint.hpp>
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr int Passes = 10;
+constexpr float Step = 1.5F;
+
+// the sum is stateless and left out of checkpoints
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Integrator", "attrs": [10, 11], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Sum", "attrs": [20, 21, 22], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 3, "name": "Probe", "attrs": [30], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 11, "to": 20},
+    {"id": 101, "from": 22, "to": 30}
+  ]
+})";
+
+// one copy of the graph, integrating Step every pass
+struct Graph {
+  nodes::NodeHolder Nodes;
+  runtime::Executor Executor;
+
+  Graph() {
+    api::LoadGraph(nlohmann::json::parse(s_graph), Nodes, Executor);
+    Nodes.Nodes[0]->GetAttributes()[0].SetDefaultValue(Step);
+  }
+
+  auto Run() -> bool { return !Executor.RunOnce().has_value(); }
+  [[nodiscard]] auto GetProbe() const -> float {
+    return static_cast<tests::ProbeNode const &>(*Nodes.Nodes[2]).GetValue();
+  }
+};
+
+void WriteFile(std::filesystem::path const &path,
+               std::vector<uint8_t> const &data) {
+  std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  file.write(reinterpret_cast<char const *>(data.data()),
+             static_cast<std::streamsize>(data.size()));
+}
+
+} // namespace
+
+int main() {
+  tests::RegisterTestNodes();
+  auto const path =
+      std::filesystem::temp_directory_path() / "dynamic_editor_checkpoint_test";
+
+  std::vector<uint8_t> data;
+  {
+    Graph original;
+    for (int i = 0; i < Passes; i++)
+      tests::Check(original.Run(), "passes succeed");
+    tests::Check(original.GetProbe() == Passes * Step, "the graph integrates");
+
+    // RunOnce processes on this thread, so it is between passes here
+    auto const plan = original.Executor.GetPlan();
+    if (!tests::Check(plan != nullptr, "the graph compiled"))
+      return tests::Finish();
+    api::WriteCheckpoint(*plan, Passes, data);
+  }
+  WriteFile(path, data);
+
+  auto const checkpoint = api::ReadCheckpoint(path);
+  if (tests::Check(checkpoint.has_value(), "the checkpoint reads back")) {
+    tests::Check(checkpoint->Pass == Passes, "the pass count is kept");
+    tests::Check(checkpoint->Entries.size() == 1,
+                 "only stateful nodes are saved");
+    tests::Check(!checkpoint->Entries.empty() &&
+                     checkpoint->Entries[0].Path == std::vector<int>{1} &&
+                     checkpoint->Entries[0].Name == "Integrator",
+                 "entries name the node they belong to");
+
+    Graph restored;
+    tests::Check(restored.Run(), "the restored graph runs");
+    auto const plan = restored.Executor.GetPlan();
+    tests::Check(api::RestoreCheckpoint(*checkpoint, *plan) == 1,
+                 "the integrator takes its state");
+    tests::Check(restored.Run(), "the restored graph runs on");
+    tests::Check(restored.GetProbe() == (Passes + 1) * Step,
+                 "integrating goes on from the checkpoint");
+  }
+
+  {
+    // restored into the first pass, before the node processes
+    Graph restored;
+    restored.Executor.Submit(
+        runtime::command::AddObserver{std::make_shared<api::Checkpointer>(
+            path, std::chrono::hours(1), true)});
+    tests::Check(restored.Run(), "the restored graph runs");
+    tests::Check(restored.GetProbe() == (Passes + 1) * Step,
+                 "a Checkpointer restores at startup");
+  }
+
+  // a flipped bit anywhere breaks the CRC
+  auto corrupted = data;
+  corrupted[corrupted.size() / 2] ^= 0x10;
+  WriteFile(path, corrupted);
+  tests::Check(!api::ReadCheckpoint(path).has_value(),
+               "a corrupted checkpoint is rejected");
+
+  WriteFile(path, std::vector<uint8_t>(data.begin(), data.begin() + 3));
+  tests::Check(!api::ReadCheckpoint(path).has_value(),
+               "a cut off checkpoint is rejected");
+
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  return tests::Finish();
+}
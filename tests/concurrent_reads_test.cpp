@@ -0,0 +1,123 @@
+// Processes a chain of buffer nodes continuously while the main thread
+// checks the nodes for errors and reads their inputs and published outputs,
+// the way the editor does every frame. Every buffer a pass writes holds a
+// single value, so a buffer written while it is read shows mixed values.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <variant>
+
+#include <nlohmann/json.hpp>
+
+// the widget nodes are linked into the library, this pulls them in
+extern "C" void EnsureAutoRegisterWidgets();
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr uint64_t MinPasses = 500;
+
+// the largest element of |fill| clamped, then capped by a limit
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Fill", "attrs": [10], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Buffer Abs", "attrs": [20, 21], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 3, "name": "Buffer Clamp", "attrs": [30, 31, 32, 33], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 4, "name": "Buffer Reduce", "attrs": [40, 41], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "mode": 2}},
+    {"id": 5, "name": "Limit", "attrs": [50, 51], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 1e9}},
+    {"id": 6, "name": "Probe", "attrs": [60], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 10, "to": 20},
+    {"id": 101, "from": 21, "to": 30},
+    {"id": 102, "from": 33, "to": 40},
+    {"id": 103, "from": 41, "to": 50},
+    {"id": 104, "from": 51, "to": 60}
+  ]
+})";
+
+auto IsUniform(nodes::Attribute::ValueType const &value) -> bool {
+  auto const *buffer = std::get_if<nodes::Attribute::Buffer>(&value);
+  if (buffer == nullptr || *buffer == nullptr || (*buffer)->empty())
+    return true;
+  auto const &values = **buffer;
+  return std::all_of(values.begin(), values.end(),
+                     [first = values.front()](float v) { return v == first; });
+}
+
+// what the editor reads of the graph in a frame, false on a torn buffer
+auto ReadGraph(nodes::NodeHolder &graph) -> bool {
+  bool uniform = true;
+  for (auto const &node : graph.Nodes) {
+    node->CheckForErrors();
+    node->ClearError();
+    node->ClearWarning();
+
+    auto &attributes = node->GetAttributes();
+    for (size_t i = 0; i < attributes.size(); i++) {
+      if (attributes[i].GetIo() == nodes::Attribute::IO::In)
+        uniform &= IsUniform(node->GetValueOnInput(i));
+      else
+        uniform &= IsUniform(attributes[i].GetPublishedValue());
+    }
+  }
+  return uniform;
+}
+
+} // namespace
+
+int main() {
+  tests::RegisterTestNodes();
+  EnsureAutoRegisterWidgets();
+
+  nodes::NodeHolder graph;
+  runtime::Executor executor;
+  if (!tests::Check(api::LoadGraph(nlohmann::json::parse(s_graph), graph,
+                                   executor),
+                    "the graph loads"))
+    return tests::Finish();
+  // clamped to [0, 1e9], so the clamp passes every value through
+  graph.Nodes[2]->GetAttributes()[2].SetDefaultValue(1e9F);
+
+  executor.Start(true);
+  auto const &passes = executor.GetMetrics().Passes;
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  bool uniform = true;
+  int frames = 0;
+  while ((passes.load(std::memory_order_relaxed) < MinPasses ||
+          frames < 100) &&
+         std::chrono::steady_clock::now() < deadline) {
+    uniform &= ReadGraph(graph);
+    frames++;
+  }
+  executor.Stop();
+  while (executor.Poll())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  tests::Check(passes.load(std::memory_order_relaxed) >= MinPasses,
+               "the executor kept processing");
+  tests::Check(uniform, "no buffer is read while it is written");
+  tests::Check(!executor.TakeError().has_value(), "the passes succeed");
+  auto const &probe = static_cast<tests::ProbeNode const &>(*graph.Nodes[5]);
+  tests::Check(probe.GetValue() >= static_cast<float>(MinPasses),
+               "the chain computes the pass count");
+  return tests::Finish();
+}
@@ -0,0 +1,109 @@
+// Renders the editor, the viewer and the inspector of a graph that does not
+// change in a headless ImGui context. Once the first frames created what
+// ImGui and the views keep around, a frame must not allocate any more. Only
+// built with IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/utils/allocation_counter.hpp>
+
+#include "imgrid.h"
+#include "imgui.h"
+#include "imnodes.h"
+#include "implot.h"
+
+#include <cstdio>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr int WarmUpFrames = 10;
+constexpr int MeasuredFrames = 20;
+
+// a chain ending in a probe whose limit warns, and a node on its own that
+// errors, every one of them shown in the viewer
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Sum", "title": "Sum", "attrs": [10, 11, 12],
+     "pos": {"x": 0, "y": 0},
+     "impl": {"shouldRenderViewer": true, "showTitleBar": true,
+              "grid": {"x": 0, "y": 0, "w": 2, "h": 1}}},
+    {"id": 2, "name": "Limit", "title": "Warning", "attrs": [20, 21],
+     "pos": {"x": 200, "y": 0},
+     "impl": {"shouldRenderViewer": true, "showTitleBar": true,
+              "limit": 0.0, "grid": {"x": 2, "y": 0, "w": 2, "h": 1}}},
+    {"id": 3, "name": "Probe", "title": "Probe", "attrs": [30],
+     "pos": {"x": 400, "y": 0},
+     "impl": {"shouldRenderViewer": true, "showTitleBar": true,
+              "grid": {"x": 4, "y": 0, "w": 2, "h": 1}}},
+    {"id": 4, "name": "Limit", "title": "Error", "attrs": [40, 41],
+     "pos": {"x": 0, "y": 200},
+     "impl": {"shouldRenderViewer": true, "showTitleBar": true,
+              "limit": -1.0, "grid": {"x": 0, "y": 1, "w": 2, "h": 1}}}
+  ],
+  "links": [
+    {"id": 100, "from": 12, "to": 20},
+    {"id": 101, "from": 21, "to": 30}
+  ]
+})";
+
+void RenderFrame(api::DynamicEditor &editor) {
+  ImGui::NewFrame();
+  editor.RenderWindowed();
+  ImGui::Render();
+}
+
+} // namespace
+
+int main() {
+  if (!tests::Check(utils::IsCountingAllocations(),
+                    "built with IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS"))
+    return tests::Finish();
+
+  ImGui::CreateContext();
+  ImPlot::CreateContext();
+  ImGrid::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+  io.DisplaySize = ImVec2(1280.0F, 720.0F);
+  io.DeltaTime = 1.0F / 60.0F;
+  io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+  // nothing is drawn, but the font atlas has to exist for a frame
+  unsigned char *pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+  tests::RegisterTestNodes();
+  {
+    api::DynamicEditor editor;
+    editor.LoadState(nlohmann::json::parse(s_graph));
+
+    // the inspector only shows what is selected in the node editor, whose
+    // context stays current after the first frame
+    RenderFrame(editor);
+    for (int const id : {1, 2, 3, 4})
+      ImNodes::SelectNode(id);
+
+    for (int i = 0; i < WarmUpFrames; i++)
+      RenderFrame(editor);
+
+    for (int i = 0; i < MeasuredFrames; i++) {
+      RenderFrame(editor);
+      if (editor.GetFrameAllocations() != 0) {
+        printf("frame %d allocated %llu times\n", i,
+               static_cast<unsigned long long>(editor.GetFrameAllocations()));
+        tests::Check(false, "a steady frame does not allocate");
+        break;
+      }
+    }
+  }
+
+  ImGui::DestroyContext();
+  return tests::Finish();
+}
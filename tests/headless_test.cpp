@@ -0,0 +1,87 @@
+// Runs a HeadlessEngine without any ImGui context and reads its outputs
+// back through shared memory, the way an out of process viewer does.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/runtime/snapshot.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr char const *s_segment = "/dynamic_editor_headless_test";
+
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Sum", "attrs": [10, 11, 12], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Limit", "attrs": [20, 21], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 1.0}},
+    {"id": 3, "name": "Probe", "attrs": [30], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 12, "to": 20},
+    {"id": 101, "from": 21, "to": 30}
+  ]
+})";
+
+// waits for a snapshot of at least one pass, false on timeout
+auto WaitForSnapshot(runtime::SnapshotReader const &reader,
+                     runtime::Snapshot &snapshot) -> bool {
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (reader.Read(snapshot) && snapshot.Info.Pass > 0)
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+} // namespace
+
+int main() {
+  tests::RegisterTestNodes();
+  auto const document = nlohmann::json::parse(s_graph);
+
+  api::HeadlessEngine engine;
+  tests::Check(engine.Load(document), "the graph loads without ImGui");
+  runtime::SnapshotCapacity const capacity{16, 64, 1024};
+  if (!tests::Check(engine.Publish(s_segment, capacity),
+                    "the segment is created"))
+    return tests::Finish();
+
+  auto const reader = runtime::SnapshotReader::Open(s_segment);
+  if (!tests::Check(reader != nullptr, "the segment opens"))
+    return tests::Finish();
+
+  engine.Start();
+  runtime::Snapshot snapshot;
+  if (tests::Check(WaitForSnapshot(*reader, snapshot), "passes publish")) {
+    tests::Check(snapshot.Info.NodeCount == 3, "every node is published");
+    auto const limit = std::find_if(
+        snapshot.Values.begin(), snapshot.Values.end(),
+        [](auto const &value) { return value.AttributeId == 21; });
+    tests::Check(limit != snapshot.Values.end() && limit->HasValue != 0 &&
+                     limit->Scalar == 0.0,
+                 "outputs are published");
+  }
+
+  // a run is processing the nodes Load would replace
+  tests::Check(!engine.Load(document), "Load refuses while running");
+  tests::Check(engine.Poll(), "the refused Load left the run alone");
+
+  engine.Stop();
+  tests::Check(!engine.TakeError().has_value(), "the passes succeed");
+  tests::Check(engine.Load(document), "Load works again once stopped");
+  return tests::Finish();
+}
@@ -0,0 +1,106 @@
+// Runs passes over graphs that do not change, one of them failing every
+// pass on a node error. Once the first passes compiled the plan and sized
+// what nodes reuse, a pass must not allocate any more through operator new.
+// The exception object of a failing pass is allocated by the C++ runtime
+// with malloc, which is not counted. Only built with
+// IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+#include <dynamic_editor/utils/allocation_counter.hpp>
+
+#include <cstdio>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr int WarmUpPasses = 10;
+constexpr int MeasuredPasses = 50;
+
+// a sum capped at a limit, a pure cone the executor folds into constants
+// and a chain it processes every pass
+constexpr char const *s_healthy = R"({
+  "nodes": [
+    {"id": 1, "name": "Sum", "attrs": [10, 11, 12], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Limit", "attrs": [20, 21], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 1.0}},
+    {"id": 3, "name": "Probe", "attrs": [30], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 12, "to": 20},
+    {"id": 101, "from": 21, "to": 30}
+  ]
+})";
+
+// the same chain next to a limit that throws a node error every pass
+constexpr char const *s_failing = R"({
+  "nodes": [
+    {"id": 1, "name": "Sum", "attrs": [10, 11, 12], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 2, "name": "Limit", "attrs": [20, 21], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 1.0}},
+    {"id": 3, "name": "Probe", "attrs": [30], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 4, "name": "Limit", "attrs": [40, 41], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": -1.0}},
+    {"id": 5, "name": "Probe", "attrs": [50], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 12, "to": 20},
+    {"id": 101, "from": 21, "to": 30},
+    {"id": 102, "from": 41, "to": 50}
+  ]
+})";
+
+void CheckPasses(char const *name, char const *document, bool fails) {
+  nodes::NodeHolder graph;
+  runtime::Executor executor;
+  if (!tests::Check(api::LoadGraph(nlohmann::json::parse(document), graph,
+                                   executor),
+                    name))
+    return;
+
+  for (int i = 0; i < WarmUpPasses; i++)
+    executor.RunOnce();
+
+  for (int i = 0; i < MeasuredPasses; i++) {
+    auto const error = executor.RunOnce();
+    if (error.has_value() != fails ||
+        (fails && error->Message != std::string_view("Limit is negative"))) {
+      printf("%s: pass %d %s\n", name, i,
+             error.has_value() ? "failed" : "did not fail");
+      tests::Check(false, "passes fail as expected");
+      return;
+    }
+    if (executor.GetPassAllocations() != 0) {
+      printf("%s: pass %d allocated %llu times\n", name, i,
+             static_cast<unsigned long long>(executor.GetPassAllocations()));
+      tests::Check(false, "a steady pass does not allocate");
+      return;
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  if (!tests::Check(utils::IsCountingAllocations(),
+                    "built with IM_DYNAMIC_EDITOR_COUNT_ALLOCATIONS"))
+    return tests::Finish();
+
+  tests::RegisterTestNodes();
+  CheckPasses("healthy graph", s_healthy, false);
+  CheckPasses("failing graph", s_failing, true);
+  return tests::Finish();
+}
@@ -0,0 +1,116 @@
+// Records a graph fed by a data source while its unlinked inputs are edited,
+// then replays the recording twice. Both replays have to reproduce the
+// output checksum of every recorded tick, and so each other.
+
+#include "check.hpp"
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/dynamic_editor.hpp>
+#include <dynamic_editor/api/headless.hpp>
+#include <dynamic_editor/api/recording.hpp>
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/runtime/executor.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+#include <nlohmann/json.hpp>
+
+using namespace dynamic_editor;
+
+namespace {
+
+constexpr int Ticks = 64;
+constexpr char const *s_channel = "Replay test";
+
+// samples summed with an edited default and capped, the capped value and
+// the samples of every pass are outputs the checksums cover
+constexpr char const *s_graph = R"({
+  "nodes": [
+    {"id": 1, "name": "Data Source", "attrs": [10, 11], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true,
+      "channel": "Replay test"}},
+    {"id": 2, "name": "Sum", "attrs": [20, 21, 22], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}},
+    {"id": 3, "name": "Limit", "attrs": [30, 31], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true, "limit": 20.0}},
+    {"id": 4, "name": "Probe", "attrs": [40], "impl": {
+      "shouldRenderViewer": true, "showTitleBar": true}}
+  ],
+  "links": [
+    {"id": 100, "from": 10, "to": 20},
+    {"id": 101, "from": 22, "to": 30},
+    {"id": 102, "from": 31, "to": 40}
+  ]
+})";
+
+auto Record(std::filesystem::path const &path) -> bool {
+  auto const channel = api::RegisterDataSource(s_channel);
+  auto const document = nlohmann::json::parse(s_graph);
+  nodes::NodeHolder graph;
+  runtime::Executor executor;
+  if (!tests::Check(api::LoadGraph(document, graph, executor),
+                    "the graph loads"))
+    return false;
+
+  auto recorder = std::make_shared<api::Recorder>(document);
+  executor.Submit(runtime::command::AddObserver{recorder});
+
+  // graph.Nodes is in the order of the document
+  auto &edited = graph.Nodes[1]->GetAttributes()[1];
+  for (int tick = 0; tick < Ticks; tick++) {
+    // a varying number of samples per pass, none in some of them
+    for (int i = 0; i < tick % 4; i++)
+      channel->Push(tick * 0.1 + i * 0.01, static_cast<float>(tick + i) * 0.3F);
+    if (tick % 5 == 0)
+      edited.SetDefaultValue(static_cast<float>(tick) * 0.25F);
+
+    if (auto const error = executor.RunOnce()) {
+      printf("tick %d failed: %.*s\n", tick,
+             static_cast<int>(error->Message.size()), error->Message.data());
+      tests::Check(false, "recorded passes succeed");
+      return false;
+    }
+  }
+
+  recorder->Stop();
+  tests::Check(recorder->GetTicks() == Ticks, "every pass is a tick");
+  return tests::Check(recorder->Save(path), "the recording is saved");
+}
+
+auto Replay(std::filesystem::path const &path)
+    -> std::optional<api::ReplayResult> {
+  auto result = api::ReplayRecording(path);
+  if (!tests::Check(result.has_value(), "the recording replays"))
+    return std::nullopt;
+
+  tests::Check(!result->Error.has_value(), "replayed passes succeed");
+  tests::Check(result->Ticks == Ticks, "every tick is replayed");
+  tests::Check(result->Mismatches == 0,
+               "replayed outputs match the recorded ones");
+  tests::Check(result->Checksums.size() == Ticks,
+               "every replayed tick has a checksum");
+  return result;
+}
+
+} // namespace
+
+int main() {
+  tests::RegisterTestNodes();
+  auto const path =
+      std::filesystem::temp_directory_path() / "dynamic_editor_replay_test";
+
+  if (Record(path)) {
+    auto const first = Replay(path);
+    auto const second = Replay(path);
+    if (first.has_value() && second.has_value())
+      tests::Check(first->Checksums == second->Checksums,
+                   "replays are bit identical");
+  }
+
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  return tests::Finish();
+}
@@ -0,0 +1,33 @@
+#include "test_nodes.hpp"
+
+#include <dynamic_editor/api/dynamic_editor.hpp>
+
+#include <string>
+
+// the library leaves saving and loading through the editor menu to the
+// application, tests have nothing to save to
+void OnDumpNodes(std::string const & /*content*/) {}
+nlohmann::json LoadNodesRequested() { return {}; }
+
+namespace dynamic_editor::tests {
+
+void RegisterTestNodes() {
+  static bool s_registered = false;
+  if (s_registered)
+    return;
+  s_registered = true;
+
+  api::RegisterNodeType<SumNode>("Tests", "Sum", "Adds its inputs");
+  api::RegisterNodeType<LimitNode>("Tests", "Limit",
+                                   "Caps its input at a property");
+  api::RegisterNodeType<GainNode>("Tests", "Gain",
+                                  "Multiplies its input by a property");
+  api::RegisterNodeType<IntegratorNode>("Tests", "Integrator",
+                                        "Sums its input over the passes");
+  api::RegisterNodeType<FillNode>("Tests", "Fill",
+                                  "Fills a buffer with the pass count");
+  api::RegisterNodeType<ProbeNode>("Tests", "Probe",
+                                   "Keeps the value it got last");
+}
+
+} // namespace dynamic_editor::tests
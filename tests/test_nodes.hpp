@@ -0,0 +1,184 @@
+#pragma once
+
+#include <dynamic_editor/nodes/typed_node.hpp>
+#include <dynamic_editor/runtime/expression.hpp>
+#include <dynamic_editor/utils/binary_stream.hpp>
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace dynamic_editor::tests {
+
+// Node types the tests build their graphs from, registered under the
+// "Tests" category by RegisterTestNodes.
+
+class SumNode
+    : public nodes::TypedNode<nodes::In<float, "A">, nodes::In<float, "B">,
+                              nodes::Out<float, "Sum">> {
+public:
+  explicit SumNode(std::string name) : TypedNode(std::move(name)) {}
+  auto IsPure() const -> bool override { return true; }
+
+  void Process() override { Output<2>(Input<0>() + Input<1>()); }
+};
+
+// Caps its input at the "limit" property. Warns once the value reaches the
+// limit and errors, in frames and passes, while the limit is negative.
+class LimitNode
+    : public nodes::TypedNode<nodes::In<float, "Value">,
+                              nodes::Out<float, "Value">> {
+public:
+  explicit LimitNode(std::string name) : TypedNode(std::move(name)) {}
+
+  void CheckForErrors() override {
+    if (m_Limit < 0.0F)
+      SetError("Limit is negative");
+    else if (Input<0>() >= m_Limit)
+      SetWarning("Value reached the limit");
+  }
+
+  void DrawViewerNodeContent() override {
+    ImGui::Text("%s: %.2f", GetTitle().c_str(), m_Limit);
+  }
+  void DrawPropertiesContent() override {
+    if (ImGui::InputFloat("Limit", &m_Limit))
+      MarkPropertiesChanged();
+  }
+
+  void Process() override {
+    if (m_Limit < 0.0F)
+      ThrowNodeError("Limit is negative");
+    Output<1>(std::min(Input<0>(), m_Limit));
+  }
+
+  void Dump(nlohmann::json &data) const override {
+    Node::Dump(data);
+    data["limit"] = m_Limit;
+  }
+  void Load(nlohmann::json const &data) override {
+    Node::Load(data);
+    m_Limit = data.value("limit", 0.0F);
+    MarkPropertiesChanged();
+  }
+
+private:
+  float m_Limit = 0.0F;
+};
+
+// Multiplies its input by the "gain" property and also outputs the square
+// of that. Described as an expression, so fused and bytecode plans compute
+// it natively, and the square reads the input twice.
+class GainNode
+    : public nodes::TypedNode<nodes::In<float, "Value">,
+                              nodes::Out<float, "Value">,
+                              nodes::Out<float, "Square">> {
+public:
+  explicit GainNode(std::string name) : TypedNode(std::move(name)) {}
+
+  void SetGain(float gain) {
+    m_Gain = gain;
+    MarkPropertiesChanged();
+  }
+
+  // the operations of the expressions in the same order
+  void Process() override {
+    float const value = Input<0>();
+    Output<1>(value * m_Gain);
+    Output<2>((value * value) * (m_Gain * m_Gain));
+  }
+
+  auto DescribeExpression(size_t output,
+                          runtime::ExpressionBuilder &builder) const
+      -> std::optional<int> override {
+    if (output == 1)
+      return builder.Multiply(builder.Input(0), builder.Constant(m_Gain));
+    return builder.Multiply(
+        builder.Multiply(builder.Input(0), builder.Input(0)),
+        builder.Constant(m_Gain * m_Gain));
+  }
+
+  void Dump(nlohmann::json &data) const override {
+    Node::Dump(data);
+    data["gain"] = m_Gain;
+  }
+  void Load(nlohmann::json const &data) override {
+    Node::Load(data);
+    SetGain(data.value("gain", 1.0F));
+  }
+
+private:
+  float m_Gain = 1.0F;
+};
+
+// Sums its input over the passes, the sum is the runtime state it
+// checkpoints.
+class IntegratorNode
+    : public nodes::TypedNode<nodes::In<float, "Value">,
+                              nodes::Out<float, "Sum">> {
+public:
+  explicit IntegratorNode(std::string name) : TypedNode(std::move(name)) {}
+
+  void Process() override {
+    m_Sum += Input<0>();
+    Output<1>(m_Sum);
+  }
+
+  void SaveState(utils::BinaryWriter &out) const override { out.Write(m_Sum); }
+  auto RestoreState(utils::BinaryReader &in) -> bool override {
+    return in.Read(m_Sum) && in.AtEnd();
+  }
+
+private:
+  float m_Sum = 0.0F;
+};
+
+// Fills a buffer with minus the number of passes it ran, one value per
+// pass, so readers can tell a buffer written while they read it. The size
+// changes from pass to pass.
+class FillNode : public nodes::TypedNode<nodes::Out<nodes::Attribute::Buffer,
+                                                    "Values">> {
+public:
+  explicit FillNode(std::string name) : TypedNode(std::move(name)) {}
+
+  void Process() override {
+    m_Passes++;
+    size_t const size = 256 + m_Passes % 64;
+    std::fill_n(m_Values.Resize(size), size, -static_cast<float>(m_Passes));
+    Output<0>(m_Values.Get());
+  }
+
+private:
+  nodes::BufferOutput m_Values;
+  int m_Passes = 0;
+};
+
+// End node keeping the value it got last, so tests can look at it from any
+// thread.
+class ProbeNode : public nodes::TypedNode<nodes::In<float, "Value">> {
+public:
+  explicit ProbeNode(std::string name) : TypedNode(std::move(name)) {}
+
+  void Process() override {
+    m_Value.store(Input<0>(), std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto GetValue() const -> float {
+    return m_Value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<float> m_Value = 0.0F;
+};
+
+// registers the types above once, however often it is called
+void RegisterTestNodes();
+
+} // namespace dynamic_editor::tests
@@ -0,0 +1,265 @@
+// Runs every SIMD kernel set the CPU supports against the scalar kernels,
+// over every tail length of the widest set, unaligned data, outputs
+// aliasing an input and values such as -0, infinities and NaN.
+
+#include "check.hpp"
+
+#include <vector_math.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace widgets::vector_math;
+namespace tests = dynamic_editor::tests;
+
+namespace {
+
+// the widest kernels process 16 floats per register, four registers per
+// iteration of the reductions
+constexpr size_t MaxWidth = 16;
+constexpr size_t MaxLength = 4 * MaxWidth + MaxWidth + 8;
+constexpr size_t MaxOffset = 3;
+constexpr size_t BufferSize = MaxLength + MaxOffset;
+
+struct Inputs {
+  std::vector<float> A;
+  std::vector<float> B;
+  std::vector<float> C;
+};
+
+auto MakeInputs(bool special, unsigned seed) -> Inputs {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+  static constexpr float s_special[] = {0.0F, -0.0F, -1.5F, nan,
+                                        inf,  -inf,  1e-40F, -2.0F};
+
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> values(-4.0F, 4.0F);
+  Inputs inputs;
+  for (auto *input : {&inputs.A, &inputs.B, &inputs.C}) {
+    input->resize(BufferSize);
+    for (size_t i = 0; i < BufferSize; i++) {
+      (*input)[i] = special && random() % 3 == 0
+                        ? s_special[random() % std::size(s_special)]
+                        : values(random);
+    }
+  }
+  return inputs;
+}
+
+// bit for bit, any NaN matches any other
+auto Same(float a, float b) -> bool {
+  if (std::isnan(a) || std::isnan(b))
+    return std::isnan(a) && std::isnan(b);
+  return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// -0 and 0 match, the kernels may return either of them
+auto SameValue(float a, float b) -> bool {
+  if (std::isnan(a) || std::isnan(b))
+    return std::isnan(a) && std::isnan(b);
+  return a == b;
+}
+
+// for results whose rounding depends on the order of the operations
+auto Close(float a, float b, float scale) -> bool {
+  if (std::isnan(a) || std::isnan(b) || std::isinf(a) || std::isinf(b))
+    return SameValue(a, b);
+  return std::fabs(a - b) <= 1e-5F * scale + 1e-30F;
+}
+
+struct Context {
+  Kernels const &Simd;
+  Kernels const &Scalar;
+  size_t Size;
+  size_t Offset;
+  bool Special;
+};
+
+void Expect(bool ok, Context const &context, char const *kernel,
+            char const *detail = "") {
+  if (ok)
+    return;
+
+  char what[192];
+  snprintf(what, sizeof(what), "%s %s, %zu values at offset %zu%s%s",
+           GetIsaName(context.Simd.Set), kernel, context.Size,
+           context.Offset, context.Special ? ", special values" : "",
+           detail);
+  tests::Check(false, what);
+}
+
+// every element wise kernel as a function of up to three inputs
+using Run = void (*)(Kernels const &kernels, float const *a, float const *b,
+                     float const *c, float *out, size_t n);
+
+struct ElementwiseKernel {
+  char const *Name;
+  size_t Inputs;
+  Run Func;
+  // false if the SIMD kernels fuse what the scalar ones round twice
+  bool Exact;
+};
+
+constexpr ElementwiseKernel s_elementwise[] = {
+    {"Add", 2,
+     [](Kernels const &k, float const *a, float const *b, float const *,
+        float *out, size_t n) { k.Add(a, b, out, n); },
+     true},
+    {"Multiply", 2,
+     [](Kernels const &k, float const *a, float const *b, float const *,
+        float *out, size_t n) { k.Multiply(a, b, out, n); },
+     true},
+    {"Fma", 3,
+     [](Kernels const &k, float const *a, float const *b, float const *c,
+        float *out, size_t n) { k.Fma(a, b, c, out, n); },
+     false},
+    {"Abs", 1,
+     [](Kernels const &k, float const *a, float const *, float const *,
+        float *out, size_t n) { k.Abs(a, out, n); },
+     true},
+    {"Clamp", 1,
+     [](Kernels const &k, float const *a, float const *, float const *,
+        float *out, size_t n) { k.Clamp(a, -1.0F, 2.0F, out, n); },
+     true},
+    {"Clamp to zero", 1,
+     [](Kernels const &k, float const *a, float const *, float const *,
+        float *out, size_t n) { k.Clamp(a, -0.0F, 0.0F, out, n); },
+     true},
+    {"Threshold", 1,
+     [](Kernels const &k, float const *a, float const *, float const *,
+        float *out, size_t n) { k.Threshold(a, 0.5F, out, n); },
+     true},
+};
+
+void CheckElementwise(Context const &context, Inputs const &inputs) {
+  size_t const offset = context.Offset;
+  size_t const n = context.Size;
+  // the inputs and the output are misaligned against each other too
+  float const *a = inputs.A.data() + offset;
+  float const *b = inputs.B.data() + (offset + 1) % (MaxOffset + 1);
+  float const *c = inputs.C.data() + (offset + 2) % (MaxOffset + 1);
+  float const *sources[] = {a, b, c};
+
+  std::vector<float> expected(BufferSize);
+  // one more for the guard
+  std::vector<float> actual(BufferSize + 1);
+  for (auto const &kernel : s_elementwise) {
+    kernel.Func(context.Scalar, a, b, c, expected.data(), n);
+
+    // separate output, then the output in place of each input
+    for (size_t alias = 0; alias <= kernel.Inputs; alias++) {
+      float const *in[] = {a, b, c};
+      float *out = actual.data() + (offset + 3) % (MaxOffset + 1);
+      if (alias > 0) {
+        out = actual.data() + offset;
+        std::memcpy(out, sources[alias - 1], n * sizeof(float));
+        in[alias - 1] = out;
+      }
+
+      // a guard value behind the end catches writes past n
+      float const guard = 12345.0F;
+      out[n] = guard;
+      kernel.Func(context.Simd, in[0], in[1], in[2], out, n);
+      Expect(out[n] == guard, context, kernel.Name, ", wrote past the end");
+
+      for (size_t i = 0; i < n; i++) {
+        bool const ok =
+            kernel.Exact
+                ? Same(out[i], expected[i])
+                : Close(out[i], expected[i],
+                        std::fabs(a[i] * b[i]) + std::fabs(c[i]));
+        if (!ok) {
+          char detail[96];
+          snprintf(detail, sizeof(detail), ", [%zu] is %g, expected %g%s", i,
+                   out[i], expected[i],
+                   alias > 0 ? " with the output aliasing an input" : "");
+          Expect(false, context, kernel.Name, detail);
+          break;
+        }
+      }
+    }
+  }
+}
+
+void CheckReductions(Context const &context, Inputs const &inputs) {
+  size_t const n = context.Size;
+  float const *a = inputs.A.data() + context.Offset;
+  float const *b = inputs.B.data() + (context.Offset + 1) % (MaxOffset + 1);
+  auto const &simd = context.Simd;
+  auto const &scalar = context.Scalar;
+
+  float sum_scale = 0.0F;
+  float dot_scale = 0.0F;
+  for (size_t i = 0; i < n; i++) {
+    sum_scale += std::fabs(a[i]);
+    dot_scale += std::fabs(a[i] * b[i]);
+  }
+
+  Expect(Close(simd.Sum(a, n), scalar.Sum(a, n), sum_scale), context, "Sum");
+  Expect(Close(simd.Dot(a, b, n), scalar.Dot(a, b, n), dot_scale), context,
+         "Dot");
+  Expect(SameValue(simd.Min(a, n), scalar.Min(a, n)), context, "Min");
+  Expect(SameValue(simd.Max(a, n), scalar.Max(a, n)), context, "Max");
+}
+
+// the scalar kernels are the reference, they have to get the edge cases
+// right on their own
+void CheckScalar() {
+  auto const &scalar = *GetKernels(Isa::Scalar);
+  constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+  float const values[] = {3.0F, nan, -2.0F};
+  tests::Check(std::isnan(scalar.Min(values, 3)), "Min of a NaN is NaN");
+  tests::Check(std::isnan(scalar.Max(values, 3)), "Max of a NaN is NaN");
+  tests::Check(scalar.Min(values, 1) == 3.0F, "Min of one value");
+  tests::Check(scalar.Sum(nullptr, 0) == 0.0F, "Sum of nothing is 0");
+  tests::Check(scalar.Min(nullptr, 0) == 0.0F, "Min of nothing is 0");
+
+  float const negative_zero = -0.0F;
+  float result = 1.0F;
+  scalar.Abs(&negative_zero, &result, 1);
+  tests::Check(Same(result, 0.0F), "Abs of -0 is 0");
+
+  float clamped = 0.0F;
+  scalar.Clamp(&nan, -1.0F, 1.0F, &clamped, 1);
+  tests::Check(std::isnan(clamped), "Clamp keeps NaN");
+}
+
+} // namespace
+
+int main() {
+  auto const *scalar = GetKernels(Isa::Scalar);
+  if (!tests::Check(scalar != nullptr, "scalar kernels exist"))
+    return tests::Finish();
+  CheckScalar();
+
+  Inputs const plain = MakeInputs(false, 1);
+  Inputs const special = MakeInputs(true, 2);
+  for (auto isa : {Isa::Sse, Isa::Avx2, Isa::Avx512}) {
+    auto const *simd = GetKernels(isa);
+    if (simd == nullptr) {
+      printf("%s kernels are not supported here, skipped\n",
+             GetIsaName(isa));
+      continue;
+    }
+    tests::Check(simd->Set == isa, "kernels report their instruction set");
+
+    for (size_t size = 0; size <= MaxLength; size++) {
+      for (size_t offset = 0; offset <= MaxOffset; offset++) {
+        for (auto const *inputs : {&plain, &special}) {
+          Context const context{*simd, *scalar, size, offset,
+                                inputs == &special};
+          CheckElementwise(context, *inputs);
+          CheckReductions(context, *inputs);
+        }
+      }
+    }
+    printf("%s kernels checked\n", GetIsaName(isa));
+  }
+  return tests::Finish();
+}
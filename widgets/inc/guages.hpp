@@ -1,11 +1,14 @@
 #pragma once
 
 #include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/nodes/typed_node.hpp>
 
 #include "imgui.h"
 #include "imgui_internal.h"
 
+#include <array>
 #include <map>
+#include <vector>
 
 using namespace dynamic_editor::nodes;
 
@@ -15,12 +18,46 @@ namespace guages {
 
 struct GuageColorMap {
   std::map<float, ImU32> Map;
+  // blend between neighbouring thresholds instead of hard bands
+  bool Gradient = false;
 
   GuageColorMap(std::initializer_list<std::pair<const float, ImU32>> init)
-      : Map(init) {}
-  GuageColorMap() = default;
+      : Map(init) {
+    Compile();
+  }
+  GuageColorMap() { Compile(); }
+
+  // edits Map and recompiles the lookup tables when anything changed.
+  // Returns true when an entry was added or removed, which no item reports
+  // as an edit, so the caller commits it, see Node::MarkEditCommitted
+  static bool Render(GuageColorMap &colorMap);
+
+  // rebuilds the flat lookup tables from Map, must be called after editing
+  // Map or Gradient directly
+  void Compile();
+
+  // color of the first threshold >= value, or the last color above all
+  // thresholds. Interpolated through the lookup table in gradient mode
+  [[nodiscard]] ImU32 GetColor(float value) const;
+
+  [[nodiscard]] const std::vector<float> &GetThresholds() const {
+    return m_Thresholds;
+  }
+  [[nodiscard]] const std::vector<ImU32> &GetColors() const {
+    return m_Colors;
+  }
+  // changes whenever the compiled contents change
+  [[nodiscard]] ImGuiID GetHash() const { return m_Hash; }
 
-  static void Render(GuageColorMap &colorMap);
+private:
+  static constexpr int LutSize = 256;
+
+  std::vector<float> m_Thresholds;
+  std::vector<ImU32> m_Colors;
+  std::array<ImU32, LutSize> m_Lut{};
+  float m_LutMin = 0.0f;
+  float m_LutScale = 0.0f;
+  ImGuiID m_Hash = 0;
 };
 
 bool SimpleGuage(const char *label, float value, float min, float max,
@@ -33,42 +70,62 @@ bool SimpleGuage(const char *label, float value, float min, float max,
 
 } // namespace widgets
 
-class SimpleGuageNode : public Node {
+class SimpleGuageNode
+    : public TypedNode<In<float, "Value">, In<float, "Min Value">,
+                       In<float, "Max Value">> {
 public:
-  SimpleGuageNode(std::string name)
-      : Node(name, {
-                       {Attribute::IO::In, Attribute::Type::Float, "Value"},
-                       {Attribute::IO::In, Attribute::Type::Float, "Min Value"},
-                       {Attribute::IO::In, Attribute::Type::Float, "Max Value"},
-                   }) {
+  SimpleGuageNode(std::string name) : TypedNode(name) {
     colorMap = widgets::guages::GuageColorMap{{50, IM_COL32(0, 153, 0, 255)},
                                               {75, IM_COL32(255, 255, 0, 255)},
                                               {100, IM_COL32(255, 0, 0, 255)}};
     memcpy(label, name.c_str(), std::min(static_cast<int>(name.size()), 256));
   }
   void CheckForErrors() override {
-    if (GetTOnInput<float>(1) == GetTOnInput<float>(2)) {
+    if (Input<1>() == Input<2>()) {
       SetError("Min and Max cannot be the same");
     }
-    if (GetTOnInput<float>(1) > GetTOnInput<float>(2)) {
+    if (Input<1>() > Input<2>()) {
       SetError("Min cannot be greater than Max");
     }
 
-    if (GetTOnInput<float>(0) < GetTOnInput<float>(1)) {
+    if (Input<0>() < Input<1>()) {
       SetWarning("Value is less than Min");
     }
-    if (GetTOnInput<float>(0) > GetTOnInput<float>(2)) {
+    if (Input<0>() > Input<2>()) {
       SetWarning("Value is greater than Max");
     }
   }
 
   void DrawPropertiesContent() override {
 
-    ImGui::InputFloat("Min", GetTPtrOnInput<float>(1));
-    ImGui::InputFloat("Max", GetTPtrOnInput<float>(2));
+    ImGui::InputFloat("Min", Default<1>());
+    ImGui::InputFloat("Max", Default<2>());
 
     ImGui::SeparatorText("Color Map");
-    widgets::guages::GuageColorMap::Render(colorMap);
+    if (widgets::guages::GuageColorMap::Render(colorMap)) {
+      MarkEditCommitted();
+    }
+  }
+
+  void Dump(nlohmann::json &data) const override {
+    Node::Dump(data);
+    auto &map = data["colorMap"];
+    map = nlohmann::json::array();
+    for (const auto &[threshold, color] : colorMap.Map) {
+      map.push_back({threshold, color});
+    }
+    data["gradient"] = colorMap.Gradient;
+  }
+  void Load(nlohmann::json const &data) override {
+    Node::Load(data);
+    if (const auto map = data.find("colorMap"); map != data.end()) {
+      colorMap.Map.clear();
+      for (const auto &entry : *map) {
+        colorMap.Map[entry.at(0).get<float>()] = entry.at(1).get<ImU32>();
+      }
+    }
+    colorMap.Gradient = data.value("gradient", colorMap.Gradient);
+    colorMap.Compile();
   }
 
   void DrawEditorNode() override {
@@ -78,10 +135,10 @@ public:
   }
 
   void DrawViewerNodeContent() override {
-    widgets::guages::SimpleGuage(
-        label, GetTOnInput<float>(0), GetTOnInput<float>(1),
-        GetTOnInput<float>(2), colorMap, format, radius, thickness, start_angle,
-        end_angle, threshold_indicator_div);
+    widgets::guages::SimpleGuage(label, Input<0>(), Input<1>(), Input<2>(),
+                                 colorMap, format, radius, thickness,
+                                 start_angle, end_angle,
+                                 threshold_indicator_div);
   }
   void Process() override {}
 
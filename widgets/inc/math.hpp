@@ -0,0 +1,478 @@
+#pragma once
+
+#include <dynamic_editor/nodes/node.hpp>
+#include <dynamic_editor/nodes/typed_node.hpp>
+#include <dynamic_editor/runtime/expression.hpp>
+#include <dynamic_editor/runtime/instancing.hpp>
+
+#include "imgui.h"
+
+#include <vector_math.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace dynamic_editor::nodes;
+using dynamic_editor::runtime::ExpressionBuilder;
+using dynamic_editor::runtime::ExprOp;
+using dynamic_editor::runtime::InstanceBlock;
+
+// Scalar glue math. Every node here describes itself as an expression, so
+// chains of them are fused into a single kernel when fusion is enabled, and
+// processes whole columns of instances, see runtime::InstancedGraph.
+
+class ScaleNode : public Node {
+public:
+  ScaleNode(std::string name) : Node(std::move(name), GetNodeType()) {}
+
+  static auto GetNodeType() -> NodeTypeDescriptor const & {
+    static auto const &s_type = NodeTypeDescriptor::Intern({
+        {Attribute::IO::In, Attribute::Type::Float, "Value"},
+        {Attribute::IO::In, Attribute::Type::Float, "Factor", 1.0F},
+        {Attribute::IO::Out, Attribute::Type::Float, "Value"},
+    });
+    return s_type;
+  }
+
+  void DrawPropertiesContent() override {
+    if (auto *factor = GetTPtrOnInput<float>(1))
+      ImGui::InputFloat("Factor", factor);
+  }
+
+  void Process() override {
+    SetFloatOnOutput(2, GetTOnInput<float>(0).value_or(0.0F) *
+                            GetTOnInput<float>(1).value_or(0.0F));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<float, float, float>(
+        [](float value, float factor) { return value * factor; });
+  }
+
+  auto DescribeExpression(size_t /*output*/, ExpressionBuilder &builder) const
+      -> std::optional<int> override {
+    return builder.Multiply(builder.Input(0), builder.Input(1));
+  }
+};
+
+class OffsetNode : public Node {
+public:
+  OffsetNode(std::string name) : Node(std::move(name), GetNodeType()) {}
+
+  static auto GetNodeType() -> NodeTypeDescriptor const & {
+    static auto const &s_type = NodeTypeDescriptor::Intern({
+        {Attribute::IO::In, Attribute::Type::Float, "Value"},
+        {Attribute::IO::In, Attribute::Type::Float, "Offset"},
+        {Attribute::IO::Out, Attribute::Type::Float, "Value"},
+    });
+    return s_type;
+  }
+
+  void DrawPropertiesContent() override {
+    if (auto *offset = GetTPtrOnInput<float>(1))
+      ImGui::InputFloat("Offset", offset);
+  }
+
+  void Process() override {
+    SetFloatOnOutput(2, GetTOnInput<float>(0).value_or(0.0F) +
+                            GetTOnInput<float>(1).value_or(0.0F));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<float, float, float>(
+        [](float value, float offset) { return value + offset; });
+  }
+
+  auto DescribeExpression(size_t /*output*/, ExpressionBuilder &builder) const
+      -> std::optional<int> override {
+    return builder.Add(builder.Input(0), builder.Input(1));
+  }
+};
+
+class ClampNode : public Node {
+public:
+  ClampNode(std::string name) : Node(std::move(name), GetNodeType()) {}
+
+  static auto GetNodeType() -> NodeTypeDescriptor const & {
+    static auto const &s_type = NodeTypeDescriptor::Intern({
+        {Attribute::IO::In, Attribute::Type::Float, "Value"},
+        {Attribute::IO::In, Attribute::Type::Float, "Min"},
+        {Attribute::IO::In, Attribute::Type::Float, "Max", 1.0F},
+        {Attribute::IO::Out, Attribute::Type::Float, "Value"},
+    });
+    return s_type;
+  }
+
+  void CheckForErrors() override {
+    if (GetTOnInput<float>(1) > GetTOnInput<float>(2)) {
+      SetWarning("Min is greater than Max");
+    }
+  }
+
+  void DrawPropertiesContent() override {
+    if (auto *min = GetTPtrOnInput<float>(1))
+      ImGui::InputFloat("Min", min);
+    if (auto *max = GetTPtrOnInput<float>(2))
+      ImGui::InputFloat("Max", max);
+  }
+
+  // same as the fused min(max(value, min), max)
+  void Process() override {
+    float const value = GetTOnInput<float>(0).value_or(0.0F);
+    float const min = GetTOnInput<float>(1).value_or(0.0F);
+    float const max = GetTOnInput<float>(2).value_or(0.0F);
+    SetFloatOnOutput(3, std::min(std::max(value, min), max));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<float, float, float, float>(
+        [](float value, float min, float max) {
+          return std::min(std::max(value, min), max);
+        });
+  }
+
+  auto DescribeExpression(size_t /*output*/, ExpressionBuilder &builder) const
+      -> std::optional<int> override {
+    return builder.Clamp(builder.Input(0), builder.Input(1), builder.Input(2));
+  }
+};
+
+class CompareNode : public Node {
+public:
+  enum class Mode { Less, LessEqual, Greater, GreaterEqual, Equal };
+
+  CompareNode(std::string name) : Node(std::move(name), GetNodeType()) {}
+
+  static auto GetNodeType() -> NodeTypeDescriptor const & {
+    static auto const &s_type = NodeTypeDescriptor::Intern({
+        {Attribute::IO::In, Attribute::Type::Float, "A"},
+        {Attribute::IO::In, Attribute::Type::Float, "B"},
+        {Attribute::IO::Out, Attribute::Type::Boolean, "Result"},
+    });
+    return s_type;
+  }
+
+  void DrawPropertiesContent() override {
+    static char const *modes[] = {"A < B", "A <= B", "A > B", "A >= B",
+                                  "A == B"};
+    int mode = static_cast<int>(m_Mode);
+    if (ImGui::Combo("Mode", &mode, modes, IM_ARRAYSIZE(modes))) {
+      m_Mode = static_cast<Mode>(mode);
+      MarkPropertiesChanged();
+    }
+    if (auto *b = GetTPtrOnInput<float>(1))
+      ImGui::InputFloat("B", b);
+  }
+
+  void Process() override {
+    SetBoolOnOutput(2, Compare(m_Mode, GetTOnInput<float>(0).value_or(0.0F),
+                               GetTOnInput<float>(1).value_or(0.0F)));
+  }
+  // booleans are stored as uint8_t in columns
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<uint8_t, float, float>([mode = m_Mode](float a, float b) {
+      return static_cast<uint8_t>(Compare(mode, a, b));
+    });
+  }
+
+  auto DescribeExpression(size_t /*output*/, ExpressionBuilder &builder) const
+      -> std::optional<int> override {
+    static constexpr ExprOp ops[] = {ExprOp::Less, ExprOp::LessEqual,
+                                     ExprOp::Greater, ExprOp::GreaterEqual,
+                                     ExprOp::Equal};
+    return builder.Binary(ops[static_cast<int>(m_Mode)], builder.Input(0),
+                          builder.Input(1));
+  }
+
+  void Dump(nlohmann::json &data) const override {
+    Node::Dump(data);
+    data["mode"] = static_cast<int>(m_Mode);
+  }
+  void Load(nlohmann::json const &data) override {
+    Node::Load(data);
+    m_Mode = static_cast<Mode>(data.value("mode", 0));
+    MarkPropertiesChanged();
+  }
+
+private:
+  static auto Compare(Mode mode, float a, float b) -> bool {
+    switch (mode) {
+    case Mode::Less:
+      return a < b;
+    case Mode::LessEqual:
+      return a <= b;
+    case Mode::Greater:
+      return a > b;
+    case Mode::GreaterEqual:
+      return a >= b;
+    case Mode::Equal:
+      return a == b;
+    }
+    return false;
+  }
+
+  Mode m_Mode = Mode::Less;
+};
+
+// Array math on Buffer ports. The work is done by the SIMD kernels picked
+// for this CPU, results go into a BufferOutput of the node that is reused
+// from pass to pass. Inputs of different lengths are cut to the shortest.
+// Instances can not share the buffer of the node, each of them gets its own.
+
+using Buffer = Attribute::Buffer;
+
+inline auto BufferSize(Buffer const &buffer) -> size_t {
+  return buffer != nullptr ? buffer->size() : 0;
+}
+
+template <auto widgets::vector_math::Kernels::*Kernel>
+class BufferBinaryNode
+    : public TypedNode<In<Buffer, "A">, In<Buffer, "B">,
+                       Out<Buffer, "Result">> {
+public:
+  BufferBinaryNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  void Process() override {
+    Output<2>(Apply(Input<0>(), Input<1>(), m_Result));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<Buffer, Buffer, Buffer>(
+        [](Buffer const &a, Buffer const &b) {
+          BufferOutput result;
+          return Apply(a, b, result);
+        });
+  }
+
+private:
+  static auto Apply(Buffer const &a, Buffer const &b, BufferOutput &result)
+      -> Buffer {
+    size_t const size = std::min(BufferSize(a), BufferSize(b));
+    float *out = result.Resize(size);
+    if (size > 0)
+      (widgets::vector_math::GetKernels().*Kernel)(a->data(), b->data(), out,
+                                                   size);
+    return result.Get();
+  }
+
+  BufferOutput m_Result;
+};
+
+using BufferAddNode = BufferBinaryNode<&widgets::vector_math::Kernels::Add>;
+using BufferMultiplyNode =
+    BufferBinaryNode<&widgets::vector_math::Kernels::Multiply>;
+
+class BufferFmaNode
+    : public TypedNode<In<Buffer, "A">, In<Buffer, "B">, In<Buffer, "C">,
+                       Out<Buffer, "Result">> {
+public:
+  BufferFmaNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  // A * B + C
+  void Process() override {
+    Output<3>(Apply(Input<0>(), Input<1>(), Input<2>(), m_Result));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<Buffer, Buffer, Buffer, Buffer>(
+        [](Buffer const &a, Buffer const &b, Buffer const &c) {
+          BufferOutput result;
+          return Apply(a, b, c, result);
+        });
+  }
+
+private:
+  static auto Apply(Buffer const &a, Buffer const &b, Buffer const &c,
+                    BufferOutput &result) -> Buffer {
+    size_t const size =
+        std::min({BufferSize(a), BufferSize(b), BufferSize(c)});
+    float *out = result.Resize(size);
+    if (size > 0)
+      widgets::vector_math::GetKernels().Fma(a->data(), b->data(), c->data(),
+                                             out, size);
+    return result.Get();
+  }
+
+  BufferOutput m_Result;
+};
+
+class BufferAbsNode
+    : public TypedNode<In<Buffer, "Value">, Out<Buffer, "Result">> {
+public:
+  BufferAbsNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  void Process() override { Output<1>(Apply(Input<0>(), m_Result)); }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<Buffer, Buffer>([](Buffer const &value) {
+      BufferOutput result;
+      return Apply(value, result);
+    });
+  }
+
+private:
+  static auto Apply(Buffer const &value, BufferOutput &result) -> Buffer {
+    size_t const size = BufferSize(value);
+    float *out = result.Resize(size);
+    if (size > 0)
+      widgets::vector_math::GetKernels().Abs(value->data(), out, size);
+    return result.Get();
+  }
+
+  BufferOutput m_Result;
+};
+
+class BufferClampNode
+    : public TypedNode<In<Buffer, "Value">, In<float, "Min">, In<float, "Max">,
+                       Out<Buffer, "Result">> {
+public:
+  BufferClampNode(std::string name) : TypedNode(std::move(name)) {
+    *Default<2>() = 1.0F;
+  }
+  bool IsPure() const override { return true; }
+
+  void DrawPropertiesContent() override {
+    ImGui::InputFloat("Min", Default<1>());
+    ImGui::InputFloat("Max", Default<2>());
+  }
+
+  void Process() override {
+    Output<3>(Apply(Input<0>(), Input<1>(), Input<2>(), m_Result));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<Buffer, Buffer, float, float>(
+        [](Buffer const &value, float min, float max) {
+          BufferOutput result;
+          return Apply(value, min, max, result);
+        });
+  }
+
+private:
+  static auto Apply(Buffer const &value, float min, float max,
+                    BufferOutput &result) -> Buffer {
+    size_t const size = BufferSize(value);
+    float *out = result.Resize(size);
+    if (size > 0)
+      widgets::vector_math::GetKernels().Clamp(value->data(), min, max, out,
+                                               size);
+    return result.Get();
+  }
+
+  BufferOutput m_Result;
+};
+
+class BufferThresholdNode
+    : public TypedNode<In<Buffer, "Value">, In<float, "Threshold">,
+                       Out<Buffer, "Mask">> {
+public:
+  BufferThresholdNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  void DrawPropertiesContent() override {
+    ImGui::InputFloat("Threshold", Default<1>());
+  }
+
+  // 1 where the value is above the threshold, 0 elsewhere
+  void Process() override {
+    Output<2>(Apply(Input<0>(), Input<1>(), m_Result));
+  }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<Buffer, Buffer, float>(
+        [](Buffer const &value, float threshold) {
+          BufferOutput result;
+          return Apply(value, threshold, result);
+        });
+  }
+
+private:
+  static auto Apply(Buffer const &value, float threshold,
+                    BufferOutput &result) -> Buffer {
+    size_t const size = BufferSize(value);
+    float *out = result.Resize(size);
+    if (size > 0)
+      widgets::vector_math::GetKernels().Threshold(value->data(), threshold,
+                                                   out, size);
+    return result.Get();
+  }
+
+  BufferOutput m_Result;
+};
+
+class BufferReduceNode
+    : public TypedNode<In<Buffer, "Value">, Out<float, "Result">> {
+public:
+  enum class Mode { Sum, Min, Max, Mean };
+
+  BufferReduceNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  void DrawPropertiesContent() override {
+    static char const *modes[] = {"Sum", "Min", "Max", "Mean"};
+    int mode = static_cast<int>(m_Mode);
+    if (ImGui::Combo("Mode", &mode, modes, IM_ARRAYSIZE(modes))) {
+      m_Mode = static_cast<Mode>(mode);
+      MarkPropertiesChanged();
+    }
+    ImGui::TextDisabled("Kernels: %s", widgets::vector_math::GetIsaName(
+                                           widgets::vector_math::GetKernels()
+                                               .Set));
+  }
+
+  void Process() override { Output<1>(Reduce(m_Mode, Input<0>())); }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<float, Buffer>(
+        [mode = m_Mode](Buffer const &value) { return Reduce(mode, value); });
+  }
+
+  void Dump(nlohmann::json &data) const override {
+    Node::Dump(data);
+    data["mode"] = static_cast<int>(m_Mode);
+  }
+  void Load(nlohmann::json const &data) override {
+    Node::Load(data);
+    m_Mode = static_cast<Mode>(data.value("mode", 0));
+    MarkPropertiesChanged();
+  }
+
+private:
+  // reductions of an empty buffer are 0
+  static auto Reduce(Mode mode, Buffer const &value) -> float {
+    size_t const size = BufferSize(value);
+    float const *data = size > 0 ? value->data() : nullptr;
+    auto const &kernels = widgets::vector_math::GetKernels();
+
+    switch (mode) {
+    case Mode::Sum:
+      return kernels.Sum(data, size);
+    case Mode::Min:
+      return kernels.Min(data, size);
+    case Mode::Max:
+      return kernels.Max(data, size);
+    case Mode::Mean:
+      return size > 0 ? kernels.Sum(data, size) / static_cast<float>(size)
+                      : 0.0F;
+    }
+    return 0.0F;
+  }
+
+  Mode m_Mode = Mode::Sum;
+};
+
+class BufferDotNode : public TypedNode<In<Buffer, "A">, In<Buffer, "B">,
+                                       Out<float, "Result">> {
+public:
+  BufferDotNode(std::string name) : TypedNode(std::move(name)) {}
+  bool IsPure() const override { return true; }
+
+  void Process() override { Output<2>(Dot(Input<0>(), Input<1>())); }
+  auto ProcessInstances(InstanceBlock &block) -> bool override {
+    return block.Map<float, Buffer, Buffer>(&Dot);
+  }
+
+private:
+  static auto Dot(Buffer const &a, Buffer const &b) -> float {
+    size_t const size = std::min(BufferSize(a), BufferSize(b));
+    return size > 0 ? widgets::vector_math::GetKernels().Dot(a->data(),
+                                                             b->data(), size)
+                    : 0.0F;
+  }
+};
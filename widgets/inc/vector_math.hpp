@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace widgets {
+
+namespace vector_math {
+
+enum class Isa { Scalar, Sse, Avx2, Avx512 };
+
+// Element wise kernels over n floats, out may alias an input. Reductions of
+// zero elements return 0.
+struct Kernels {
+  Isa Set;
+  void (*Add)(float const *a, float const *b, float *out, size_t n);
+  void (*Multiply)(float const *a, float const *b, float *out, size_t n);
+  // a * b + c
+  void (*Fma)(float const *a, float const *b, float const *c, float *out,
+              size_t n);
+  void (*Abs)(float const *a, float *out, size_t n);
+  void (*Clamp)(float const *a, float min, float max, float *out, size_t n);
+  // 1 where a > threshold, 0 elsewhere
+  void (*Threshold)(float const *a, float threshold, float *out, size_t n);
+  float (*Sum)(float const *a, size_t n);
+  float (*Min)(float const *a, size_t n);
+  float (*Max)(float const *a, size_t n);
+  float (*Dot)(float const *a, float const *b, size_t n);
+};
+
+// kernels for an instruction set, nullptr if they were not built or the
+// CPU does not support them
+auto GetKernels(Isa isa) -> Kernels const *;
+// the widest kernels the CPU supports, picked once
+auto GetKernels() -> Kernels const &;
+
+auto GetIsaName(Isa isa) -> char const *;
+
+namespace detail {
+// defined by the vector_math_<isa>.cpp files, each built for its instruction
+// set, nullptr when the compiler can not target it
+auto GetSseKernels() -> Kernels const *;
+auto GetAvx2Kernels() -> Kernels const *;
+auto GetAvx512Kernels() -> Kernels const *;
+} // namespace detail
+
+} // namespace vector_math
+
+} // namespace widgets
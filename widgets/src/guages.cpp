@@ -12,13 +12,168 @@
 
 #include "guages.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
 using namespace ImGui;
 
 namespace widgets {
 
 namespace guages {
 
-void GuageColorMap::Render(GuageColorMap &colorMap) {
+namespace {
+
+struct GuageGeometryKey {
+  float Radius;
+  float Thickness;
+  float ThresholdIndicatorDiv;
+  float StartAngle;
+  float EndAngle;
+  float Min;
+  float Max;
+  float TessellationMaxError;
+  ImU32 BackgroundColor;
+  ImVec2 TexUvWhitePixel;
+};
+
+// vertices are stored relative to the guage center. The cache is looked up
+// by a hash, so everything the geometry was built from is kept to tell a
+// collision from a hit
+struct GuageGeometry {
+  GuageGeometryKey Key;
+  bool Gradient;
+  std::vector<float> Thresholds;
+  std::vector<ImU32> Colors;
+  ImVector<ImDrawVert> Vertices;
+  ImVector<ImDrawIdx> Indices;
+
+  // the key is zero initialized and has no padding, so it is compared bitwise
+  [[nodiscard]] bool Matches(const GuageGeometryKey &key,
+                             const GuageColorMap &colorMap) const {
+    return std::memcmp(&Key, &key, sizeof(key)) == 0 &&
+           Gradient == colorMap.Gradient &&
+           Thresholds == colorMap.GetThresholds() &&
+           Colors == colorMap.GetColors();
+  }
+};
+
+struct FormattedValue {
+  float Value;
+  const char *Format;
+  ImFont *Font;
+  float FontSize;
+  char Buffer[64];
+  ImVec2 Size;
+};
+
+constexpr size_t MaxCachedGeometries = 1024;
+std::unordered_map<ImGuiID, GuageGeometry> s_geometry_cache;
+std::unordered_map<ImGuiID, FormattedValue> s_formatted_values;
+
+// pick the number of segments from the on screen radius instead of a fixed
+// count, small guages get far fewer vertices
+int ArcSegments(const ImDrawList &draw_list, float radius, float a_min,
+                float a_max) {
+  const int circle_segments = draw_list._CalcCircleAutoSegmentCount(radius);
+  return ImMax(2, static_cast<int>(ImCeil(circle_segments *
+                                          ImFabs(a_max - a_min) /
+                                          (2 * IM_PI))));
+}
+
+void ReplayGeometry(ImDrawList *draw_list, const GuageGeometry &geometry,
+                    ImVec2 offset) {
+  if (geometry.Indices.empty()) {
+    return;
+  }
+
+  draw_list->PrimReserve(geometry.Indices.Size, geometry.Vertices.Size);
+  const unsigned int base = draw_list->_VtxCurrentIdx;
+  for (const auto &vertex : geometry.Vertices) {
+    ImDrawVert *out = draw_list->_VtxWritePtr++;
+    out->pos = vertex.pos + offset;
+    out->uv = vertex.uv;
+    out->col = vertex.col;
+  }
+  for (const ImDrawIdx index : geometry.Indices) {
+    *draw_list->_IdxWritePtr++ = static_cast<ImDrawIdx>(base + index);
+  }
+  draw_list->_VtxCurrentIdx += geometry.Vertices.Size;
+}
+
+} // namespace
+
+void GuageColorMap::Compile() {
+  m_Thresholds.clear();
+  m_Colors.clear();
+  m_Thresholds.reserve(Map.size());
+  m_Colors.reserve(Map.size());
+  for (const auto &[threshold, color] : Map) {
+    m_Thresholds.push_back(threshold);
+    m_Colors.push_back(color);
+  }
+
+  m_Hash = ImHashData(&Gradient, sizeof(Gradient));
+  if (!m_Thresholds.empty()) {
+    m_Hash = ImHashData(m_Thresholds.data(),
+                        m_Thresholds.size() * sizeof(float), m_Hash);
+    m_Hash = ImHashData(m_Colors.data(), m_Colors.size() * sizeof(ImU32),
+                        m_Hash);
+  }
+
+  m_LutMin = 0.0f;
+  m_LutScale = 0.0f;
+  m_Lut.fill(m_Colors.empty() ? 0 : m_Colors.front());
+  if (m_Thresholds.size() < 2) {
+    return;
+  }
+
+  // sample the piecewise linear gradient between the thresholds
+  const float lut_min = m_Thresholds.front();
+  const float lut_max = m_Thresholds.back();
+  m_LutMin = lut_min;
+  m_LutScale = (LutSize - 1) / (lut_max - lut_min);
+
+  size_t upper = 1;
+  for (int i = 0; i < LutSize; i++) {
+    const float value = lut_min + (lut_max - lut_min) * i / (LutSize - 1);
+    while (upper + 1 < m_Thresholds.size() && m_Thresholds[upper] < value) {
+      upper++;
+    }
+
+    const float lower_value = m_Thresholds[upper - 1];
+    const float upper_value = m_Thresholds[upper];
+    const float t = ImClamp((value - lower_value) / (upper_value - lower_value),
+                            0.0f, 1.0f);
+    const ImVec4 from = ImColor(m_Colors[upper - 1]).Value;
+    const ImVec4 to = ImColor(m_Colors[upper]).Value;
+    m_Lut[i] = ImColor(ImLerp(from, to, t));
+  }
+}
+
+ImU32 GuageColorMap::GetColor(float value) const {
+  if (m_Thresholds.empty()) {
+    return 0;
+  }
+
+  if (Gradient && m_LutScale > 0.0f) {
+    const int index = static_cast<int>((value - m_LutMin) * m_LutScale);
+    return m_Lut[ImClamp(index, 0, LutSize - 1)];
+  }
+
+  const auto it =
+      std::lower_bound(m_Thresholds.begin(), m_Thresholds.end(), value);
+  if (it == m_Thresholds.end()) {
+    return m_Colors.back();
+  }
+  return m_Colors[it - m_Thresholds.begin()];
+}
+
+bool GuageColorMap::Render(GuageColorMap &colorMap) {
+  bool edited = false;
+  // entries added or removed with the buttons, see the header
+  bool committed = false;
   std::set<float> delete_keys;
   std::vector<std::pair<float, ImU32>>
       updated_entries; // Collect updated entries
@@ -31,6 +186,7 @@ void GuageColorMap::Render(GuageColorMap &colorMap) {
 
     if (ImGui::Button(ICON_VS_REMOVE)) {
       delete_keys.insert(key);
+      committed = true;
       ImGui::PopID();
       continue;
     }
@@ -41,6 +197,7 @@ void GuageColorMap::Render(GuageColorMap &colorMap) {
     auto color_vec4 = ImColor(color).Value;
     if (ImGui::ColorPicker3("Color", &color_vec4.x)) {
       color = ImColor(color_vec4);
+      edited = true;
     }
 
     ImGui::SameLine();
@@ -61,6 +218,13 @@ void GuageColorMap::Render(GuageColorMap &colorMap) {
 
   if (ImGui::Button(ICON_VS_ADD)) {
     colorMap.Map[99999] = IM_COL32(0, 0, 0, 0);
+    edited = true;
+    committed = true;
+  }
+
+  ImGui::SameLine();
+  if (ImGui::Checkbox("Gradient", &colorMap.Gradient)) {
+    edited = true;
   }
 
   for (const auto &key : delete_keys) {
@@ -70,6 +234,11 @@ void GuageColorMap::Render(GuageColorMap &colorMap) {
   for (const auto &entry : updated_entries) {
     colorMap.Map[entry.first] = entry.second;
   }
+
+  if (edited || !delete_keys.empty() || !updated_entries.empty()) {
+    colorMap.Compile();
+  }
+  return committed;
 }
 
 bool SimpleGuage(const char *label, float value, float min, float max,
@@ -142,39 +311,96 @@ bool SimpleGuage(const char *label, float value, float min, float max,
     return false;
   }
 
-  // validate that our color map has the same max
-
   auto color_ring_thickness = thickness / threshold_indicator_div;
   auto color_ring_radius = radius;
+  auto value_ring_radius =
+      radius - color_ring_thickness * 3.0f - radius / (16.0f);
 
-  // add the colors
-  float current_angle = start_angle * IM_PI;
-  for (const auto &[key, color] : colorMap.Map) {
-    float next_angle = lerper(key);
-    if (next_angle > angle_max) {
-      continue;
-    }
-    if (current_angle < angle_min) {
-      continue;
-    }
-    if (next_angle == current_angle) {
-      continue;
-    }
-    window->DrawList->PathClear();
-    window->DrawList->PathArcTo(center, color_ring_radius, current_angle,
-                                next_angle, 32);
-    window->DrawList->PathStroke(color, ImDrawFlags_None, color_ring_thickness);
-    current_angle = next_angle;
+  // the color bands and the background ring only depend on the geometry and
+  // the color map, so they are tessellated once and replayed every frame
+  GuageGeometryKey key{};
+  key.Radius = radius;
+  key.Thickness = thickness;
+  key.ThresholdIndicatorDiv = threshold_indicator_div;
+  key.StartAngle = start_angle;
+  key.EndAngle = end_angle;
+  key.Min = min;
+  key.Max = max;
+  key.TessellationMaxError = style.CircleTessellationMaxError;
+  key.BackgroundColor = ImColor(style.Colors[ImGuiCol_MenuBarBg]);
+  key.TexUvWhitePixel = window->DrawList->_Data->TexUvWhitePixel;
+
+  const ImGuiID geometry_id =
+      ImHashData(&key, sizeof(key), colorMap.GetHash());
+
+  if (s_geometry_cache.size() >= MaxCachedGeometries &&
+      !s_geometry_cache.contains(geometry_id)) {
+    s_geometry_cache.clear();
   }
 
-  // add the background of the guage
-  auto value_ring_radius =
-      radius - color_ring_thickness * 3.0f - radius / (16.0f);
-  window->DrawList->PathClear();
-  window->DrawList->PathArcTo(center, value_ring_radius, start_angle * IM_PI,
-                              end_angle * IM_PI);
-  window->DrawList->PathStroke(ImColor(style.Colors[ImGuiCol_MenuBarBg]),
-                               ImDrawFlags_None, thickness);
+  auto [geometry, inserted] = s_geometry_cache.try_emplace(geometry_id);
+  if (inserted || !geometry->second.Matches(key, colorMap)) {
+    ImDrawList scratch(GetDrawListSharedData());
+    scratch._ResetForNewFrame();
+    const ImVec2 origin(0, 0);
+
+    // add the colors
+    const auto &thresholds = colorMap.GetThresholds();
+    const auto &colors = colorMap.GetColors();
+    if (colorMap.Gradient && !thresholds.empty()) {
+      const float gradient_end = ImMin(lerper(thresholds.back()), angle_max);
+      const int segments = ArcSegments(scratch, color_ring_radius,
+                                       start_angle * IM_PI, gradient_end);
+      const float step = (gradient_end - start_angle * IM_PI) / segments;
+      for (int i = 0; i < segments; i++) {
+        const float a0 = start_angle * IM_PI + step * i;
+        const float a_mid = a0 + step * 0.5f;
+        const float value_mid =
+            min + (a_mid / IM_PI - start_angle) / (end_angle - start_angle) *
+                      (max - min);
+        scratch.PathClear();
+        scratch.PathArcTo(origin, color_ring_radius, a0, a0 + step, 1);
+        scratch.PathStroke(colorMap.GetColor(value_mid), ImDrawFlags_None,
+                           color_ring_thickness);
+      }
+    } else {
+      float current_angle = start_angle * IM_PI;
+      for (size_t i = 0; i < thresholds.size(); i++) {
+        float next_angle = lerper(thresholds[i]);
+        if (next_angle > angle_max) {
+          continue;
+        }
+        if (current_angle < angle_min) {
+          continue;
+        }
+        if (next_angle == current_angle) {
+          continue;
+        }
+        scratch.PathClear();
+        scratch.PathArcTo(origin, color_ring_radius, current_angle, next_angle,
+                          ArcSegments(scratch, color_ring_radius,
+                                      current_angle, next_angle));
+        scratch.PathStroke(colors[i], ImDrawFlags_None, color_ring_thickness);
+        current_angle = next_angle;
+      }
+    }
+
+    // add the background of the guage
+    scratch.PathClear();
+    scratch.PathArcTo(origin, value_ring_radius, start_angle * IM_PI,
+                      end_angle * IM_PI,
+                      ArcSegments(scratch, value_ring_radius,
+                                  start_angle * IM_PI, end_angle * IM_PI));
+    scratch.PathStroke(key.BackgroundColor, ImDrawFlags_None, thickness);
+
+    geometry->second.Key = key;
+    geometry->second.Gradient = colorMap.Gradient;
+    geometry->second.Thresholds = thresholds;
+    geometry->second.Colors = colors;
+    geometry->second.Vertices = scratch.VtxBuffer;
+    geometry->second.Indices = scratch.IdxBuffer;
+  }
+  ReplayGeometry(window->DrawList, geometry->second, center);
 
   // add the current values bar of the correct color and angle
   float current_angle_value =
@@ -184,19 +410,11 @@ bool SimpleGuage(const char *label, float value, float min, float max,
   }
   window->DrawList->PathClear();
   window->DrawList->PathArcTo(center, value_ring_radius, start_angle * IM_PI,
-                              current_angle_value);
-  ImU32 value_color = 0;
-  ImU32 last_color = 0;
-  for (const auto &[key, color] : colorMap.Map) {
-    if (value <= key) {
-      value_color = color;
-      break;
-    }
-    last_color = color;
-  }
-  if (value_color == 0) {
-    value_color = last_color;
-  }
+                              current_angle_value,
+                              ArcSegments(*window->DrawList, value_ring_radius,
+                                          start_angle * IM_PI,
+                                          current_angle_value));
+  const ImU32 value_color = colorMap.GetColor(value);
   window->DrawList->PathStroke(value_color, ImDrawFlags_None, thickness);
 
   // add a white line at the end of the value to make it look like a needle
@@ -204,15 +422,30 @@ bool SimpleGuage(const char *label, float value, float min, float max,
   window->DrawList->PathClear();
   window->DrawList->PathArcTo(center, value_ring_radius,
                               current_angle_value - 0.01f * IM_PI / 2,
-                              current_angle_value + 0.01f * IM_PI / 2);
+                              current_angle_value + 0.01f * IM_PI / 2, 2);
   window->DrawList->PathStroke(ImColor(ImVec4(1, 1, 1, 1)), ImDrawFlags_None,
                                value_ring_thickness);
 
-  // add the value in the middle of the guage
-  char buffer[64];
-  snprintf(buffer, sizeof(buffer), format, value);
-  const ImVec2 value_size = ImGui::CalcTextSize(buffer, nullptr, true);
-  window->DrawList->AddText(center - value_size / 2, value_color, buffer);
+  // add the value in the middle of the guage, only reformatting the text
+  // when the value or the font it is measured in changed
+  if (s_formatted_values.size() >= MaxCachedGeometries &&
+      !s_formatted_values.contains(id)) {
+    s_formatted_values.clear();
+  }
+  auto [formatted, first_use] = s_formatted_values.try_emplace(id);
+  FormattedValue &text = formatted->second;
+  ImFont *const font = GetFont();
+  const float font_size = GetFontSize();
+  if (first_use || text.Value != value || text.Format != format ||
+      text.Font != font || text.FontSize != font_size) {
+    text.Value = value;
+    text.Format = format;
+    text.Font = font;
+    text.FontSize = font_size;
+    ImFormatString(text.Buffer, sizeof(text.Buffer), format, value);
+    text.Size = ImGui::CalcTextSize(text.Buffer, nullptr, true);
+  }
+  window->DrawList->AddText(center - text.Size / 2, value_color, text.Buffer);
 
   return true;
 }
@@ -3,6 +3,7 @@
 
 #include <guages.hpp>
 #include <inputs.hpp>
+#include <math.hpp>
 
 void RegisterWidgets() {
   dynamic_editor::api::RegisterNodeType<SimpleGuageNode>(
@@ -10,6 +11,33 @@ void RegisterWidgets() {
 
   dynamic_editor::api::RegisterNodeType<FloatSliderNode>(
       "Inputs", "Float Slider", "A simple float slider widget");
+
+  dynamic_editor::api::RegisterNodeType<ScaleNode>(
+      "Math", "Scale", "Multiplies a value by a factor");
+  dynamic_editor::api::RegisterNodeType<OffsetNode>(
+      "Math", "Offset", "Adds an offset to a value");
+  dynamic_editor::api::RegisterNodeType<ClampNode>(
+      "Math", "Clamp", "Limits a value to a range");
+  dynamic_editor::api::RegisterNodeType<CompareNode>(
+      "Math", "Compare", "Compares two values");
+
+  dynamic_editor::api::RegisterNodeType<BufferAddNode>(
+      "Math", "Buffer Add", "Adds two buffers element wise");
+  dynamic_editor::api::RegisterNodeType<BufferMultiplyNode>(
+      "Math", "Buffer Multiply", "Multiplies two buffers element wise");
+  dynamic_editor::api::RegisterNodeType<BufferFmaNode>(
+      "Math", "Buffer Multiply Add", "Computes A * B + C element wise");
+  dynamic_editor::api::RegisterNodeType<BufferAbsNode>(
+      "Math", "Buffer Abs", "Absolute value of every element");
+  dynamic_editor::api::RegisterNodeType<BufferClampNode>(
+      "Math", "Buffer Clamp", "Limits every element to a range");
+  dynamic_editor::api::RegisterNodeType<BufferThresholdNode>(
+      "Math", "Buffer Threshold",
+      "Mask of the elements above a threshold");
+  dynamic_editor::api::RegisterNodeType<BufferReduceNode>(
+      "Math", "Buffer Reduce", "Sum, minimum, maximum or mean of a buffer");
+  dynamic_editor::api::RegisterNodeType<BufferDotNode>(
+      "Math", "Buffer Dot", "Dot product of two buffers");
 }
 
 struct AutoRegisterWidgets {
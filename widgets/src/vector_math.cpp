@@ -0,0 +1,142 @@
+#include <vector_math.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace widgets {
+
+namespace vector_math {
+
+namespace {
+
+void Add(float const *a, float const *b, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = a[i] + b[i];
+}
+
+void Multiply(float const *a, float const *b, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = a[i] * b[i];
+}
+
+void Fma(float const *a, float const *b, float const *c, float *out,
+         size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = a[i] * b[i] + c[i];
+}
+
+void Abs(float const *a, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = std::fabs(a[i]);
+}
+
+// NaN stays NaN
+void Clamp(float const *a, float min, float max, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = std::min(std::max(a[i], min), max);
+}
+
+void Threshold(float const *a, float threshold, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = a[i] > threshold ? 1.0F : 0.0F;
+}
+
+auto Sum(float const *a, size_t n) -> float {
+  float sum = 0.0F;
+  for (size_t i = 0; i < n; i++)
+    sum += a[i];
+  return sum;
+}
+
+// NaN wins
+auto Min(float const *a, size_t n) -> float {
+  if (n == 0)
+    return 0.0F;
+  float min = a[0];
+  for (size_t i = 1; i < n; i++)
+    min = a[i] < min || std::isnan(a[i]) ? a[i] : min;
+  return min;
+}
+
+auto Max(float const *a, size_t n) -> float {
+  if (n == 0)
+    return 0.0F;
+  float max = a[0];
+  for (size_t i = 1; i < n; i++)
+    max = a[i] > max || std::isnan(a[i]) ? a[i] : max;
+  return max;
+}
+
+auto Dot(float const *a, float const *b, size_t n) -> float {
+  float sum = 0.0F;
+  for (size_t i = 0; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+constexpr Kernels s_scalar_kernels{
+    Isa::Scalar, Add, Multiply, Fma, Abs, Clamp, Threshold, Sum, Min, Max, Dot,
+};
+
+auto Supports(Isa isa) -> bool {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  switch (isa) {
+  case Isa::Sse:
+    return __builtin_cpu_supports("sse2");
+  case Isa::Avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case Isa::Avx512:
+    return __builtin_cpu_supports("avx512f");
+  default:
+    return true;
+  }
+#else
+  return isa == Isa::Scalar;
+#endif
+}
+
+} // namespace
+
+auto GetKernels(Isa isa) -> Kernels const * {
+  if (!Supports(isa))
+    return nullptr;
+
+  switch (isa) {
+  case Isa::Sse:
+    return detail::GetSseKernels();
+  case Isa::Avx2:
+    return detail::GetAvx2Kernels();
+  case Isa::Avx512:
+    return detail::GetAvx512Kernels();
+  default:
+    return &s_scalar_kernels;
+  }
+}
+
+auto GetKernels() -> Kernels const & {
+  static Kernels const *s_kernels = [] {
+    for (auto isa : {Isa::Avx512, Isa::Avx2, Isa::Sse}) {
+      if (auto const *kernels = GetKernels(isa))
+        return kernels;
+    }
+    return &s_scalar_kernels;
+  }();
+  return *s_kernels;
+}
+
+auto GetIsaName(Isa isa) -> char const * {
+  switch (isa) {
+  case Isa::Sse:
+    return "SSE2";
+  case Isa::Avx2:
+    return "AVX2";
+  case Isa::Avx512:
+    return "AVX-512";
+  default:
+    return "Scalar";
+  }
+}
+
+} // namespace vector_math
+
+} // namespace widgets
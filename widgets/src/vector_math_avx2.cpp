@@ -0,0 +1,75 @@
+#include <vector_math.hpp>
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace widgets {
+
+namespace vector_math {
+
+namespace {
+
+auto ReduceAdd128(__m128 v) -> float {
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+struct Ops {
+  using Vector = __m256;
+  static constexpr size_t Width = 8;
+  static constexpr Isa Set = Isa::Avx2;
+
+  static auto Load(float const *p) -> Vector { return _mm256_loadu_ps(p); }
+  static void Store(float *p, Vector v) { _mm256_storeu_ps(p, v); }
+  static auto Set1(float value) -> Vector { return _mm256_set1_ps(value); }
+
+  static auto Add(Vector a, Vector b) -> Vector {
+    return _mm256_add_ps(a, b);
+  }
+  static auto Multiply(Vector a, Vector b) -> Vector {
+    return _mm256_mul_ps(a, b);
+  }
+  static auto Fma(Vector a, Vector b, Vector c) -> Vector {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+  static auto Min(Vector a, Vector b) -> Vector {
+    return _mm256_min_ps(a, b);
+  }
+  static auto Max(Vector a, Vector b) -> Vector {
+    return _mm256_max_ps(a, b);
+  }
+  static auto Abs(Vector a) -> Vector {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0F), a);
+  }
+  static auto Or(Vector a, Vector b) -> Vector { return _mm256_or_ps(a, b); }
+  static auto Greater(Vector a, Vector b) -> Vector {
+    return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ),
+                         _mm256_set1_ps(1.0F));
+  }
+
+  static auto ReduceAdd(Vector v) -> float {
+    return ReduceAdd128(_mm_add_ps(_mm256_castps256_ps128(v),
+                                   _mm256_extractf128_ps(v, 1)));
+  }
+};
+
+} // namespace
+
+#include "vector_math_simd.inl"
+
+auto detail::GetAvx2Kernels() -> Kernels const * { return &s_kernels; }
+
+} // namespace vector_math
+
+} // namespace widgets
+
+#else
+
+auto widgets::vector_math::detail::GetAvx2Kernels() -> Kernels const * {
+  return nullptr;
+}
+
+#endif
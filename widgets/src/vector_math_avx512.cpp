@@ -0,0 +1,69 @@
+#include <vector_math.hpp>
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace widgets {
+
+namespace vector_math {
+
+namespace {
+
+struct Ops {
+  using Vector = __m512;
+  static constexpr size_t Width = 16;
+  static constexpr Isa Set = Isa::Avx512;
+
+  static auto Load(float const *p) -> Vector { return _mm512_loadu_ps(p); }
+  static void Store(float *p, Vector v) { _mm512_storeu_ps(p, v); }
+  static auto Set1(float value) -> Vector { return _mm512_set1_ps(value); }
+
+  static auto Add(Vector a, Vector b) -> Vector {
+    return _mm512_add_ps(a, b);
+  }
+  static auto Multiply(Vector a, Vector b) -> Vector {
+    return _mm512_mul_ps(a, b);
+  }
+  static auto Fma(Vector a, Vector b, Vector c) -> Vector {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static auto Min(Vector a, Vector b) -> Vector {
+    return _mm512_min_ps(a, b);
+  }
+  static auto Max(Vector a, Vector b) -> Vector {
+    return _mm512_max_ps(a, b);
+  }
+  static auto Abs(Vector a) -> Vector { return _mm512_abs_ps(a); }
+  // _mm512_or_ps needs AVX512DQ
+  static auto Or(Vector a, Vector b) -> Vector {
+    return _mm512_castsi512_ps(
+        _mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+  }
+  static auto Greater(Vector a, Vector b) -> Vector {
+    return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ),
+                               _mm512_set1_ps(1.0F));
+  }
+
+  static auto ReduceAdd(Vector v) -> float { return _mm512_reduce_add_ps(v); }
+};
+
+} // namespace
+
+#include "vector_math_simd.inl"
+
+auto detail::GetAvx512Kernels() -> Kernels const * { return &s_kernels; }
+
+} // namespace vector_math
+
+} // namespace widgets
+
+#else
+
+auto widgets::vector_math::detail::GetAvx512Kernels() -> Kernels const * {
+  return nullptr;
+}
+
+#endif
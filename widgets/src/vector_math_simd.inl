@@ -0,0 +1,176 @@
+// Kernels written once against an Ops struct describing a vector register,
+// included by every vector_math_<isa>.cpp after defining its Ops. Everything
+// here has internal linkage, code built for a wider instruction set must not
+// be picked by the linker for a caller built without it.
+
+namespace {
+
+constexpr size_t W = Ops::Width;
+
+// NaN wins no matter in which lane or tail it turns up, so every kernel set
+// agrees with the scalar one
+auto MinOf(float min, float value) -> float {
+  return value < min || std::isnan(value) ? value : min;
+}
+auto MaxOf(float max, float value) -> float {
+  return value > max || std::isnan(value) ? value : max;
+}
+
+void Add(float const *a, float const *b, float *out, size_t n) {
+  size_t i = 0;
+  for (; i + W <= n; i += W)
+    Ops::Store(out + i, Ops::Add(Ops::Load(a + i), Ops::Load(b + i)));
+  for (; i < n; i++)
+    out[i] = a[i] + b[i];
+}
+
+void Multiply(float const *a, float const *b, float *out, size_t n) {
+  size_t i = 0;
+  for (; i + W <= n; i += W)
+    Ops::Store(out + i, Ops::Multiply(Ops::Load(a + i), Ops::Load(b + i)));
+  for (; i < n; i++)
+    out[i] = a[i] * b[i];
+}
+
+void Fma(float const *a, float const *b, float const *c, float *out,
+         size_t n) {
+  size_t i = 0;
+  for (; i + W <= n; i += W) {
+    Ops::Store(out + i, Ops::Fma(Ops::Load(a + i), Ops::Load(b + i),
+                                 Ops::Load(c + i)));
+  }
+  for (; i < n; i++)
+    out[i] = a[i] * b[i] + c[i];
+}
+
+void Abs(float const *a, float *out, size_t n) {
+  size_t i = 0;
+  for (; i + W <= n; i += W)
+    Ops::Store(out + i, Ops::Abs(Ops::Load(a + i)));
+  for (; i < n; i++)
+    out[i] = std::fabs(a[i]);
+}
+
+void Clamp(float const *a, float min, float max, float *out, size_t n) {
+  auto const lower = Ops::Set1(min);
+  auto const upper = Ops::Set1(max);
+  size_t i = 0;
+  // Min and Max return their second operand if either is NaN, a NaN value
+  // is kept that way, the same as the scalar kernel does
+  for (; i + W <= n; i += W)
+    Ops::Store(out + i, Ops::Min(upper, Ops::Max(lower, Ops::Load(a + i))));
+  for (; i < n; i++) {
+    float const value = a[i] < min ? min : a[i];
+    out[i] = value > max ? max : value;
+  }
+}
+
+void Threshold(float const *a, float threshold, float *out, size_t n) {
+  auto const limit = Ops::Set1(threshold);
+  size_t i = 0;
+  for (; i + W <= n; i += W)
+    Ops::Store(out + i, Ops::Greater(Ops::Load(a + i), limit));
+  for (; i < n; i++)
+    out[i] = a[i] > threshold ? 1.0F : 0.0F;
+}
+
+// four independent accumulators hide the latency of the adds, so the
+// reductions are bound by memory bandwidth
+auto Sum(float const *a, size_t n) -> float {
+  auto acc0 = Ops::Set1(0.0F);
+  auto acc1 = acc0;
+  auto acc2 = acc0;
+  auto acc3 = acc0;
+  size_t i = 0;
+  for (; i + 4 * W <= n; i += 4 * W) {
+    acc0 = Ops::Add(acc0, Ops::Load(a + i));
+    acc1 = Ops::Add(acc1, Ops::Load(a + i + W));
+    acc2 = Ops::Add(acc2, Ops::Load(a + i + 2 * W));
+    acc3 = Ops::Add(acc3, Ops::Load(a + i + 3 * W));
+  }
+  for (; i + W <= n; i += W)
+    acc0 = Ops::Add(acc0, Ops::Load(a + i));
+
+  float sum = Ops::ReduceAdd(Ops::Add(Ops::Add(acc0, acc1),
+                                      Ops::Add(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i];
+  return sum;
+}
+
+// Min(acc, value) returns value and Min(value, acc) returns acc if either
+// is NaN, one of the two is the NaN then and or'ing them keeps it. Without
+// NaN both are the same up to the sign of zero
+auto Min(float const *a, size_t n) -> float {
+  if (n == 0)
+    return 0.0F;
+
+  size_t i = 0;
+  float min = a[0];
+  if (n >= W) {
+    auto acc = Ops::Load(a);
+    for (i = W; i + W <= n; i += W) {
+      auto const value = Ops::Load(a + i);
+      acc = Ops::Or(Ops::Min(acc, value), Ops::Min(value, acc));
+    }
+
+    float lanes[W];
+    Ops::Store(lanes, acc);
+    for (float lane : lanes)
+      min = MinOf(min, lane);
+  }
+  for (; i < n; i++)
+    min = MinOf(min, a[i]);
+  return min;
+}
+
+auto Max(float const *a, size_t n) -> float {
+  if (n == 0)
+    return 0.0F;
+
+  size_t i = 0;
+  float max = a[0];
+  if (n >= W) {
+    auto acc = Ops::Load(a);
+    for (i = W; i + W <= n; i += W) {
+      auto const value = Ops::Load(a + i);
+      acc = Ops::Or(Ops::Max(acc, value), Ops::Max(value, acc));
+    }
+
+    float lanes[W];
+    Ops::Store(lanes, acc);
+    for (float lane : lanes)
+      max = MaxOf(max, lane);
+  }
+  for (; i < n; i++)
+    max = MaxOf(max, a[i]);
+  return max;
+}
+
+auto Dot(float const *a, float const *b, size_t n) -> float {
+  auto acc0 = Ops::Set1(0.0F);
+  auto acc1 = acc0;
+  auto acc2 = acc0;
+  auto acc3 = acc0;
+  size_t i = 0;
+  for (; i + 4 * W <= n; i += 4 * W) {
+    acc0 = Ops::Fma(Ops::Load(a + i), Ops::Load(b + i), acc0);
+    acc1 = Ops::Fma(Ops::Load(a + i + W), Ops::Load(b + i + W), acc1);
+    acc2 = Ops::Fma(Ops::Load(a + i + 2 * W), Ops::Load(b + i + 2 * W), acc2);
+    acc3 = Ops::Fma(Ops::Load(a + i + 3 * W), Ops::Load(b + i + 3 * W), acc3);
+  }
+  for (; i + W <= n; i += W)
+    acc0 = Ops::Fma(Ops::Load(a + i), Ops::Load(b + i), acc0);
+
+  float sum = Ops::ReduceAdd(Ops::Add(Ops::Add(acc0, acc1),
+                                      Ops::Add(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+constexpr Kernels s_kernels{
+    Ops::Set, Add, Multiply, Fma, Abs, Clamp, Threshold, Sum, Min, Max, Dot,
+};
+
+} // namespace
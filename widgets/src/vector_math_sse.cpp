@@ -0,0 +1,64 @@
+#include <vector_math.hpp>
+
+#if defined(__SSE2__)
+
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace widgets {
+
+namespace vector_math {
+
+namespace {
+
+struct Ops {
+  using Vector = __m128;
+  static constexpr size_t Width = 4;
+  static constexpr Isa Set = Isa::Sse;
+
+  static auto Load(float const *p) -> Vector { return _mm_loadu_ps(p); }
+  static void Store(float *p, Vector v) { _mm_storeu_ps(p, v); }
+  static auto Set1(float value) -> Vector { return _mm_set1_ps(value); }
+
+  static auto Add(Vector a, Vector b) -> Vector { return _mm_add_ps(a, b); }
+  static auto Multiply(Vector a, Vector b) -> Vector {
+    return _mm_mul_ps(a, b);
+  }
+  // no fused multiply add before AVX2
+  static auto Fma(Vector a, Vector b, Vector c) -> Vector {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static auto Min(Vector a, Vector b) -> Vector { return _mm_min_ps(a, b); }
+  static auto Max(Vector a, Vector b) -> Vector { return _mm_max_ps(a, b); }
+  static auto Abs(Vector a) -> Vector {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0F), a);
+  }
+  static auto Or(Vector a, Vector b) -> Vector { return _mm_or_ps(a, b); }
+  static auto Greater(Vector a, Vector b) -> Vector {
+    return _mm_and_ps(_mm_cmpgt_ps(a, b), _mm_set1_ps(1.0F));
+  }
+
+  static auto ReduceAdd(Vector v) -> float {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+  }
+};
+
+} // namespace
+
+#include "vector_math_simd.inl"
+
+auto detail::GetSseKernels() -> Kernels const * { return &s_kernels; }
+
+} // namespace vector_math
+
+} // namespace widgets
+
+#else
+
+auto widgets::vector_math::detail::GetSseKernels() -> Kernels const * {
+  return nullptr;
+}
+
+#endif